@@ -0,0 +1,51 @@
+/**
+ * @file bench_commands.cpp
+ * @author Trent Tobias
+ * @brief Measures a full getParamConfig() command cycle (enable, query, disable)
+ * in host CPU time and in virtual (on-device) time
+ */
+
+#include <HostStreams.h>
+#include <LD2412.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+int main(int argc, char** argv) {
+    const int cycles = argc > 1 ? std::atoi(argv[1]) : 20000;
+    const std::vector<uint8_t> enableAck = {
+        0xFD, 0xFC, 0xFB, 0xFA, 0x08, 0x00, 0xFF, 0x01, 0x00, 0x00,
+        0x01, 0x00, 0x40, 0x00, 0x04, 0x03, 0x02, 0x01
+    };
+    const std::vector<uint8_t> paramAck = {
+        0xFD, 0xFC, 0xFB, 0xFA, 0x09, 0x00, 0x12, 0x01, 0x00, 0x00,
+        0x01, 0x0C, 0x05, 0x00, 0x00, 0x04, 0x03, 0x02, 0x01
+    };
+    const std::vector<uint8_t> disableAck = {
+        0xFD, 0xFC, 0xFB, 0xFA, 0x04, 0x00, 0xFE, 0x01, 0x00, 0x00,
+        0x04, 0x03, 0x02, 0x01
+    };
+
+    host::useVirtualClock(true);
+    MemoryStream stream;
+    LD2412 radar(stream);
+    int ok = 0;
+
+    uint64_t virtualStart = host::nowMicros();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < cycles; i++) {
+        stream.feed(enableAck);
+        stream.feed(paramAck);
+        stream.feed(disableAck);
+        if (radar.getParamConfig() != nullptr)
+            ok++;
+        stream.clearWritten();
+    }
+    auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    double virtualMs = (host::nowMicros() - virtualStart) / 1000.0;
+
+    std::printf("cycles=%d ok=%d host_ns/cycle=%.1f device_ms/cycle=%.2f\n",
+                cycles, ok, elapsed / cycles, virtualMs / cycles);
+    return ok == cycles ? 0 : 1;
+}
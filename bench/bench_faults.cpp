@@ -0,0 +1,114 @@
+/**
+ * @file bench_faults.cpp
+ * @author Trent Tobias
+ * @brief Degradation under line noise: sweeps fault rates through FaultyStream and reports,
+ * per decode mode, the share of report frames recovered intact, frames recovered with a
+ * corrupted payload, the parser's own resync/error counters, host time per frame and the
+ * command success rate.
+ *
+ * Usage: bench_faults [--frames N] [--commands N] [--seed N]
+ */
+
+#include <FaultyStream.h>
+#include <LD2412.h>
+#include <SimulatedSensor.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+namespace {
+    struct Result {
+        unsigned int intact = 0;
+        unsigned int corrupted = 0;
+        LD2412Stats stats;
+        double nsPerFrame = 0;
+        unsigned int commandsOk = 0;
+    };
+
+    FaultyStream::Faults noise(double rate) {
+        FaultyStream::Faults f;
+        f.drop = rate;
+        f.bitFlip = rate;
+        f.duplicate = rate / 2;
+        f.garbage = rate / 4;
+        f.truncateAck = rate * 10;
+        return f;
+    }
+
+    Result run(double rate, bool lazy, unsigned int frames, unsigned int commands, uint32_t seed) {
+        MemoryStream inner;
+        SimulatedSensor sensor(inner);
+        FaultyStream noisy(inner, seed);
+        LD2412 radar(noisy);
+        radar.setLazyDecode(lazy);
+        noisy.setFaults(noise(rate));
+        Result r;
+
+        double ns = 0;
+        uint32_t seen = 0;
+        LD2412Frame frame;
+        for (unsigned int i = 0; i < frames; i++) {
+            LD2412Frame sent = {static_cast<uint8_t>(1 + i % 3), static_cast<uint16_t>(50 + i % 400), static_cast<uint8_t>(i % 100),
+                                static_cast<uint16_t>(60 + i % 300), static_cast<uint8_t>(i % 90), 0};
+            sensor.report(sent);
+            delay(100);
+            auto start = std::chrono::steady_clock::now();
+            bool ok = radar.readFrame(frame);
+            ns += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+            if (!ok || radar.getStats().frames == seen)
+                continue;
+            seen = radar.getStats().frames;
+            bool same = frame.state == sent.state && frame.movingDistance == sent.movingDistance
+                && frame.movingEnergy == sent.movingEnergy && frame.staticDistance == sent.staticDistance
+                && frame.staticEnergy == sent.staticEnergy;
+            (same ? r.intact : r.corrupted)++;
+        }
+        r.nsPerFrame = ns / frames;
+
+        for (unsigned int i = 0; i < commands; i++) {
+            if (radar.getParamConfig() != nullptr)
+                r.commandsOk++;
+            //Lets a module stuck in config mode by a lost disable command settle
+            delay(50);
+        }
+        r.stats = radar.getStats();
+        return r;
+    }
+}
+
+int main(int argc, char** argv) {
+    unsigned int frames = 5000;
+    unsigned int commands = 200;
+    uint32_t seed = 2412;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--frames" && i + 1 < argc)
+            frames = std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--commands" && i + 1 < argc)
+            commands = std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--seed" && i + 1 < argc)
+            seed = std::strtoul(argv[++i], nullptr, 10);
+        else {
+            std::fprintf(stderr, "usage: %s [--frames N] [--commands N] [--seed N]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    //Busy-wait loops poll millis(); every time read moves the virtual clock so they end
+    host::useVirtualClock(true);
+    host::setClockStep(10);
+
+    std::printf("%-8s %-6s %9s %10s %8s %9s %10s %12s\n", "rate", "mode", "intact%", "corrupt%",
+                "resyncs", "badframes", "ns/frame", "commands%");
+    for (double rate : {0.0, 0.001, 0.002, 0.005, 0.01, 0.02, 0.05}) {
+        for (bool lazy : {false, true}) {
+            Result r = run(rate, lazy, frames, commands, seed);
+            std::printf("%-8.3f %-6s %9.2f %10.2f %8u %9u %10.1f %12.2f\n", rate, lazy ? "lazy" : "eager",
+                        100.0 * r.intact / frames, 100.0 * r.corrupted / frames, r.stats.resyncs,
+                        r.stats.frameErrors, r.nsPerFrame, commands ? 100.0 * r.commandsOk / commands : 0.0);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,476 @@
+/**
+ * @file bench_parser.cpp
+ * @author Trent Tobias
+ * @brief Side-by-side benchmark of report frame parsers over identical workloads.
+ *
+ * Every parser registered in parsers() is run against every workload: clean streams,
+ * 1% corrupted bytes, frames split at every offset, ACK/report mixes and the report
+ * frames captured in test/traces. Each pair is repeated and reported as mean with a
+ * 95% confidence interval for ns/byte and frames/sec, plus heap allocations per frame
+ * and how many of the expected frames were recovered.
+ *
+ * Usage: bench_parser [--frames N] [--reps N] [--json] [--parser NAME] [--workload NAME]
+ */
+
+#include <HostStreams.h>
+#include <LD2412.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <tuple>
+
+/*-----Allocation counting-----*/
+namespace {
+    std::atomic<unsigned long> allocations{0};
+}
+
+namespace {
+    //Every replaceable form goes through here, so arrays and over-aligned types are counted too
+    void* countedAlloc(std::size_t size, std::size_t align) {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+        if (size == 0)
+            size = 1;
+        void* p = align <= alignof(std::max_align_t)
+            ? std::malloc(size)
+            : std::aligned_alloc(align, (size + align - 1) / align * align);
+        return p;
+    }
+
+    void* countedNew(std::size_t size, std::size_t align) {
+        if (void* p = countedAlloc(size, align))
+            return p;
+        throw std::bad_alloc();
+    }
+}
+
+void* operator new(std::size_t size) { return countedNew(size, 0); }
+void* operator new[](std::size_t size) { return countedNew(size, 0); }
+void* operator new(std::size_t size, std::align_val_t align) { return countedNew(size, static_cast<std::size_t>(align)); }
+void* operator new[](std::size_t size, std::align_val_t align) { return countedNew(size, static_cast<std::size_t>(align)); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return countedAlloc(size, 0); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return countedAlloc(size, 0); }
+void* operator new(std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    return countedAlloc(size, static_cast<std::size_t>(align));
+}
+void* operator new[](std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    return countedAlloc(size, static_cast<std::size_t>(align));
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { std::free(p); }
+
+namespace {
+    struct Frame {
+        int state, movingDistance, movingEnergy, staticDistance, staticEnergy;
+
+        bool operator==(const Frame& o) const {
+            return state == o.state && movingDistance == o.movingDistance && movingEnergy == o.movingEnergy
+                && staticDistance == o.staticDistance && staticEnergy == o.staticEnergy;
+        }
+    };
+
+    /**
+     * @brief Stream over a prepared byte buffer. The harness releases bytes chunk by chunk,
+     * so available() is O(1) and the stream itself stays out of the measurement.
+     */
+    class ChunkStream : public Stream {
+    public:
+        explicit ChunkStream(const std::vector<uint8_t>& bytes) : bytes(bytes) {}
+
+        void release(size_t end) { this->end = end; }
+
+        int available() override { return this->end - this->pos; }
+        int read() override { return this->pos < this->end ? this->bytes[this->pos++] : -1; }
+        int peek() override { return this->pos < this->end ? this->bytes[this->pos] : -1; }
+        size_t write(uint8_t) override { return 1; }
+        using Print::write;
+
+    private:
+        const std::vector<uint8_t>& bytes;
+        size_t pos = 0;
+        size_t end = 0;
+    };
+
+    /*-----Parsers under test-----*/
+    class Parser {
+    public:
+        virtual ~Parser() = default;
+        virtual const char* name() const = 0;
+
+        /**
+         * @brief Consumes whatever the stream has available
+         * @return Number of frames written to out (at most max)
+         */
+        virtual int drain(Stream& stream, Frame* out, int max) = 0;
+    };
+
+    //The library's own readSerial() byte loop, driven through its public accessors
+    class ByteLoopParser : public Parser {
+    public:
+        explicit ByteLoopParser(Stream& stream) : radar(stream) {
+            this->radar.setSerialRefreshThres(0);
+        }
+
+        const char* name() const override { return "byteloop"; }
+
+        int drain(Stream& stream, Frame* out, int max) override {
+            int n = 0;
+            while (n < max && stream.available() > 0) {
+                int before = stream.available();
+                Frame f;
+                f.state = this->radar.targetState();
+                if (stream.available() == before)
+                    break;
+                if (f.state < 0)
+                    continue;
+                f.movingDistance = this->radar.movingDistance();
+                f.movingEnergy = this->radar.movingEnergy();
+                f.staticDistance = this->radar.staticDistance();
+                f.staticEnergy = this->radar.staticEnergy();
+                out[n++] = f;
+            }
+            return n;
+        }
+
+    protected:
+        LD2412 radar;
+    };
+
+    //The byte loop in lazy decode mode, fields decoded from the retained frame on request
+    class LazyParser : public ByteLoopParser {
+    public:
+        explicit LazyParser(Stream& stream) : ByteLoopParser(stream) {
+            this->radar.setLazyDecode(true);
+        }
+
+        const char* name() const override { return "lazy"; }
+    };
+
+    //Incremental state machine: consumes only available bytes and resumes across chunks
+    class StateMachineParser : public Parser {
+    public:
+        explicit StateMachineParser(Stream&) {}
+
+        const char* name() const override { return "statemachine"; }
+
+        int drain(Stream& stream, Frame* out, int max) override {
+            static const uint8_t HEADER[4] = {0xF4, 0xF3, 0xF2, 0xF1};
+            static const uint8_t FOOTER[4] = {0xF8, 0xF7, 0xF6, 0xF5};
+            int n = 0;
+
+            while (n < max && stream.available() > 0) {
+                uint8_t b = stream.read();
+                if (this->pos < 4) {
+                    if (b == HEADER[this->pos])
+                        this->frame[this->pos++] = b;
+                    else
+                        this->pos = b == HEADER[0] ? 1 : 0;
+                    continue;
+                }
+                this->frame[this->pos++] = b;
+                if (this->pos == 6 && (this->frame[4] != 0x0B || this->frame[5] != 0x00)) {
+                    this->pos = 0;
+                    continue;
+                }
+                if (this->pos < 21)
+                    continue;
+
+                this->pos = 0;
+                if (this->frame[6] != 0x02 || this->frame[7] != 0xAA || this->frame[15] != 0x55
+                    || std::memcmp(this->frame + 17, FOOTER, 4) != 0)
+                    continue;
+                out[n++] = {this->frame[8], this->frame[9] + (this->frame[10] << 8), this->frame[11],
+                            this->frame[12] + (this->frame[13] << 8), this->frame[14]};
+            }
+            return n;
+        }
+
+    private:
+        uint8_t frame[21];
+        unsigned int pos = 0;
+    };
+
+    using ParserFactory = std::unique_ptr<Parser> (*)(Stream&);
+
+    //Add new parsers here to benchmark them against the same workloads
+    const std::vector<std::pair<const char*, ParserFactory>>& parsers() {
+        static const std::vector<std::pair<const char*, ParserFactory>> list = {
+            {"byteloop", [](Stream& s) -> std::unique_ptr<Parser> { return std::make_unique<ByteLoopParser>(s); }},
+            {"lazy", [](Stream& s) -> std::unique_ptr<Parser> { return std::make_unique<LazyParser>(s); }},
+            {"statemachine", [](Stream& s) -> std::unique_ptr<Parser> { return std::make_unique<StateMachineParser>(s); }},
+        };
+        return list;
+    }
+
+    /*-----Workloads-----*/
+    struct Workload {
+        std::string name;
+        std::vector<uint8_t> bytes;
+        std::vector<size_t> chunkEnds;      //Release points, the parser is drained after each
+        std::vector<Frame> expected;
+    };
+
+    std::vector<uint8_t> reportFrame(const Frame& f) {
+        return {0xF4, 0xF3, 0xF2, 0xF1, 0x0B, 0x00, 0x02, 0xAA,
+                static_cast<uint8_t>(f.state),
+                static_cast<uint8_t>(f.movingDistance), static_cast<uint8_t>(f.movingDistance >> 8),
+                static_cast<uint8_t>(f.movingEnergy),
+                static_cast<uint8_t>(f.staticDistance), static_cast<uint8_t>(f.staticDistance >> 8),
+                static_cast<uint8_t>(f.staticEnergy),
+                0x55, 0x00, 0xF8, 0xF7, 0xF6, 0xF5};
+    }
+
+    std::vector<Frame> syntheticFrames(int count, std::mt19937& rng) {
+        std::vector<Frame> frames;
+        int distance = 200;
+        for (int i = 0; i < count; i++) {
+            distance = std::clamp(distance + static_cast<int>(rng() % 21) - 10, 30, 1000);
+            int state = rng() % 4;
+            frames.push_back({state,
+                              state & 1 ? distance : 0, state & 1 ? static_cast<int>(rng() % 100) : 0,
+                              state & 2 ? distance + 15 : 0, state & 2 ? static_cast<int>(rng() % 100) : 0});
+        }
+        return frames;
+    }
+
+    Workload clean(const std::vector<Frame>& frames) {
+        Workload w{"clean", {}, {}, frames};
+        for (const Frame& f : frames) {
+            std::vector<uint8_t> b = reportFrame(f);
+            w.bytes.insert(w.bytes.end(), b.begin(), b.end());
+            w.chunkEnds.push_back(w.bytes.size());
+        }
+        return w;
+    }
+
+    Workload corrupted(const std::vector<Frame>& frames, std::mt19937& rng) {
+        Workload w = clean(frames);
+        w.name = "corrupt1pct";
+        for (uint8_t& b : w.bytes)
+            if (rng() % 100 == 0)
+                b ^= 1 << (rng() % 8);
+        return w;
+    }
+
+    Workload split(const std::vector<Frame>& frames) {
+        Workload w{"split", {}, {}, frames};
+        for (size_t i = 0; i < frames.size(); i++) {
+            std::vector<uint8_t> b = reportFrame(frames[i]);
+            size_t start = w.bytes.size();
+            w.bytes.insert(w.bytes.end(), b.begin(), b.end());
+            w.chunkEnds.push_back(start + 1 + i % (b.size() - 1));
+            w.chunkEnds.push_back(w.bytes.size());
+        }
+        return w;
+    }
+
+    Workload mixed(const std::vector<Frame>& frames) {
+        const std::vector<uint8_t> ack = {0xFD, 0xFC, 0xFB, 0xFA, 0x04, 0x00, 0xFE, 0x01, 0x00, 0x00,
+                                          0x04, 0x03, 0x02, 0x01};
+        Workload w{"mixed", {}, {}, frames};
+        for (size_t i = 0; i < frames.size(); i++) {
+            if (i % 4 == 0)
+                w.bytes.insert(w.bytes.end(), ack.begin(), ack.end());
+            std::vector<uint8_t> b = reportFrame(frames[i]);
+            w.bytes.insert(w.bytes.end(), b.begin(), b.end());
+            w.chunkEnds.push_back(w.bytes.size());
+        }
+        return w;
+    }
+
+    //Report frames taken from the golden traces, repeated up to the requested size
+    Workload captured(int count) {
+        Workload w{"captured", {}, {}, {}};
+        std::vector<std::vector<uint8_t>> chunks;
+        for (const auto& entry : std::filesystem::directory_iterator(LD2412_TRACE_DIR)) {
+            if (entry.path().filename().string().rfind("report", 0) != 0)
+                continue;
+            std::ifstream file(entry.path());
+            std::string line;
+            while (std::getline(file, line)) {
+                std::istringstream in(line);
+                std::string directive, tok;
+                if (!(in >> directive) || directive != "rx")
+                    continue;
+                std::vector<uint8_t> bytes;
+                while (in >> tok)
+                    if (tok[0] != '+')
+                        bytes.push_back(static_cast<uint8_t>(std::stoul(tok, nullptr, 16)));
+                chunks.push_back(bytes);
+            }
+        }
+        while (!chunks.empty() && static_cast<int>(w.expected.size()) < count) {
+            for (const std::vector<uint8_t>& chunk : chunks) {
+                //Ground truth: the last complete report frame in the chunk
+                for (size_t i = 0; i + 21 <= chunk.size(); i++)
+                    if (chunk[i] == 0xF4 && chunk[i + 1] == 0xF3 && chunk[i + 2] == 0xF2 && chunk[i + 3] == 0xF1)
+                        w.expected.push_back({chunk[i + 8], chunk[i + 9] + (chunk[i + 10] << 8), chunk[i + 11],
+                                              chunk[i + 12] + (chunk[i + 13] << 8), chunk[i + 14]});
+                w.bytes.insert(w.bytes.end(), chunk.begin(), chunk.end());
+                w.chunkEnds.push_back(w.bytes.size());
+            }
+        }
+        return w;
+    }
+
+    /*-----Statistics-----*/
+    struct Summary {
+        double mean, ci95;
+    };
+
+    Summary summarize(const std::vector<double>& samples) {
+        //Two-sided 95% Student t critical values for df = 1..30
+        static const double T95[] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+                                     2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+                                     2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+        size_t n = samples.size();
+        double mean = 0;
+        for (double s : samples)
+            mean += s;
+        mean /= n;
+        if (n < 2)
+            return {mean, 0};
+        double var = 0;
+        for (double s : samples)
+            var += (s - mean) * (s - mean);
+        var /= n - 1;
+        double t = n - 1 <= 30 ? T95[n - 2] : 1.96;
+        return {mean, t * std::sqrt(var / n)};
+    }
+
+    struct Result {
+        Summary nsPerByte, framesPerSec;
+        double allocsPerFrame;
+        int decoded, matched, expected;
+    };
+
+    //Multiset intersection: decoded frames that correspond to some expected frame
+    int countMatched(const std::vector<Frame>& decoded, const std::vector<Frame>& expected) {
+        auto key = [](const Frame& f) {
+            return std::make_tuple(f.state, f.movingDistance, f.movingEnergy, f.staticDistance, f.staticEnergy);
+        };
+        std::map<decltype(key(expected[0])), int> remaining;
+        for (const Frame& f : expected)
+            remaining[key(f)]++;
+        int matched = 0;
+        for (const Frame& f : decoded) {
+            auto it = remaining.find(key(f));
+            if (it != remaining.end() && it->second > 0) {
+                it->second--;
+                matched++;
+            }
+        }
+        return matched;
+    }
+
+    Result run(ParserFactory factory, const Workload& w, int reps) {
+        std::vector<double> nsPerByte, framesPerSec;
+        std::vector<Frame> decoded(w.chunkEnds.size() + 1);
+        unsigned long allocs = 0;
+        int frames = 0;
+
+        for (int rep = 0; rep < reps; rep++) {
+            ChunkStream stream(w.bytes);
+            std::unique_ptr<Parser> parser = factory(stream);
+            frames = 0;
+
+            unsigned long allocBefore = allocations.load();
+            auto start = std::chrono::steady_clock::now();
+            for (size_t end : w.chunkEnds) {
+                stream.release(end);
+                frames += parser->drain(stream, decoded.data() + frames, decoded.size() - frames);
+            }
+            double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+            allocs += allocations.load() - allocBefore;
+
+            nsPerByte.push_back(ns / w.bytes.size());
+            framesPerSec.push_back(frames * 1e9 / ns);
+        }
+        decoded.resize(frames);
+        return {summarize(nsPerByte), summarize(framesPerSec),
+                frames ? static_cast<double>(allocs) / reps / frames : 0.0,
+                frames, countMatched(decoded, w.expected), static_cast<int>(w.expected.size())};
+    }
+}
+
+int main(int argc, char** argv) {
+    int frameCount = 20000;
+    int reps = 10;
+    bool json = false;
+    std::string onlyParser, onlyWorkload;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--frames" && i + 1 < argc)
+            frameCount = std::atoi(argv[++i]);
+        else if (arg == "--reps" && i + 1 < argc)
+            reps = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--json")
+            json = true;
+        else if (arg == "--parser" && i + 1 < argc)
+            onlyParser = argv[++i];
+        else if (arg == "--workload" && i + 1 < argc)
+            onlyWorkload = argv[++i];
+        else {
+            std::fprintf(stderr, "usage: %s [--frames N] [--reps N] [--json] [--parser NAME] [--workload NAME]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    //The byte loop busy-waits on millis(); each time read costs 1 ms of virtual time so stalls end
+    host::useVirtualClock(true);
+    host::setClockStep(1000);
+
+    std::mt19937 rng(2412);
+    std::vector<Frame> frames = syntheticFrames(frameCount, rng);
+    std::vector<Workload> workloads = {clean(frames), corrupted(frames, rng), split(frames), mixed(frames),
+                                       captured(frameCount)};
+
+    if (!json)
+        std::printf("%-13s %-12s %18s %22s %12s %17s\n", "parser", "workload", "ns/byte (95% CI)",
+                    "frames/s (95% CI)", "allocs/frame", "matched/expected");
+    for (const auto& [name, factory] : parsers()) {
+        if (!onlyParser.empty() && onlyParser != name)
+            continue;
+        for (const Workload& w : workloads) {
+            if (!onlyWorkload.empty() && onlyWorkload != w.name)
+                continue;
+            Result r = run(factory, w, reps);
+            if (json)
+                std::printf("{\"parser\":\"%s\",\"workload\":\"%s\",\"reps\":%d,\"bytes\":%zu,"
+                            "\"ns_per_byte\":{\"mean\":%.3f,\"ci95\":%.3f},"
+                            "\"frames_per_sec\":{\"mean\":%.0f,\"ci95\":%.0f},"
+                            "\"allocs_per_frame\":%.4f,\"decoded\":%d,\"matched\":%d,\"expected\":%d}\n",
+                            name, w.name.c_str(), reps, w.bytes.size(), r.nsPerByte.mean, r.nsPerByte.ci95,
+                            r.framesPerSec.mean, r.framesPerSec.ci95, r.allocsPerFrame,
+                            r.decoded, r.matched, r.expected);
+            else
+                std::printf("%-13s %-12s %9.2f +- %-6.2f %12.0f +- %-7.0f %12.4f %8d/%-8d\n",
+                            name, w.name.c_str(), r.nsPerByte.mean, r.nsPerByte.ci95,
+                            r.framesPerSec.mean, r.framesPerSec.ci95, r.allocsPerFrame, r.matched, r.expected);
+        }
+    }
+    return 0;
+}
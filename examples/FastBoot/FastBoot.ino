@@ -0,0 +1,69 @@
+/**
+ * @file FastBoot.ino
+ * @author Trent Tobias
+ * @brief Applies a site configuration once and keeps its fingerprint in EEPROM, so later
+ * boots only run one short check before detections start
+ */
+
+#include <EEPROM.h>
+#include <LD2412.h>
+
+//EEPROM layout: magic byte, then the 4-byte fingerprint
+class EepromStore : public LD2412ConfigStore {
+public:
+    static constexpr int ADDRESS = 0;
+    static constexpr uint8_t MAGIC = 0xA5;
+
+    bool load(uint32_t& fingerprint) override {
+        if (EEPROM.read(ADDRESS) != MAGIC)
+            return false;
+        EEPROM.get(ADDRESS + 1, fingerprint);
+        return true;
+    }
+
+    bool save(uint32_t fingerprint) override {
+        EEPROM.write(ADDRESS, MAGIC);
+        EEPROM.put(ADDRESS + 1, fingerprint);
+#if defined(ESP32) || defined(ESP8266)
+        return EEPROM.commit();
+#else
+        return true;
+#endif
+    }
+};
+
+LD2412 radar(Serial1);
+EepromStore store;
+
+void setup() {
+    Serial.begin(115200);
+    Serial1.begin(115200);
+#if defined(ESP32) || defined(ESP8266)
+    EEPROM.begin(8);
+#endif
+
+    LD2412Config config;
+    config.minGate = 1;
+    config.maxGate = 8;
+    config.duration = 10;
+    for (int i=0; i<14; i++) {
+        config.motionSensitivity[i] = 50;
+        config.staticSensitivity[i] = 40;
+    }
+
+    switch (radar.ensureConfig(config, store)) {
+        case 0:
+            Serial.println("Configuration already applied");
+            break;
+        case 1:
+            Serial.println("Configuration applied");
+            break;
+        default:
+            Serial.println("Radar not responding");
+    }
+}
+
+void loop() {
+    Serial.println(radar.targetState());
+    delay(100);
+}
@@ -0,0 +1,81 @@
+/**
+ * @file Arduino.cpp
+ * @author Trent Tobias
+ * @brief Host-side stand-in for the parts of the Arduino core used by the LD2412 library.
+ */
+
+#include "Arduino.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+namespace {
+    std::atomic<bool> virtualEnabled{false};
+    std::atomic<uint64_t> virtualNow{0};
+    std::atomic<uint64_t> virtualStep{0};
+    const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+}
+
+/*-----Time-----*/
+unsigned long millis() {
+    if (virtualEnabled)
+        virtualNow += virtualStep;
+    //Truncated to 32 bits so wraparound behaves like the boards (~49.7 days)
+    return static_cast<uint32_t>(host::nowMicros() / 1000);
+}
+
+unsigned long micros() {
+    if (virtualEnabled)
+        virtualNow += virtualStep;
+    return static_cast<uint32_t>(host::nowMicros());
+}
+
+void delay(unsigned long ms) {
+    if (virtualEnabled)
+        virtualNow += static_cast<uint64_t>(ms) * 1000;
+    else
+        std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void delayMicroseconds(unsigned int us) {
+    if (virtualEnabled)
+        virtualNow += us;
+    else
+        std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+void yield() {
+    if (!virtualEnabled)
+        std::this_thread::yield();
+}
+
+namespace host {
+    void useVirtualClock(bool enabled) {
+        virtualEnabled = enabled;
+    }
+
+    bool virtualClock() {
+        return virtualEnabled;
+    }
+
+    void setClock(uint64_t us) {
+        virtualNow = us;
+    }
+
+    void advanceClock(uint64_t us) {
+        if (virtualEnabled)
+            virtualNow += us;
+    }
+
+    void setClockStep(uint64_t us) {
+        virtualStep = us;
+    }
+
+    uint64_t nowMicros() {
+        if (virtualEnabled)
+            return virtualNow;
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - epoch).count();
+    }
+}
@@ -0,0 +1,91 @@
+/**
+ * @file Arduino.h
+ * @author Trent Tobias
+ * @brief Host-side stand-in for the parts of the Arduino core used by the LD2412 library.
+ * Lets the library build and run on Linux for tests, benchmarks and gateway tools.
+ */
+
+#ifndef LD2412_HOST_ARDUINO_H
+#define LD2412_HOST_ARDUINO_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+
+typedef uint8_t byte;
+
+/*-----Print & Stream-----*/
+class Print {
+public:
+    virtual ~Print() = default;
+
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* data, size_t len) {
+        size_t n = 0;
+        while (len-- && write(*data++))
+            n++;
+        return n;
+    }
+    size_t write(const char* str) {
+        return str == nullptr ? 0 : write(reinterpret_cast<const uint8_t*>(str), strlen(str));
+    }
+
+    virtual int availableForWrite() { return 0; }
+    virtual void flush() {}
+};
+
+class Stream : public Print {
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+};
+
+/*-----Time-----*/
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+namespace host {
+    /**
+     * @brief Switches millis()/micros()/delay() between the real monotonic clock (default)
+     * and a virtual clock that only moves through delay() or advanceClock()
+     * @param enabled True for virtual time
+     */
+    void useVirtualClock(bool enabled);
+
+    /**
+     * @brief Whether the virtual clock is active
+     */
+    bool virtualClock();
+
+    /**
+     * @brief Sets the virtual clock (in us). Like millis() on a board, the 32-bit
+     * millis()/micros() values wrap around; set this near the wrap to exercise it
+     * @param us Absolute virtual time in microseconds
+     */
+    void setClock(uint64_t us);
+
+    /**
+     * @brief Advances the virtual clock, no-op on the real clock
+     * @param us Microseconds to advance
+     */
+    void advanceClock(uint64_t us);
+
+    /**
+     * @brief Makes every millis()/micros() call on the virtual clock advance it by a step,
+     * so busy-wait loops that poll the time still reach their timeouts (default: 0)
+     * @param us Microseconds per time read
+     */
+    void setClockStep(uint64_t us);
+
+    /**
+     * @brief Current time in microseconds, 64-bit and never wrapping
+     */
+    uint64_t nowMicros();
+}
+
+#endif //LD2412_HOST_ARDUINO_H
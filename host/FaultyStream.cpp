@@ -0,0 +1,152 @@
+/**
+ * @file FaultyStream.cpp
+ * @author Trent Tobias
+ * @brief Stream decorator injecting line noise
+ */
+
+#include "FaultyStream.h"
+
+#include <vector>
+
+FaultyStream::FaultyStream(Stream& inner, uint32_t seed) : inner(inner), rng(seed * 0x9E3779B97F4A7C15ULL + 1) {
+}
+
+void FaultyStream::setFaults(const Faults& faults) {
+    this->config = faults;
+}
+
+const FaultyStream::Faults& FaultyStream::faults() const {
+    return this->config;
+}
+
+const FaultyStream::Counts& FaultyStream::counts() const {
+    return this->fired;
+}
+
+void FaultyStream::setFaultyWrites(bool enabled) {
+    this->faultyWrites = enabled;
+}
+
+uint32_t FaultyStream::next() {
+    //xorshift64*, identical on every platform unlike <random> distributions
+    this->rng ^= this->rng >> 12;
+    this->rng ^= this->rng << 25;
+    this->rng ^= this->rng >> 27;
+    return static_cast<uint32_t>((this->rng * 0x2545F4914F6CDD1DULL) >> 32);
+}
+
+bool FaultyStream::chance(double p) {
+    return p > 0 && next() < p * 4294967296.0;
+}
+
+bool FaultyStream::truncating(uint8_t c) {
+    static const uint8_t HEADER[4] = {0xFD, 0xFC, 0xFB, 0xFA};
+    static const uint8_t FOOTER[4] = {0x04, 0x03, 0x02, 0x01};
+
+    if (this->ackKeep == 0) {
+        //Swallows the rest of the ACK up to its footer (bounded, in case the footer was lost)
+        this->ackFooter = c == FOOTER[this->ackFooter] ? this->ackFooter + 1 : (c == FOOTER[0] ? 1 : 0);
+        if (this->ackFooter == 4 || ++this->ackDiscarded > 64) {
+            this->ackKeep = -1;
+            this->ackFooter = 0;
+        }
+        return true;
+    }
+    if (this->ackKeep > 0) {
+        this->ackKeep--;
+        return false;
+    }
+
+    this->ackHeader = c == HEADER[this->ackHeader] ? this->ackHeader + 1 : (c == HEADER[0] ? 1 : 0);
+    if (this->ackHeader == 4) {
+        this->ackHeader = 0;
+        if (chance(this->config.truncateAck)) {
+            this->fired.truncatedAcks++;
+            this->ackKeep = next() % 8;
+            this->ackDiscarded = 0;
+        }
+    }
+    return false;
+}
+
+void FaultyStream::inject(uint8_t c, std::deque<uint8_t>& out) {
+    if (chance(this->config.garbage)) {
+        this->fired.garbageBursts++;
+        for (unsigned int n = 1 + next() % (this->config.garbageMax > 0 ? this->config.garbageMax : 1); n > 0; n--)
+            out.push_back(static_cast<uint8_t>(next()));
+    }
+    if (chance(this->config.drop)) {
+        this->fired.drops++;
+        return;
+    }
+    if (chance(this->config.bitFlip)) {
+        this->fired.bitFlips++;
+        c ^= 1 << (next() % 8);
+    }
+    out.push_back(c);
+    if (chance(this->config.duplicate)) {
+        this->fired.duplicates++;
+        out.push_back(c);
+    }
+}
+
+void FaultyStream::pump() {
+    while (this->inner.available() > 0) {
+        int c = this->inner.read();
+        if (c < 0)
+            break;
+        if (truncating(static_cast<uint8_t>(c)))
+            continue;
+        if (chance(this->config.delay)) {
+            this->fired.delays++;
+            uint64_t until = host::nowMicros() + this->config.delayUs;
+            if (until > this->heldUntil)
+                this->heldUntil = until;
+        }
+        inject(static_cast<uint8_t>(c), this->rx);
+    }
+}
+
+int FaultyStream::available() {
+    pump();
+    if (host::nowMicros() < this->heldUntil)
+        return 0;
+    return static_cast<int>(this->rx.size());
+}
+
+int FaultyStream::read() {
+    if (available() == 0)
+        return -1;
+    uint8_t c = this->rx.front();
+    this->rx.pop_front();
+    return c;
+}
+
+int FaultyStream::peek() {
+    if (available() == 0)
+        return -1;
+    return this->rx.front();
+}
+
+size_t FaultyStream::write(uint8_t c) {
+    return write(&c, 1);
+}
+
+size_t FaultyStream::write(const uint8_t* data, size_t len) {
+    if (!this->faultyWrites)
+        return this->inner.write(data, len);
+    std::deque<uint8_t> noisy;
+    for (size_t i = 0; i < len; i++)
+        inject(data[i], noisy);
+    std::vector<uint8_t> bytes(noisy.begin(), noisy.end());
+    this->inner.write(bytes.data(), bytes.size());
+    return len;
+}
+
+int FaultyStream::availableForWrite() {
+    return this->inner.availableForWrite();
+}
+
+void FaultyStream::flush() {
+    this->inner.flush();
+}
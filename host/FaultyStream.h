@@ -0,0 +1,91 @@
+/**
+ * @file FaultyStream.h
+ * @author Trent Tobias
+ * @brief Stream decorator injecting line noise into what the library reads: dropped,
+ * bit-flipped and duplicated bytes, garbage bursts, delayed delivery and truncated ACKs.
+ * Faults come from a seeded PRNG, so a failing run replays exactly.
+ */
+
+#ifndef LD2412_FAULTY_STREAM_H
+#define LD2412_FAULTY_STREAM_H
+
+#include <Arduino.h>
+#include <deque>
+
+class FaultyStream : public Stream {
+public:
+    /**
+     * @brief Fault probabilities, per received byte unless noted (0 disables)
+     */
+    struct Faults {
+        double drop = 0;                    //Byte lost
+        double bitFlip = 0;                 //One random bit inverted
+        double duplicate = 0;               //Byte delivered twice
+        double garbage = 0;                 //Burst of random bytes inserted before the byte
+        unsigned int garbageMax = 16;       //Longest burst
+        double delay = 0;                   //Delivery of everything received so far stalls
+        unsigned long delayUs = 5000;       //Length of a stall
+        double truncateAck = 0;             //Per ACK frame: cut off somewhere after its header
+    };
+
+    /**
+     * @brief How often each fault fired
+     */
+    struct Counts {
+        unsigned long drops = 0;
+        unsigned long bitFlips = 0;
+        unsigned long duplicates = 0;
+        unsigned long garbageBursts = 0;
+        unsigned long delays = 0;
+        unsigned long truncatedAcks = 0;
+    };
+
+    /**
+     * @param inner Real or simulated stream the library would otherwise use
+     * @param seed PRNG seed
+     */
+    FaultyStream(Stream& inner, uint32_t seed);
+
+    void setFaults(const Faults& faults);
+    const Faults& faults() const;
+    const Counts& counts() const;
+
+    /**
+     * @brief Faults applied to writes as well (off by default): the module then sees
+     * noisy commands too
+     */
+    void setFaultyWrites(bool enabled);
+
+    int available() override;
+    int read() override;
+    int peek() override;
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* data, size_t len) override;
+    int availableForWrite() override;
+    void flush() override;
+    using Print::write;
+
+private:
+    Stream& inner;
+    Faults config;
+    Counts fired;
+    uint64_t rng;
+    bool faultyWrites = false;
+
+    std::deque<uint8_t> rx;         //Bytes already past the fault stage
+    uint64_t heldUntil = 0;         //Delivery stalled until this time (us)
+
+    //ACK tracking on the incoming stream
+    uint8_t ackHeader = 0;          //Header bytes matched
+    int ackKeep = -1;               //Bytes still let through of a truncated ACK, -1 if none
+    uint8_t ackFooter = 0;          //Footer bytes matched while discarding
+    unsigned int ackDiscarded = 0;
+
+    uint32_t next();
+    bool chance(double p);
+    void pump();
+    void inject(uint8_t c, std::deque<uint8_t>& out);
+    bool truncating(uint8_t c);
+};
+
+#endif //LD2412_FAULTY_STREAM_H
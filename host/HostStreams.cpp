@@ -0,0 +1,296 @@
+/**
+ * @file HostStreams.cpp
+ * @author Trent Tobias
+ * @brief Stream implementations for running the LD2412 library on a Linux host
+ */
+
+#include "HostStreams.h"
+
+#include <cerrno>
+#include <climits>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <unistd.h>
+
+/*-----MemoryStream-----*/
+void MemoryStream::feed(const uint8_t* data, size_t len, uint64_t delayUs) {
+    if (len == 0)
+        return;
+    uint64_t readyAt = host::nowMicros() + delayUs;
+    //Keeps delivery in order, a later chunk is never readable before an earlier one
+    if (!this->rx.empty() && this->rx.back().readyAt > readyAt)
+        readyAt = this->rx.back().readyAt;
+    this->rx.push_back({readyAt, 0, std::vector<uint8_t>(data, data + len)});
+}
+
+void MemoryStream::feed(const std::vector<uint8_t>& data, uint64_t delayUs) {
+    feed(data.data(), data.size(), delayUs);
+}
+
+void MemoryStream::onWrite(WriteHook hook) {
+    this->hook = std::move(hook);
+}
+
+const std::vector<uint8_t>& MemoryStream::written() const {
+    return this->tx;
+}
+
+void MemoryStream::clearWritten() {
+    this->tx.clear();
+}
+
+size_t MemoryStream::pending() const {
+    size_t n = 0;
+    for (const Chunk& c : this->rx)
+        n += c.bytes.size() - c.offset;
+    return n;
+}
+
+void MemoryStream::setWriteCapacity(int capacity) {
+    this->writeCapacity = capacity;
+}
+
+void MemoryStream::setBaud(unsigned long baud) {
+    this->baud = baud;
+}
+
+uint64_t MemoryStream::lineFreeAt() const {
+    return this->lineFree;
+}
+
+int MemoryStream::available() {
+    uint64_t now = host::nowMicros();
+    size_t n = 0;
+    for (const Chunk& c : this->rx) {
+        if (c.readyAt > now)
+            break;
+        n += c.bytes.size() - c.offset;
+    }
+    return n > INT_MAX ? INT_MAX : static_cast<int>(n);
+}
+
+int MemoryStream::read() {
+    int c = peek();
+    if (c < 0)
+        return c;
+    Chunk& front = this->rx.front();
+    if (++front.offset == front.bytes.size())
+        this->rx.pop_front();
+    return c;
+}
+
+int MemoryStream::peek() {
+    if (this->rx.empty() || this->rx.front().readyAt > host::nowMicros())
+        return -1;
+    const Chunk& front = this->rx.front();
+    return front.bytes[front.offset];
+}
+
+size_t MemoryStream::write(uint8_t c) {
+    return write(&c, 1);
+}
+
+size_t MemoryStream::write(const uint8_t* data, size_t len) {
+    this->tx.insert(this->tx.end(), data, data + len);
+    if (this->baud != 0) {
+        uint64_t now = host::nowMicros();
+        if (this->lineFree < now)
+            this->lineFree = now;
+        this->lineFree += len * 10000000ULL / this->baud;
+    }
+    if (this->hook)
+        this->hook(data, len);
+    return len;
+}
+
+int MemoryStream::availableForWrite() {
+    return this->writeCapacity;
+}
+
+void MemoryStream::flush() {
+    for (uint64_t now = host::nowMicros(); now < this->lineFree; now = host::nowMicros())
+        delayMicroseconds(static_cast<unsigned int>(this->lineFree - now));
+}
+
+/*-----FdStream-----*/
+FdStream::FdStream(int fd) : handle(fd) {
+    if (this->handle >= 0)
+        fcntl(this->handle, F_SETFL, fcntl(this->handle, F_GETFL) | O_NONBLOCK);
+}
+
+FdStream::~FdStream() {
+    close();
+}
+
+int FdStream::fd() const {
+    return this->handle;
+}
+
+void FdStream::close() {
+    if (this->handle >= 0)
+        ::close(this->handle);
+    this->handle = -1;
+}
+
+void FdStream::fill() {
+    if (this->handle < 0)
+        return;
+    if (this->rxHead == this->rxTail)
+        this->rxHead = this->rxTail = 0;
+    if (this->rxTail == RX_SIZE)
+        return;
+    ssize_t n = ::read(this->handle, this->rxBuffer + this->rxTail, RX_SIZE - this->rxTail);
+    if (n > 0)
+        this->rxTail += n;
+}
+
+int FdStream::available() {
+    fill();
+    return this->rxTail - this->rxHead;
+}
+
+int FdStream::read() {
+    int c = peek();
+    if (c >= 0)
+        this->rxHead++;
+    return c;
+}
+
+int FdStream::peek() {
+    if (this->rxHead == this->rxTail)
+        fill();
+    if (this->rxHead == this->rxTail)
+        return -1;
+    return this->rxBuffer[this->rxHead];
+}
+
+size_t FdStream::write(uint8_t c) {
+    return write(&c, 1);
+}
+
+size_t FdStream::write(const uint8_t* data, size_t len) {
+    size_t done = 0;
+    while (this->handle >= 0 && done < len) {
+        ssize_t n = ::write(this->handle, data + done, len - done);
+        if (n > 0) {
+            done += n;
+        }
+        else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            pollfd p = {this->handle, POLLOUT, 0};
+            poll(&p, 1, 10);
+        }
+        else if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        else {
+            break;
+        }
+    }
+    return done;
+}
+
+int FdStream::availableForWrite() {
+    if (this->handle < 0)
+        return 0;
+    pollfd p = {this->handle, POLLOUT, 0};
+    return poll(&p, 1, 0) == 1 && (p.revents & POLLOUT) ? PIPE_BUF : 0;
+}
+
+void FdStream::flush() {
+    if (this->handle >= 0 && isatty(this->handle))
+        tcdrain(this->handle);
+}
+
+/*-----PtyStream-----*/
+PtyStream::PtyStream() : FdStream(posix_openpt(O_RDWR | O_NOCTTY)) {
+    if (this->handle < 0)
+        return;
+    if (grantpt(this->handle) != 0 || unlockpt(this->handle) != 0) {
+        close();
+        return;
+    }
+    char name[128];
+    if (ptsname_r(this->handle, name, sizeof(name)) != 0) {
+        close();
+        return;
+    }
+    this->slave = name;
+
+    //Raw line discipline so binary frames pass through untouched
+    termios tio;
+    if (tcgetattr(this->handle, &tio) == 0) {
+        cfmakeraw(&tio);
+        tcsetattr(this->handle, TCSANOW, &tio);
+    }
+}
+
+bool PtyStream::isOpen() const {
+    return this->handle >= 0;
+}
+
+const std::string& PtyStream::slaveName() const {
+    return this->slave;
+}
+
+/*-----TtyStream-----*/
+TtyStream::TtyStream(const char* path, unsigned long baud) : FdStream(::open(path, O_RDWR | O_NOCTTY)) {
+    if (this->handle < 0)
+        return;
+    termios tio;
+    if (tcgetattr(this->handle, &tio) != 0) {
+        close();
+        return;
+    }
+    cfmakeraw(&tio);
+    tio.c_cflag |= CLOCAL | CREAD;
+    tio.c_cflag &= ~(CSTOPB | CRTSCTS);
+    tio.c_cc[VMIN] = 0;
+    tio.c_cc[VTIME] = 0;
+    if (tcsetattr(this->handle, TCSANOW, &tio) != 0 || !setBaud(baud)) {
+        close();
+        return;
+    }
+    tcflush(this->handle, TCIOFLUSH);
+}
+
+bool TtyStream::isOpen() const {
+    return this->handle >= 0;
+}
+
+bool TtyStream::setBaud(unsigned long baud) {
+    speed_t speed;
+    switch (baud) {
+        case 9600:
+            speed = B9600;
+            break;
+        case 19200:
+            speed = B19200;
+            break;
+        case 38400:
+            speed = B38400;
+            break;
+        case 57600:
+            speed = B57600;
+            break;
+        case 115200:
+            speed = B115200;
+            break;
+        case 230400:
+            speed = B230400;
+            break;
+        case 460800:
+            speed = B460800;
+            break;
+        default:
+            //256000 has no termios constant
+            return false;
+    }
+    termios tio;
+    if (this->handle < 0 || tcgetattr(this->handle, &tio) != 0)
+        return false;
+    cfsetispeed(&tio, speed);
+    cfsetospeed(&tio, speed);
+    return tcsetattr(this->handle, TCSANOW, &tio) == 0;
+}
@@ -0,0 +1,175 @@
+/**
+ * @file HostStreams.h
+ * @author Trent Tobias
+ * @brief Stream implementations for running the LD2412 library on a Linux host
+ */
+
+#ifndef LD2412_HOST_STREAMS_H
+#define LD2412_HOST_STREAMS_H
+
+#include <Arduino.h>
+#include <deque>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * @brief In-memory Stream. Bytes fed to it become readable at a given time on the
+ * host clock, and everything written by the library is captured for inspection.
+ */
+class MemoryStream : public Stream {
+public:
+    /**
+     * @brief Called after every write() with the bytes just written
+     */
+    using WriteHook = std::function<void(const uint8_t* data, size_t len)>;
+
+    /**
+     * @brief Queues bytes to be read
+     * @param data Bytes the "sensor" sends
+     * @param len Length of data
+     * @param delayUs Delivery delay from now in microseconds (0 = readable immediately)
+     */
+    void feed(const uint8_t* data, size_t len, uint64_t delayUs = 0);
+    void feed(const std::vector<uint8_t>& data, uint64_t delayUs = 0);
+
+    /**
+     * @brief Sets a hook which sees every write, e.g. a simulated sensor replying to commands
+     */
+    void onWrite(WriteHook hook);
+
+    /**
+     * @brief Bytes written to the stream since the last clearWritten()
+     */
+    const std::vector<uint8_t>& written() const;
+    void clearWritten();
+
+    /**
+     * @brief Number of bytes fed but not yet read, including those not yet delivered
+     */
+    size_t pending() const;
+
+    /**
+     * @brief Limits availableForWrite() to emulate a small TX FIFO (default: unlimited)
+     */
+    void setWriteCapacity(int capacity);
+
+    /**
+     * @brief Emulates a UART at this rate: written bytes leave one character time (10 bits) apart
+     * and flush() waits for the last one (default: 0, written bytes leave at once)
+     */
+    void setBaud(unsigned long baud);
+
+    /**
+     * @brief Host time at which the last byte written has left the line
+     */
+    uint64_t lineFreeAt() const;
+
+    int available() override;
+    int read() override;
+    int peek() override;
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* data, size_t len) override;
+    int availableForWrite() override;
+    void flush() override;
+    using Print::write;
+
+private:
+    struct Chunk {
+        uint64_t readyAt;
+        size_t offset;
+        std::vector<uint8_t> bytes;
+    };
+    std::deque<Chunk> rx;
+    std::vector<uint8_t> tx;
+    WriteHook hook;
+    int writeCapacity = 4096;
+    unsigned long baud = 0;
+    uint64_t lineFree = 0;
+};
+
+/**
+ * @brief Stream over a non-blocking file descriptor (pty master, tty, pipe, socket)
+ */
+class FdStream : public Stream {
+public:
+    explicit FdStream(int fd = -1);
+    ~FdStream() override;
+
+    FdStream(const FdStream&) = delete;
+    FdStream& operator=(const FdStream&) = delete;
+
+    /**
+     * @brief File descriptor, -1 if closed
+     */
+    int fd() const;
+    void close();
+
+    int available() override;
+    int read() override;
+    int peek() override;
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* data, size_t len) override;
+    int availableForWrite() override;
+    void flush() override;
+    using Print::write;
+
+protected:
+    int handle;
+
+private:
+    static constexpr unsigned int RX_SIZE = 512;
+    uint8_t rxBuffer[RX_SIZE];
+    unsigned int rxHead = 0;
+    unsigned int rxTail = 0;
+
+    void fill();
+};
+
+/**
+ * @brief Pseudo-terminal backed Stream. The library talks to the master side; a simulator,
+ * socat or a second process attaches to slaveName() as if it were the sensor's UART.
+ */
+class PtyStream : public FdStream {
+public:
+    PtyStream();
+
+    /**
+     * @brief Whether the pty pair was created
+     */
+    bool isOpen() const;
+
+    /**
+     * @brief Path of the slave device (e.g. /dev/pts/3), empty if not open
+     */
+    const std::string& slaveName() const;
+
+private:
+    std::string slave;
+};
+
+/**
+ * @brief Serial device Stream (e.g. /dev/ttyUSB0) in raw 8N1 mode
+ */
+class TtyStream : public FdStream {
+public:
+    /**
+     * @brief Opens and configures the device
+     * @param path Device path
+     * @param baud Baud rate, one of the rates the LD2412 supports
+     */
+    TtyStream(const char* path, unsigned long baud);
+
+    /**
+     * @brief Whether the device was opened and configured
+     */
+    bool isOpen() const;
+
+    /**
+     * @brief Changes the line speed, e.g. after LD2412::setBaudRate() and a restart
+     * @return Success status
+     */
+    bool setBaud(unsigned long baud);
+};
+
+#endif //LD2412_HOST_STREAMS_H
@@ -0,0 +1,181 @@
+/**
+ * @file SimulatedSensor.cpp
+ * @author Trent Tobias
+ * @brief Simulated HLK-LD2412 attached to a MemoryStream
+ */
+
+#include "SimulatedSensor.h"
+
+#include <algorithm>
+
+SimulatedSensor::SimulatedSensor(MemoryStream& stream) : stream(stream) {
+    std::fill(std::begin(this->motionSensitivity), std::end(this->motionSensitivity), 30);
+    std::fill(std::begin(this->staticSensitivity), std::end(this->staticSensitivity), 30);
+    this->stream.onWrite([this](const uint8_t* data, size_t len) { receive(data, len); });
+}
+
+SimulatedSensor::~SimulatedSensor() {
+    this->stream.onWrite(nullptr);
+}
+
+bool SimulatedSensor::configMode() const {
+    return this->inConfig;
+}
+
+bool SimulatedSensor::report(const LD2412Frame& f) {
+    if (this->inConfig || host::nowMicros() < this->bootUntil)
+        return false;
+    std::vector<uint8_t> frame = {0xF4, 0xF3, 0xF2, 0xF1, 0x0B, 0x00, 0x02, 0xAA, f.state,
+                                  static_cast<uint8_t>(f.movingDistance), static_cast<uint8_t>(f.movingDistance >> 8),
+                                  f.movingEnergy,
+                                  static_cast<uint8_t>(f.staticDistance), static_cast<uint8_t>(f.staticDistance >> 8),
+                                  f.staticEnergy};
+    if (this->engineering) {
+        frame[4] = 0x28;
+        frame[6] = 0x01;
+        frame.insert(frame.end(), std::begin(this->movingEnergies), std::end(this->movingEnergies));
+        frame.insert(frame.end(), std::begin(this->staticEnergies), std::end(this->staticEnergies));
+        frame.push_back(this->light);
+    }
+    frame.insert(frame.end(), {0x55, 0x00, 0xF8, 0xF7, 0xF6, 0xF5});
+    this->stream.feed(frame);
+    return true;
+}
+
+void SimulatedSensor::receive(const uint8_t* data, size_t len) {
+    static const uint8_t HEADER[4] = {0xFD, 0xFC, 0xFB, 0xFA};
+    for (size_t i = 0; i < len; i++) {
+        //Hunts for the command header, then waits for length + data + footer
+        if (this->rx.size() < 4 && data[i] != HEADER[this->rx.size()]) {
+            this->rx.clear();
+            if (data[i] != HEADER[0])
+                continue;
+        }
+        this->rx.push_back(data[i]);
+        if (this->rx.size() < 6)
+            continue;
+        size_t frameLen = 10 + (this->rx[4] | this->rx[5] << 8);
+        if (this->rx.size() == frameLen) {
+            handle(this->rx.data() + 6, frameLen - 10);
+            this->rx.clear();
+        }
+    }
+}
+
+void SimulatedSensor::handle(const uint8_t* cmd, size_t len) {
+    //A rebooting module does not listen
+    if (len < 2 || host::nowMicros() < this->bootUntil)
+        return;
+    uint8_t word = cmd[0];
+    this->commands++;
+    this->lastCommand = word;
+
+    if (word == 0xFF) {
+        this->inConfig = true;
+        this->configSessions++;
+        ack(word, 0, {0x01, 0x00, 0x40, 0x00});
+        return;
+    }
+    //The module only takes commands inside a configuration session
+    if (!this->inConfig) {
+        ack(word, 1);
+        return;
+    }
+
+    uint64_t now = host::nowMicros();
+    switch (word) {
+        case 0xFE:
+            this->inConfig = false;
+            ack(word, 0);
+            //The restart takes effect when the session ends
+            if (this->restartPending) {
+                this->bootUntil = now + this->ackDelayUs + this->restartUs;
+                this->engineering = false;
+            }
+            this->restartPending = false;
+            break;
+        case 0x02:
+            if (len < 7)
+                return ack(word, 1);
+            this->minGate = cmd[2];
+            this->maxGate = cmd[3];
+            this->duration = cmd[4];
+            this->outPinPolarity = cmd[6];
+            ack(word, 0);
+            break;
+        case 0x12:
+            ack(word, 0, {this->minGate, this->maxGate, this->duration, 0x00, this->outPinPolarity});
+            break;
+        case 0x03:
+        case 0x04:
+            if (len < 16)
+                return ack(word, 1);
+            std::copy(cmd + 2, cmd + 16, word == 0x03 ? this->motionSensitivity : this->staticSensitivity);
+            ack(word, 0);
+            break;
+        case 0x13:
+            ack(word, 0, std::vector<uint8_t>(this->motionSensitivity, this->motionSensitivity + 14));
+            break;
+        case 0x14:
+            ack(word, 0, std::vector<uint8_t>(this->staticSensitivity, this->staticSensitivity + 14));
+            break;
+        case 0x0B:
+            this->calibrationStart = now + this->calibrationDelayUs;
+            ack(word, 0);
+            break;
+        case 0x1B: {
+            bool active = this->calibrationStart != 0 && now >= this->calibrationStart
+                && now < this->calibrationStart + this->calibrationUs;
+            ack(word, 0, {static_cast<uint8_t>(active), 0x00});
+            break;
+        }
+        case 0xA0:
+            ack(word, 0, {static_cast<uint8_t>(this->firmwareType), static_cast<uint8_t>(this->firmwareType >> 8),
+                          static_cast<uint8_t>(this->firmwareMajor), static_cast<uint8_t>(this->firmwareMajor >> 8),
+                          static_cast<uint8_t>(this->firmwareMinor), static_cast<uint8_t>(this->firmwareMinor >> 8),
+                          static_cast<uint8_t>(this->firmwareMinor >> 16), static_cast<uint8_t>(this->firmwareMinor >> 24)});
+            break;
+        case 0xA1:
+            if (cmd[2] < 1 || cmd[2] > 8)
+                return ack(word, 1);
+            this->baudIndex = cmd[2];
+            ack(word, 0);
+            break;
+        case 0xA2:
+            ack(word, 0);
+            break;
+        case 0x62:
+        case 0x63:
+            this->engineering = word == 0x62;
+            ack(word, 0);
+            break;
+        case 0xA3:
+            this->restarts++;
+            this->restartPending = true;
+            ack(word, 0);
+            break;
+        default:
+            ack(word, 1);
+            break;
+    }
+}
+
+void SimulatedSensor::ack(uint8_t word, uint8_t status, const std::vector<uint8_t>& payload) {
+    static const uint8_t HEADER[4] = {0xFD, 0xFC, 0xFB, 0xFA};
+    static const uint8_t FOOTER[4] = {0x04, 0x03, 0x02, 0x01};
+    std::vector<uint8_t> frame;
+    frame.reserve(14 + payload.size());
+    for (uint8_t b : HEADER)
+        frame.push_back(b);
+    frame.push_back(static_cast<uint8_t>(4 + payload.size()));
+    frame.push_back(0x00);
+    frame.push_back(word);
+    frame.push_back(0x01);
+    frame.push_back(status);
+    frame.push_back(0x00);
+    for (uint8_t b : payload)
+        frame.push_back(b);
+    for (uint8_t b : FOOTER)
+        frame.push_back(b);
+    this->stream.feed(frame, this->ackDelayUs);
+}
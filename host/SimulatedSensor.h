@@ -0,0 +1,77 @@
+/**
+ * @file SimulatedSensor.h
+ * @author Trent Tobias
+ * @brief Simulated HLK-LD2412 attached to a MemoryStream. Answers command frames with
+ * ACKs the way the module does and emits report frames on request.
+ */
+
+#ifndef LD2412_SIMULATED_SENSOR_H
+#define LD2412_SIMULATED_SENSOR_H
+
+#include "HostStreams.h"
+#include <LD2412Frame.h>
+
+class SimulatedSensor {
+public:
+    /**
+     * @brief Attaches to a stream; every command the library writes gets an ACK
+     * @param stream Stream shared with the LD2412 object
+     */
+    explicit SimulatedSensor(MemoryStream& stream);
+    ~SimulatedSensor();
+
+    SimulatedSensor(const SimulatedSensor&) = delete;
+    SimulatedSensor& operator=(const SimulatedSensor&) = delete;
+
+    /**
+     * @brief Feeds a report frame, dropped while in configuration mode or rebooting. In engineering
+     * mode it carries movingEnergies, staticEnergies and light
+     * @return Whether the frame was sent
+     */
+    bool report(const LD2412Frame& frame);
+
+    /**
+     * @brief Whether the module is currently in configuration mode
+     */
+    bool configMode() const;
+
+    /*-----Module state, freely editable by tests-----*/
+    uint8_t minGate = 1;
+    uint8_t maxGate = 12;
+    uint8_t duration = 5;
+    uint8_t outPinPolarity = 0;
+    uint8_t motionSensitivity[14] = {};
+    uint8_t staticSensitivity[14] = {};
+    uint16_t firmwareType = 0x2412;
+    uint16_t firmwareMajor = 0x0102;
+    uint32_t firmwareMinor = 0x25062416;
+    uint8_t baudIndex = 0x05;
+    bool engineering = false;
+    uint8_t movingEnergies[14] = {};
+    uint8_t staticEnergies[14] = {};
+    uint8_t light = 0;
+
+    uint64_t ackDelayUs = 2000;             //Time from end of command to ACK delivery
+    uint64_t calibrationDelayUs = 10000000; //Calibration starts 10 s after the command
+    uint64_t calibrationUs = 30000000;      //How long calibration runs
+    uint64_t calibrationStart = 0;          //Virtual time calibration began, 0 if never
+    uint64_t restartUs = 0;                 //Silence while the module reboots after a restart
+
+    unsigned int commands = 0;              //Commands received
+    unsigned int configSessions = 0;        //Enable-config commands received
+    unsigned int restarts = 0;              //Restart commands received
+    uint8_t lastCommand = 0;
+
+private:
+    MemoryStream& stream;
+    bool inConfig = false;
+    bool restartPending = false;            //Restart acknowledged, the module reboots when the session ends
+    uint64_t bootUntil = 0;                 //Virtual time the module finishes rebooting
+    std::vector<uint8_t> rx;
+
+    void receive(const uint8_t* data, size_t len);
+    void handle(const uint8_t* cmd, size_t len);
+    void ack(uint8_t word, uint8_t status, const std::vector<uint8_t>& payload = {});
+};
+
+#endif //LD2412_SIMULATED_SENSOR_H
@@ -0,0 +1,40 @@
+/**
+ * @file FileConfigStore.cpp
+ * @author Trent Tobias
+ * @brief Configuration fingerprint kept in a small text file
+ */
+
+#include "FileConfigStore.h"
+
+#include <cstdio>
+#include <unistd.h>
+
+FileConfigStore::FileConfigStore(std::string path) : path(std::move(path)) {
+}
+
+bool FileConfigStore::load(uint32_t& fingerprint) {
+    FILE* f = std::fopen(this->path.c_str(), "r");
+    if (f == nullptr)
+        return false;
+    unsigned int value;
+    bool ok = std::fscanf(f, "%8x", &value) == 1;
+    std::fclose(f);
+    if (ok)
+        fingerprint = value;
+    return ok;
+}
+
+bool FileConfigStore::save(uint32_t fingerprint) {
+    std::string tmp = this->path + ".tmp";
+    FILE* f = std::fopen(tmp.c_str(), "w");
+    if (f == nullptr)
+        return false;
+    bool ok = std::fprintf(f, "%08x\n", static_cast<unsigned int>(fingerprint)) > 0;
+    ok = std::fflush(f) == 0 && fsync(fileno(f)) == 0 && ok;
+    ok = std::fclose(f) == 0 && ok;
+    if (!ok || std::rename(tmp.c_str(), this->path.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        return false;
+    }
+    return true;
+}
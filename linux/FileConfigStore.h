@@ -0,0 +1,32 @@
+/**
+ * @file FileConfigStore.h
+ * @author Trent Tobias
+ * @brief Configuration fingerprint kept in a small text file, for Linux gateways
+ */
+
+#ifndef LD2412_FILE_CONFIG_STORE_H
+#define LD2412_FILE_CONFIG_STORE_H
+
+#include <LD2412Config.h>
+
+#include <string>
+
+class FileConfigStore : public LD2412ConfigStore {
+public:
+    /**
+     * @param path File holding the fingerprint, e.g. one per sensor under /var/lib
+     */
+    explicit FileConfigStore(std::string path);
+
+    bool load(uint32_t& fingerprint) override;
+
+    /**
+     * @brief Writes a temporary file and renames it into place, so a power cut never leaves a torn value
+     */
+    bool save(uint32_t fingerprint) override;
+
+private:
+    std::string path;
+};
+
+#endif //LD2412_FILE_CONFIG_STORE_H
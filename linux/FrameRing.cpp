@@ -0,0 +1,193 @@
+/**
+ * @file FrameRing.cpp
+ * @author Trent Tobias
+ * @brief POSIX shared-memory ring of decoded frames
+ */
+
+#include "FrameRing.h"
+
+#include <cstring>
+#include <fcntl.h>
+#include <new>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+FrameRecord FrameRecord::from(uint16_t sensor, const LD2412Frame& frame, uint64_t timestampUs) {
+    FrameRecord r = {};
+    r.timestampUs = timestampUs;
+    r.sensor = sensor;
+    r.state = frame.state;
+    r.movingEnergy = frame.movingEnergy;
+    r.movingDistance = frame.movingDistance;
+    r.staticDistance = frame.staticDistance;
+    r.staticEnergy = frame.staticEnergy;
+    return r;
+}
+
+uint64_t FrameRecord::nowUs() {
+    timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    return static_cast<uint64_t>(now.tv_sec) * 1000000 + static_cast<uint64_t>(now.tv_nsec) / 1000;
+}
+
+FrameRing::~FrameRing() {
+    unmap();
+}
+
+size_t FrameRing::sizeFor(uint32_t capacity) {
+    static_assert(sizeof(Header) == 128, "Slots start on the third cache line of the shared-memory layout");
+    return sizeof(Header) + capacity * sizeof(Slot);
+}
+
+FrameRing::Slot& FrameRing::slot(uint64_t n) const {
+    return reinterpret_cast<Slot*>(this->header + 1)[n & (this->header->capacity - 1)];
+}
+
+void FrameRing::unmap() {
+    if (this->header != nullptr)
+        munmap(this->header, this->mappedSize);
+    this->header = nullptr;
+    this->mappedSize = 0;
+}
+
+bool FrameRing::create(const char* name, uint32_t capacity) {
+    unmap();
+    uint32_t slots = 1;
+    while (slots < capacity)
+        slots <<= 1;
+
+    int fd = shm_open(name, O_CREAT | O_RDWR, 0644);
+    if (fd < 0)
+        return false;
+    size_t size = sizeFor(slots);
+    void* p = ftruncate(fd, size) == 0 ? mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (p == MAP_FAILED)
+        return false;
+
+    //Readers check the magic, so it is written last
+    std::memset(p, 0, size);
+    this->header = static_cast<Header*>(p);
+    this->mappedSize = size;
+    this->header->version = VERSION;
+    this->header->capacity = slots;
+    this->header->recordSize = sizeof(FrameRecord);
+    for (uint32_t i=0; i<slots; i++)
+        new (&slot(i)) Slot();
+    std::atomic_thread_fence(std::memory_order_release);
+    this->header->magic = MAGIC;
+    this->writer = true;
+    this->shmName = name;
+    return true;
+}
+
+bool FrameRing::attach(const char* name) {
+    unmap();
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    void* p = fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) >= sizeof(Header)
+        ? mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (p == MAP_FAILED)
+        return false;
+
+    this->header = static_cast<Header*>(p);
+    this->mappedSize = st.st_size;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (this->header->magic != MAGIC || this->header->version != VERSION
+        || this->header->recordSize != sizeof(FrameRecord) || sizeFor(this->header->capacity) > this->mappedSize) {
+        unmap();
+        return false;
+    }
+    this->writer = false;
+    this->shmName = name;
+    return true;
+}
+
+void FrameRing::unlink(const char* name) {
+    shm_unlink(name);
+}
+
+void FrameRing::publish(const FrameRecord& record) {
+    if (this->header == nullptr || !this->writer)
+        return;
+    uint64_t n = this->header->head.load(std::memory_order_relaxed);
+    Slot& slot = this->slot(n);
+
+    //Seqlock: odd while the record is being written
+    slot.seq.store(2*n + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(&slot.record, &record, sizeof(FrameRecord));
+    slot.seq.store(2*n + 2, std::memory_order_release);
+    this->header->head.store(n + 1, std::memory_order_release);
+}
+
+uint64_t FrameRing::head() const {
+    return this->header == nullptr ? 0 : this->header->head.load(std::memory_order_acquire);
+}
+
+uint32_t FrameRing::capacity() const {
+    return this->header == nullptr ? 0 : this->header->capacity;
+}
+
+/*-----Reader-----*/
+FrameRing::Reader::Reader(const FrameRing& ring) : ring(ring), position(ring.head()) {
+}
+
+const FrameRecord* FrameRing::Reader::peek() {
+    if (this->ring.header == nullptr)
+        return nullptr;
+    const uint64_t capacity = this->ring.header->capacity;
+
+    while (true) {
+        uint64_t head = this->ring.head();
+        if (this->position >= head)
+            return nullptr;
+        //Fell a full lap behind, jump to the oldest record still in the ring
+        if (head - this->position > capacity) {
+            this->skipped += head - capacity - this->position;
+            this->position = head - capacity;
+        }
+
+        const Slot& slot = this->ring.slot(this->position);
+        uint64_t seq = slot.seq.load(std::memory_order_acquire);
+        if (seq == 2*this->position + 2) {
+            this->expectedSeq = seq;
+            return &slot.record;
+        }
+        //Overwritten between reading head and the slot
+        this->skipped++;
+        this->position++;
+    }
+}
+
+bool FrameRing::Reader::release() {
+    const Slot& slot = this->ring.slot(this->position);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    bool intact = slot.seq.load(std::memory_order_relaxed) == this->expectedSeq;
+    if (!intact)
+        this->skipped++;
+    this->position++;
+    return intact;
+}
+
+bool FrameRing::Reader::next(FrameRecord& out) {
+    while (const FrameRecord* record = peek()) {
+        std::memcpy(&out, record, sizeof(FrameRecord));
+        if (release())
+            return true;
+    }
+    return false;
+}
+
+uint64_t FrameRing::Reader::lost() const {
+    return this->skipped;
+}
+
+uint64_t FrameRing::Reader::cursor() const {
+    return this->position;
+}
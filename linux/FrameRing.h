@@ -0,0 +1,157 @@
+/**
+ * @file FrameRing.h
+ * @author Trent Tobias
+ * @brief POSIX shared-memory ring of decoded frames: one lock-free writer (the aggregator),
+ * any number of readers in other processes, each with its own cursor
+ */
+
+#ifndef LD2412_FRAME_RING_H
+#define LD2412_FRAME_RING_H
+
+#include <LD2412Frame.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Fixed-layout frame record as stored in the ring
+ */
+struct FrameRecord {
+    uint64_t timestampUs;           //Gateway wall clock when the frame was decoded, us since the Unix epoch
+    uint16_t sensor;                //Index of the sensor in the aggregator
+    uint8_t state;
+    uint8_t movingEnergy;
+    uint16_t movingDistance;
+    uint16_t staticDistance;
+    uint8_t staticEnergy;
+    uint8_t reserved[7];
+
+    static FrameRecord from(uint16_t sensor, const LD2412Frame& frame, uint64_t timestampUs);
+
+    /**
+     * @brief Current wall clock (CLOCK_REALTIME) in us since the Unix epoch, the timestamp of a
+     * record decoded now. Logs from different runs and gateways share it
+     */
+    static uint64_t nowUs();
+};
+
+static_assert(sizeof(FrameRecord) == 24, "FrameRecord is part of the shared-memory layout");
+
+class FrameRing {
+public:
+    static constexpr uint32_t MAGIC = 0x4C443234;       //"LD24"
+    static constexpr uint32_t VERSION = 2;              //2: Unix-epoch timestamps
+
+    FrameRing() = default;
+    ~FrameRing();
+
+    FrameRing(const FrameRing&) = delete;
+    FrameRing& operator=(const FrameRing&) = delete;
+
+    /**
+     * @brief Creates (or recreates) the ring as its writer
+     * @param name Shared memory name, e.g. "/ld2412"
+     * @param capacity Number of slots, rounded up to a power of two
+     * @return Success status
+     */
+    bool create(const char* name, uint32_t capacity);
+
+    /**
+     * @brief Attaches to an existing ring as a read-only consumer
+     * @param name Shared memory name
+     * @return Success status
+     */
+    bool attach(const char* name);
+
+    /**
+     * @brief Removes the shared memory object (the writer does this on shutdown)
+     */
+    static void unlink(const char* name);
+
+    /**
+     * @brief Publishes a record, never blocks. Readers that fall more than capacity() behind lose records
+     */
+    void publish(const FrameRecord& record);
+
+    /**
+     * @brief Number of records published so far
+     */
+    uint64_t head() const;
+
+    uint32_t capacity() const;
+
+    /**
+     * @brief Independent read cursor. Starts at the current head so only new records are seen
+     */
+    class Reader {
+    public:
+        explicit Reader(const FrameRing& ring);
+
+        /**
+         * @brief Zero-copy access to the next record. The pointer refers into shared memory and
+         * must be confirmed with release() after use; a false return means the writer overwrote it
+         * @return Pointer to the record or nullptr if none is ready
+         */
+        const FrameRecord* peek();
+
+        /**
+         * @brief Confirms the record from peek() was not overwritten while in use and advances
+         * @return True if the record was intact
+         */
+        bool release();
+
+        /**
+         * @brief Copies the next record out
+         * @return True if a record was read
+         */
+        bool next(FrameRecord& out);
+
+        /**
+         * @brief Records skipped because this reader was overrun
+         */
+        uint64_t lost() const;
+
+        /**
+         * @brief Position of the next record to read
+         */
+        uint64_t cursor() const;
+
+    private:
+        const FrameRing& ring;
+        uint64_t position;
+        uint64_t skipped = 0;
+        uint64_t expectedSeq = 0;
+    };
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> seq;      //2n+1 while record n is written, 2n+2 once complete
+        FrameRecord record;
+    };
+
+    //The slots follow the header directly, on the next cache line
+    struct alignas(64) Header {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t capacity;
+        uint32_t recordSize;
+        alignas(64) std::atomic<uint64_t> head;
+    };
+
+    Header* header = nullptr;
+    size_t mappedSize = 0;
+    bool writer = false;
+    std::string shmName;
+
+    static size_t sizeFor(uint32_t capacity);
+
+    /**
+     * @brief Slot holding record n
+     */
+    Slot& slot(uint64_t n) const;
+    void unmap();
+};
+
+#endif //LD2412_FRAME_RING_H
@@ -0,0 +1,171 @@
+/**
+ * @file FrameServer.cpp
+ * @author Trent Tobias
+ * @brief Unix-domain socket server streaming decoded frames to local subscribers
+ */
+
+#include "FrameServer.h"
+
+#include <cerrno>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+FrameServer::~FrameServer() {
+    close();
+}
+
+bool FrameServer::listen(const char* path, SlowPolicy policy) {
+    close();
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    if (std::strlen(path) >= sizeof(addr.sun_path))
+        return false;
+    std::strcpy(addr.sun_path, path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        return false;
+    ::unlink(path);
+    if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || ::listen(fd, 16) != 0) {
+        ::close(fd);
+        return false;
+    }
+    this->listenFd = fd;
+    this->socketPath = path;
+    this->defaultPolicy = policy;
+    return true;
+}
+
+void FrameServer::close() {
+    for (Subscriber& s : this->clients)
+        ::close(s.fd);
+    this->clients.clear();
+    if (this->listenFd >= 0) {
+        ::close(this->listenFd);
+        ::unlink(this->socketPath.c_str());
+    }
+    this->listenFd = -1;
+}
+
+size_t FrameServer::subscribers() const {
+    return this->clients.size();
+}
+
+uint64_t FrameServer::dropped() const {
+    return this->totalDropped;
+}
+
+void FrameServer::publish(const FrameRecord& record) {
+    for (Subscriber& s : this->clients)
+        enqueue(s, record);
+}
+
+void FrameServer::enqueue(Subscriber& s, const FrameRecord& record) {
+    if (s.policy == SlowPolicy::Decimate) {
+        //Keep 1 in N frames, N doubling with every further quarter of the queue filled
+        unsigned int wanted = 1;
+        for (unsigned int level = QUEUE_SIZE / 4; s.count >= level && wanted < 64; level += QUEUE_SIZE / 4)
+            wanted *= 2;
+        if (s.count == 0)
+            wanted = 1;
+        s.decimation = wanted;
+        if (s.decimationCounter++ % s.decimation != 0) {
+            s.droppedSinceBatch++;
+            this->totalDropped++;
+            return;
+        }
+    }
+
+    if (s.count == QUEUE_SIZE) {
+        s.head = (s.head + 1) % QUEUE_SIZE;
+        s.count--;
+        s.droppedSinceBatch++;
+        this->totalDropped++;
+    }
+    s.queue[(s.head + s.count) % QUEUE_SIZE] = record;
+    s.count++;
+}
+
+bool FrameServer::readControl(Subscriber& s) {
+    char buf[64];
+    while (true) {
+        ssize_t n = recv(s.fd, buf, sizeof(buf), 0);
+        if (n == 0)
+            return false;
+        if (n < 0)
+            return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+        if (s.configured)
+            continue;
+        s.control.append(buf, n);
+        size_t nl = s.control.find('\n');
+        if (nl == std::string::npos) {
+            if (s.control.size() > 64)
+                s.configured = true;
+            continue;
+        }
+        std::string line = s.control.substr(0, nl);
+        if (line == "policy=drop-oldest")
+            s.policy = SlowPolicy::DropOldest;
+        else if (line == "policy=decimate")
+            s.policy = SlowPolicy::Decimate;
+        s.configured = true;
+    }
+}
+
+bool FrameServer::flush(Subscriber& s) {
+    while (true) {
+        if (s.outOffset == s.out.size()) {
+            if (s.count == 0 && s.droppedSinceBatch == 0)
+                return true;
+
+            //Next batch: header plus up to BATCH_SIZE queued frames in one write
+            unsigned int n = s.count < BATCH_SIZE ? s.count : BATCH_SIZE;
+            FrameBatchHeader header = {FrameBatchHeader::MAGIC, FrameBatchHeader::VERSION,
+                                       sizeof(FrameRecord), static_cast<uint16_t>(n), 0, s.droppedSinceBatch};
+            s.out.resize(sizeof(header) + n * sizeof(FrameRecord));
+            std::memcpy(s.out.data(), &header, sizeof(header));
+            for (unsigned int i = 0; i < n; i++)
+                std::memcpy(s.out.data() + sizeof(header) + i * sizeof(FrameRecord),
+                            &s.queue[(s.head + i) % QUEUE_SIZE], sizeof(FrameRecord));
+            s.head = (s.head + n) % QUEUE_SIZE;
+            s.count -= n;
+            s.droppedSinceBatch = 0;
+            s.outOffset = 0;
+        }
+
+        ssize_t n = send(s.fd, s.out.data() + s.outOffset, s.out.size() - s.outOffset, MSG_NOSIGNAL);
+        if (n < 0)
+            return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+        s.outOffset += n;
+        if (s.outOffset < s.out.size())
+            return true;
+    }
+}
+
+void FrameServer::poll() {
+    if (this->listenFd < 0)
+        return;
+    while (true) {
+        int fd = accept4(this->listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0)
+            break;
+        Subscriber s;
+        s.fd = fd;
+        s.policy = this->defaultPolicy;
+        s.queue.resize(QUEUE_SIZE);
+        s.out.reserve(sizeof(FrameBatchHeader) + BATCH_SIZE * sizeof(FrameRecord));
+        this->clients.push_back(std::move(s));
+    }
+
+    for (size_t i = 0; i < this->clients.size();) {
+        Subscriber& s = this->clients[i];
+        if (readControl(s) && flush(s)) {
+            i++;
+            continue;
+        }
+        ::close(s.fd);
+        this->clients.erase(this->clients.begin() + i);
+    }
+}
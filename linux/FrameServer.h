@@ -0,0 +1,114 @@
+/**
+ * @file FrameServer.h
+ * @author Trent Tobias
+ * @brief Unix-domain socket server streaming decoded frames to local subscribers.
+ *
+ * Wire format (host byte order), repeated for as long as the connection is open:
+ *   FrameBatchHeader followed by header.count FrameRecord entries (24 bytes each)
+ * A subscriber may send one optional line right after connecting to pick how it is treated
+ * when it falls behind: "policy=drop-oldest\n" or "policy=decimate\n".
+ *
+ * Everything is non-blocking: publish() only queues, poll() accepts, batches and writes
+ * what each socket takes. A slow subscriber only ever loses its own frames.
+ */
+
+#ifndef LD2412_FRAME_SERVER_H
+#define LD2412_FRAME_SERVER_H
+
+#include "FrameRing.h"
+
+#include <string>
+#include <vector>
+
+struct FrameBatchHeader {
+    static constexpr uint16_t MAGIC = 0x464C;       //"LF"
+    static constexpr uint8_t VERSION = 2;           //2: Unix-epoch timestamps
+
+    uint16_t magic;
+    uint8_t version;
+    uint8_t recordSize;             //sizeof(FrameRecord)
+    uint16_t count;                 //Records following this header
+    uint16_t reserved;
+    uint32_t dropped;               //Frames dropped for this subscriber since the previous batch
+};
+
+static_assert(sizeof(FrameBatchHeader) == 12, "FrameBatchHeader is part of the wire format");
+
+class FrameServer {
+public:
+    /**
+     * @brief What happens when a subscriber's queue backs up
+     */
+    enum class SlowPolicy {
+        DropOldest,         //Keep the newest frames, discard the oldest queued ones
+        Decimate            //Keep every 2nd, 4th, ... frame while backed up, back to all once drained
+    };
+
+    static constexpr unsigned int QUEUE_SIZE = 1024;    //Queued frames per subscriber
+    static constexpr unsigned int BATCH_SIZE = 64;      //Max frames per write
+
+    FrameServer() = default;
+    ~FrameServer();
+
+    FrameServer(const FrameServer&) = delete;
+    FrameServer& operator=(const FrameServer&) = delete;
+
+    /**
+     * @brief Binds and listens, replacing a stale socket file at the path
+     * @param path Socket path
+     * @param policy Default slow-subscriber policy
+     * @return Success status
+     */
+    bool listen(const char* path, SlowPolicy policy);
+
+    /**
+     * @brief Queues a frame for every subscriber, never blocks
+     */
+    void publish(const FrameRecord& record);
+
+    /**
+     * @brief Accepts new subscribers, reads their policy line and writes queued batches.
+     * Call once per aggregator loop iteration
+     */
+    void poll();
+
+    /**
+     * @brief Number of connected subscribers
+     */
+    size_t subscribers() const;
+
+    /**
+     * @brief Total frames dropped across all subscribers
+     */
+    uint64_t dropped() const;
+
+    void close();
+
+private:
+    struct Subscriber {
+        int fd;
+        SlowPolicy policy;
+        std::vector<FrameRecord> queue;     //Ring of QUEUE_SIZE
+        unsigned int head = 0;
+        unsigned int count = 0;
+        unsigned int decimation = 1;
+        unsigned int decimationCounter = 0;
+        uint32_t droppedSinceBatch = 0;
+        std::vector<uint8_t> out;           //Batch being written
+        size_t outOffset = 0;
+        std::string control;                //Partial policy line
+        bool configured = false;
+    };
+
+    int listenFd = -1;
+    std::string socketPath;
+    SlowPolicy defaultPolicy = SlowPolicy::DropOldest;
+    std::vector<Subscriber> clients;
+    uint64_t totalDropped = 0;
+
+    void enqueue(Subscriber& s, const FrameRecord& record);
+    bool readControl(Subscriber& s);
+    bool flush(Subscriber& s);
+};
+
+#endif //LD2412_FRAME_SERVER_H
@@ -0,0 +1,257 @@
+/**
+ * @file MetricsExporter.cpp
+ * @author Trent Tobias
+ * @brief Prometheus text exposition of sensor link health counters
+ */
+
+#include "MetricsExporter.h"
+
+#include <cstdio>
+#include <cstring>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+    std::string escape(const std::string& value) {
+        std::string out;
+        for (char c : value) {
+            if (c == '\\' || c == '"')
+                out += '\\';
+            if (c == '\n')
+                out += "\\n";
+            else
+                out += c;
+        }
+        return out;
+    }
+
+    void family(std::string& out, const char* name, const char* type, const char* help) {
+        out += "# HELP ";
+        out += name;
+        out += ' ';
+        out += help;
+        out += "\n# TYPE ";
+        out += name;
+        out += ' ';
+        out += type;
+        out += '\n';
+    }
+
+    void sample(std::string& out, const char* name, const std::string& labels, double value) {
+        char num[32];
+        std::snprintf(num, sizeof(num), "%.15g", value);
+        out += name;
+        out += '{';
+        out += labels;
+        out += "} ";
+        out += num;
+        out += '\n';
+    }
+
+    void histogram(std::string& out, const char* name, const std::string& labels,
+                   const uint32_t* counts, const unsigned long* bounds, unsigned int buckets, uint32_t sum) {
+        std::string bucketName = std::string(name) + "_bucket";
+        uint64_t cumulative = 0;
+        for (unsigned int b = 0; b < buckets; b++) {
+            cumulative += counts[b];
+            std::string le = b < buckets - 1 ? std::to_string(bounds[b]) : "+Inf";
+            sample(out, bucketName.c_str(), labels + ",le=\"" + le + "\"", cumulative);
+        }
+        sample(out, (std::string(name) + "_sum").c_str(), labels, sum);
+        sample(out, (std::string(name) + "_count").c_str(), labels, cumulative);
+    }
+}
+
+MetricsExporter::MetricsExporter(const std::vector<std::string>& devices)
+    : labels(devices), slots(new Slot[devices.size()]), rates(devices.size()) {
+}
+
+MetricsExporter::~MetricsExporter() {
+    stop();
+}
+
+void MetricsExporter::publish(size_t sensor, const LD2412Stats& stats, unsigned long now) {
+    if (sensor >= this->labels.size())
+        return;
+
+    Rate& rate = this->rates[sensor];
+    if (!rate.started) {
+        rate = {stats.frames, now, 0, true};
+    }
+    else if (static_cast<uint32_t>(now - rate.since) >= RATE_WINDOW_MS) {
+        //32-bit differences, millis() rolls over after ~49.7 days
+        rate.value = (stats.frames - rate.frames) * 1000.0 / static_cast<uint32_t>(now - rate.since);
+        rate.frames = stats.frames;
+        rate.since = now;
+    }
+
+    Slot& slot = this->slots[sensor];
+    uint32_t seq = slot.seq.load(std::memory_order_relaxed);
+    slot.seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.data.stats = stats;
+    slot.data.updated = now;
+    slot.data.frameRate = rate.value;
+    slot.data.stalled = stats.frames == 0 || static_cast<uint32_t>(now - stats.lastFrame) > STALL_MS;
+    slot.seq.store(seq + 2, std::memory_order_release);
+}
+
+bool MetricsExporter::snapshot(size_t sensor, Snapshot& out) const {
+    if (sensor >= this->labels.size())
+        return false;
+    const Slot& slot = this->slots[sensor];
+    while (true) {
+        uint32_t seq = slot.seq.load(std::memory_order_acquire);
+        if (seq & 1)
+            continue;
+        std::memcpy(&out, &slot.data, sizeof(Snapshot));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.seq.load(std::memory_order_relaxed) == seq)
+            return seq != 0;
+    }
+}
+
+std::string MetricsExporter::render() const {
+    std::vector<Snapshot> snaps;
+    std::vector<std::string> sensorLabels;
+    for (size_t i = 0; i < this->labels.size(); i++) {
+        Snapshot s;
+        if (!snapshot(i, s))
+            continue;
+        snaps.push_back(s);
+        sensorLabels.push_back("sensor=\"" + std::to_string(i) + "\",device=\"" + escape(this->labels[i]) + "\"");
+    }
+
+    struct Counter {
+        const char* name;
+        const char* help;
+        uint32_t LD2412Stats::*field;
+    };
+    static const Counter counters[] = {
+        {"ld2412_frames_total", "Report frames captured.", &LD2412Stats::frames},
+        {"ld2412_resyncs_total", "Reads that skipped bytes to find a frame header.", &LD2412Stats::resyncs},
+        {"ld2412_frame_errors_total", "Frames dropped on a bad footer.", &LD2412Stats::frameErrors},
+        {"ld2412_ack_timeouts_total", "Commands that got no response in time.", &LD2412Stats::ackTimeouts},
+        {"ld2412_ack_errors_total", "Command responses that failed verification.", &LD2412Stats::ackErrors},
+    };
+
+    std::string out;
+    for (const Counter& c : counters) {
+        family(out, c.name, "counter", c.help);
+        for (size_t i = 0; i < snaps.size(); i++)
+            sample(out, c.name, sensorLabels[i], snaps[i].stats.*c.field);
+    }
+
+    family(out, "ld2412_ack_latency_ms", "histogram", "Command round trip in milliseconds.");
+    for (size_t i = 0; i < snaps.size(); i++)
+        histogram(out, "ld2412_ack_latency_ms", sensorLabels[i], snaps[i].stats.ackLatency,
+                  LD2412Stats::ACK_BOUNDS, LD2412Stats::ACK_BUCKETS, snaps[i].stats.ackLatencySum);
+
+    family(out, "ld2412_frame_interval_ms", "histogram", "Time between consecutive report frames in milliseconds.");
+    for (size_t i = 0; i < snaps.size(); i++)
+        histogram(out, "ld2412_frame_interval_ms", sensorLabels[i], snaps[i].stats.frameInterval,
+                  LD2412Stats::INTERVAL_BOUNDS, LD2412Stats::INTERVAL_BUCKETS, snaps[i].stats.frameIntervalSum);
+
+    family(out, "ld2412_frame_rate", "gauge", "Report frames per second.");
+    for (size_t i = 0; i < snaps.size(); i++)
+        sample(out, "ld2412_frame_rate", sensorLabels[i], snaps[i].frameRate);
+
+    family(out, "ld2412_last_frame_age_ms", "gauge", "Milliseconds since the latest report frame.");
+    for (size_t i = 0; i < snaps.size(); i++) {
+        uint32_t age = snaps[i].updated - snaps[i].stats.lastFrame;
+        sample(out, "ld2412_last_frame_age_ms", sensorLabels[i], snaps[i].stats.frames == 0 ? -1.0 : age);
+    }
+
+    family(out, "ld2412_stalled", "gauge", "1 if no report frame arrived within the stall window.");
+    for (size_t i = 0; i < snaps.size(); i++)
+        sample(out, "ld2412_stalled", sensorLabels[i], snaps[i].stalled ? 1 : 0);
+    return out;
+}
+
+bool MetricsExporter::writeFile(const char* path) const {
+    std::string text = render();
+    std::string tmp = std::string(path) + ".tmp";
+    FILE* f = std::fopen(tmp.c_str(), "w");
+    if (f == nullptr)
+        return false;
+    bool ok = std::fwrite(text.data(), 1, text.size(), f) == text.size();
+    ok = std::fclose(f) == 0 && ok;
+    if (!ok || std::rename(tmp.c_str(), path) != 0) {
+        std::remove(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool MetricsExporter::start(const char* socketPath, const char* filePath) {
+    stop();
+    this->filePath = filePath != nullptr ? filePath : "";
+    if (socketPath != nullptr) {
+        sockaddr_un addr = {};
+        addr.sun_family = AF_UNIX;
+        if (std::strlen(socketPath) >= sizeof(addr.sun_path))
+            return false;
+        std::strcpy(addr.sun_path, socketPath);
+        int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0)
+            return false;
+        ::unlink(socketPath);
+        if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(fd, 8) != 0) {
+            close(fd);
+            return false;
+        }
+        this->listenFd = fd;
+        this->socketPath = socketPath;
+    }
+    this->running = true;
+    this->worker = std::thread(&MetricsExporter::run, this);
+    return true;
+}
+
+void MetricsExporter::requestDump() {
+    this->dumpRequested.store(true, std::memory_order_relaxed);
+}
+
+void MetricsExporter::stop() {
+    if (this->worker.joinable()) {
+        this->running = false;
+        this->worker.join();
+    }
+    if (this->listenFd >= 0) {
+        close(this->listenFd);
+        ::unlink(this->socketPath.c_str());
+    }
+    this->listenFd = -1;
+}
+
+void MetricsExporter::run() {
+    while (this->running) {
+        if (this->dumpRequested.exchange(false) && !this->filePath.empty())
+            writeFile(this->filePath.c_str());
+
+        if (this->listenFd < 0) {
+            usleep(100000);
+            continue;
+        }
+        pollfd p = {this->listenFd, POLLIN, 0};
+        if (poll(&p, 1, 100) <= 0)
+            continue;
+        int fd = accept4(this->listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0)
+            continue;
+
+        //One scrape per connection; a stuck client only holds up this thread, and only briefly
+        timeval timeout = {1, 0};
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        std::string text = render();
+        for (size_t sent = 0; sent < text.size();) {
+            ssize_t n = send(fd, text.data() + sent, text.size() - sent, MSG_NOSIGNAL);
+            if (n <= 0)
+                break;
+            sent += n;
+        }
+        close(fd);
+    }
+}
@@ -0,0 +1,113 @@
+/**
+ * @file MetricsExporter.h
+ * @author Trent Tobias
+ * @brief Prometheus text exposition of every managed sensor's link health counters.
+ *
+ * The parsing loop publishes each sensor's LD2412Stats into a per-sensor seqlock slot; a
+ * background thread renders snapshots on demand, to a Unix socket (one scrape per connection)
+ * and/or a file written atomically, so scraping never takes a lock the parser waits on.
+ */
+
+#ifndef LD2412_METRICS_EXPORTER_H
+#define LD2412_METRICS_EXPORTER_H
+
+#include <LD2412Stats.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+class MetricsExporter {
+public:
+    static constexpr unsigned long STALL_MS = 1000;         //No frame for this long means stalled
+    static constexpr unsigned long RATE_WINDOW_MS = 1000;   //Frame rate averaging window
+
+    /**
+     * @brief Point-in-time view of one sensor
+     */
+    struct Snapshot {
+        LD2412Stats stats;
+        unsigned long updated;      //Publisher's millis() at the snapshot
+        double frameRate;           //Frames per second over the last window
+        bool stalled;
+    };
+
+    /**
+     * @param devices One label per sensor, indexed like the publisher's sensors
+     */
+    explicit MetricsExporter(const std::vector<std::string>& devices);
+    ~MetricsExporter();
+
+    MetricsExporter(const MetricsExporter&) = delete;
+    MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+    /**
+     * @brief Publishes a sensor's counters. Single writer, never blocks
+     * @param sensor Sensor index
+     * @param stats Counters from LD2412::getStats()
+     * @param now millis()
+     */
+    void publish(size_t sensor, const LD2412Stats& stats, unsigned long now);
+
+    /**
+     * @brief Reads a consistent snapshot, from any thread
+     * @return False if nothing was published for the sensor yet
+     */
+    bool snapshot(size_t sensor, Snapshot& out) const;
+
+    /**
+     * @brief Renders all published sensors in Prometheus text format
+     */
+    std::string render() const;
+
+    /**
+     * @brief Writes render() to a temporary file and renames it into place
+     * @return Success status
+     */
+    bool writeFile(const char* path) const;
+
+    /**
+     * @brief Starts the exporter thread
+     * @param socketPath Unix socket answering each connection with a scrape (nullptr for none)
+     * @param filePath File written on requestDump() (nullptr for none)
+     * @return Success status
+     */
+    bool start(const char* socketPath, const char* filePath);
+
+    /**
+     * @brief Asks the exporter thread to write the metrics file
+     */
+    void requestDump();
+
+    void stop();
+
+private:
+    struct Slot {
+        std::atomic<uint32_t> seq{0};   //Odd while the snapshot is being written
+        Snapshot data;
+    };
+
+    struct Rate {
+        uint32_t frames = 0;
+        unsigned long since = 0;
+        double value = 0;
+        bool started = false;
+    };
+
+    std::vector<std::string> labels;
+    std::unique_ptr<Slot[]> slots;
+    std::vector<Rate> rates;        //Publisher only
+
+    int listenFd = -1;
+    std::string socketPath;
+    std::string filePath;
+    std::thread worker;
+    std::atomic<bool> running{false};
+    std::atomic<bool> dumpRequested{false};
+
+    void run();
+};
+
+#endif //LD2412_METRICS_EXPORTER_H
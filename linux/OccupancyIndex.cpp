@@ -0,0 +1,140 @@
+/**
+ * @file OccupancyIndex.cpp
+ * @author Trent Tobias
+ * @brief Occupancy interval index over recorded frame logs
+ */
+
+#include "OccupancyIndex.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+void OccupancyIndex::build(const FrameRecord* records, size_t count, unsigned int threads) {
+    //Group by sensor in one pass, keeping each sensor's records in log order
+    size_t sensors = 0;
+    for (size_t i=0; i<count; i++)
+        sensors = std::max<size_t>(sensors, records[i].sensor + 1u);
+    std::vector<std::vector<const FrameRecord*>> groups(sensors);
+    for (size_t i=0; i<count; i++)
+        groups[records[i].sensor].push_back(&records[i]);
+
+    this->index.assign(sensors, Sensor());
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = static_cast<unsigned int>(std::min<size_t>(threads, std::max<size_t>(sensors, 1)));
+
+    //Sensors are independent: workers take the next one until all are built
+    std::atomic<size_t> next(0);
+    auto work = [&]() {
+        for (size_t s = next++; s < sensors; s = next++)
+            buildSensor(this->index[s], groups[s]);
+    };
+    std::vector<std::thread> workers;
+    for (unsigned int t=1; t<threads; t++)
+        workers.emplace_back(work);
+    work();
+    for (std::thread& worker : workers)
+        worker.join();
+}
+
+bool OccupancyIndex::load(const char* path, unsigned int threads) {
+    FILE* file = std::fopen(path, "rb");
+    if (file == nullptr)
+        return false;
+    std::vector<uint8_t> bytes;
+    uint8_t chunk[65536];
+    size_t n;
+    while ((n = std::fread(chunk, 1, sizeof(chunk), file)) > 0)
+        bytes.insert(bytes.end(), chunk, chunk + n);
+    bool failed = std::ferror(file) != 0;
+    std::fclose(file);
+    if (failed || bytes.size() % sizeof(FrameRecord) != 0)
+        return false;
+
+    std::vector<FrameRecord> records(bytes.size() / sizeof(FrameRecord));
+    if (!records.empty())
+        std::memcpy(records.data(), bytes.data(), bytes.size());
+    build(records.data(), records.size(), threads);
+    return true;
+}
+
+size_t OccupancyIndex::sensors() const {
+    return this->index.size();
+}
+
+const std::vector<OccupancyIndex::Interval>& OccupancyIndex::intervals(size_t sensor) const {
+    static const std::vector<Interval> none;
+    return sensor < this->index.size() ? this->index[sensor].intervals : none;
+}
+
+uint64_t OccupancyIndex::occupiedTime(size_t sensor, uint64_t t1, uint64_t t2) const {
+    if (sensor >= this->index.size() || t2 <= t1)
+        return 0;
+    const Sensor& s = this->index[sensor];
+    return occupiedBefore(s, t2) - occupiedBefore(s, t1);
+}
+
+bool OccupancyIndex::firstPresence(size_t sensor, uint64_t t, uint64_t& at) const {
+    if (sensor >= this->index.size())
+        return false;
+    const std::vector<Interval>& intervals = this->index[sensor].intervals;
+    //First interval still running at t
+    auto it = std::upper_bound(intervals.begin(), intervals.end(), t,
+                               [](uint64_t time, const Interval& interval) { return time < interval.endUs; });
+    if (it == intervals.end())
+        return false;
+    at = std::max(t, it->startUs);
+    return true;
+}
+
+uint64_t OccupancyIndex::occupiedBefore(const Sensor& sensor, uint64_t t) {
+    //Intervals starting before t, the last of which may still run past it
+    auto it = std::lower_bound(sensor.intervals.begin(), sensor.intervals.end(), t,
+                               [](const Interval& interval, uint64_t time) { return interval.startUs < time; });
+    size_t k = it - sensor.intervals.begin();
+    uint64_t total = sensor.occupied[k];
+    if (k > 0 && sensor.intervals[k - 1].endUs > t)
+        total -= sensor.intervals[k - 1].endUs - t;
+    return total;
+}
+
+void OccupancyIndex::buildSensor(Sensor& sensor, std::vector<const FrameRecord*>& records) {
+    std::stable_sort(records.begin(), records.end(),
+                     [](const FrameRecord* a, const FrameRecord* b) { return a->timestampUs < b->timestampUs; });
+
+    bool open = false;
+    uint64_t start = 0;
+    uint64_t lastSeen = 0;
+    for (const FrameRecord* record : records) {
+        uint64_t t = record->timestampUs;
+        if (open && t - lastSeen > MAX_GAP_US) {
+            //The log has a hole: the last frame with a target is all that is known
+            sensor.intervals.push_back({start, lastSeen});
+            open = false;
+        }
+        if (record->state != 0) {
+            if (!open) {
+                open = true;
+                start = t;
+            }
+            lastSeen = t;
+        }
+        else if (open) {
+            sensor.intervals.push_back({start, t});
+            open = false;
+        }
+    }
+    if (open)
+        sensor.intervals.push_back({start, lastSeen});
+
+    //Single-frame runs at a hole have no length
+    sensor.intervals.erase(std::remove_if(sensor.intervals.begin(), sensor.intervals.end(),
+                                          [](const Interval& interval) { return interval.endUs <= interval.startUs; }),
+                           sensor.intervals.end());
+    sensor.occupied.assign(sensor.intervals.size() + 1, 0);
+    for (size_t i=0; i<sensor.intervals.size(); i++)
+        sensor.occupied[i + 1] = sensor.occupied[i] + sensor.intervals[i].endUs - sensor.intervals[i].startUs;
+}
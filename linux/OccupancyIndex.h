@@ -0,0 +1,100 @@
+/**
+ * @file OccupancyIndex.h
+ * @author Trent Tobias
+ * @brief Occupied intervals of every sensor in a recorded frame log, indexed for log-time queries.
+ *
+ * A log is a sequence of FrameRecords (as published in the ring or sent to subscribers), any
+ * number of sensors interleaved. Building groups the records by sensor and turns each sensor's
+ * frames into sorted, disjoint occupied intervals, one worker thread per group of sensors. Each
+ * sensor also gets a running total of occupied time, the summary that lets "occupied time
+ * between t1 and t2" and "first presence after t" answer with two binary searches instead of a
+ * scan of the raw frames. The index is immutable once built, so queries need no locking.
+ *
+ * All times, in intervals and queries alike, are the records' timestamps: us since the Unix
+ * epoch on the gateway's wall clock (FrameRecord::nowUs()), so logs from different runs can be
+ * concatenated and queried with calendar times.
+ */
+
+#ifndef LD2412_OCCUPANCY_INDEX_H
+#define LD2412_OCCUPANCY_INDEX_H
+
+#include <FrameRing.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class OccupancyIndex {
+public:
+    static constexpr uint64_t MAX_GAP_US = 5000000;     //Longer without a frame ends an interval at the last frame
+
+    /**
+     * @brief Occupied from start (inclusive) to end (exclusive), us since the Unix epoch
+     */
+    struct Interval {
+        uint64_t startUs;
+        uint64_t endUs;
+    };
+
+    /**
+     * @brief Builds the index from a log. An interval runs from the first frame with a target to
+     * the next frame without one, or to the last frame with one if the log stops or has a gap
+     * @param records Frame log, each sensor's records in time order
+     * @param count Number of records
+     * @param threads Worker threads, 0 for one per hardware thread
+     */
+    void build(const FrameRecord* records, size_t count, unsigned int threads = 0);
+
+    /**
+     * @brief Reads a log file of raw FrameRecords and builds the index from it
+     * @param path Log file
+     * @param threads Worker threads, 0 for one per hardware thread
+     * @return False if the file cannot be read or is not a whole number of records
+     */
+    bool load(const char* path, unsigned int threads = 0);
+
+    /**
+     * @brief Number of sensor slots, the highest sensor index in the log plus one
+     */
+    size_t sensors() const;
+
+    /**
+     * @brief A sensor's occupied intervals, sorted and disjoint (empty for unknown sensors)
+     */
+    const std::vector<Interval>& intervals(size_t sensor) const;
+
+    /**
+     * @brief Total time a sensor was occupied within [t1, t2)
+     * @return Occupied time in us
+     */
+    uint64_t occupiedTime(size_t sensor, uint64_t t1, uint64_t t2) const;
+
+    /**
+     * @brief Finds when a sensor was first occupied at or after t
+     * @param sensor Sensor index
+     * @param t Time to search from
+     * @param at Gets the time, t itself if the sensor was occupied then
+     * @return False if it never was
+     */
+    bool firstPresence(size_t sensor, uint64_t t, uint64_t& at) const;
+
+private:
+    struct Sensor {
+        std::vector<Interval> intervals;
+        std::vector<uint64_t> occupied;     //occupied[i]: total length of the first i intervals
+    };
+
+    std::vector<Sensor> index;
+
+    /**
+     * @brief Occupied time of a sensor before t
+     */
+    static uint64_t occupiedBefore(const Sensor& sensor, uint64_t t);
+
+    /**
+     * @brief Builds one sensor's intervals from its records
+     */
+    static void buildSensor(Sensor& sensor, std::vector<const FrameRecord*>& records);
+};
+
+#endif //LD2412_OCCUPANCY_INDEX_H
@@ -11,8 +11,42 @@
 LD2412::LD2412(Stream& ld_serial) : serial(ld_serial) {
 }
 
+namespace {
+    //Total ACK length per command word
+    uint8_t ackLength(uint8_t word) {
+        switch (word) {
+            case 0xFF: return 18;
+            case 0x12: return 19;
+            case 0x13:
+            case 0x14: return 28;
+            case 0xA0: return 22;
+            case 0x1B: return 16;
+            default:   return 14;
+        }
+    }
+
+    bool isRead(uint8_t word) {
+        return word == 0x12 || word == 0x13 || word == 0x14 || word == 0x1B || word == 0xA0;
+    }
+
+    //Total report frame length from its data length field: basic or engineering frame, else 0
+    int frameSize(uint8_t low, uint8_t high) {
+        if (high != 0x00 || low != 0x0B && low != 0x28)
+            return 0;
+        return low + 10;
+    }
+
+    const uint8_t REPORT_FOOTER[4] = {0xF8, 0xF7, 0xF6, 0xF5};
+}
+
 /*-----MISC Functions-----*/
 void LD2412::sendCommand(uint8_t* data, uint8_t len) {
+    //A queued command already on the wire goes first, the line carries one exchange at a time
+    while (pumpCommand())
+        delay(1);
+    //An ACK which came in after its command gave up would be taken for this command's
+    while (this->serial.available())
+        this->serial.read();
     this->data_len[0] = len;
 
     this->serial.write(FRAME_HEADER, 4);
@@ -20,6 +54,7 @@ void LD2412::sendCommand(uint8_t* data, uint8_t len) {
     this->serial.write(data, this->data_len[0]);
     this->serial.write(FRAME_FOOTER, 4);
 
+    //The ACK wait starts once the command is out, at 9600 baud a long one takes over 20 ms
     this->serial.flush();
 }
 
@@ -27,6 +62,18 @@ uint8_t* LD2412::getAck(uint8_t respData, uint8_t len) {
     unsigned long time = CURRENT_TIME_MS;
     int i = 0;
     delay(20);
+    //At low baud rates the ACK can still be arriving: wait while bytes keep coming in. A silent
+    //module or a short (failure) ACK ends the wait right away
+    int seen = this->serial.available();
+    unsigned long lastByte = CURRENT_TIME_MS;
+    while (seen > 0 && seen < len && elapsedMs(lastByte) < ACK_GAP && elapsedMs(time) <= ACK_TIMEOUT) {
+        delay(1);
+        int now = this->serial.available();
+        if (now != seen) {
+            seen = now;
+            lastByte = CURRENT_TIME_MS;
+        }
+    }
 
     while (this->serial.available() && i < len) {
         for (i=0; i<len; i++) {
@@ -40,22 +87,42 @@ uint8_t* LD2412::getAck(uint8_t respData, uint8_t len) {
                 i=-1;
 
             //Ack timeout
-            if (CURRENT_TIME_MS - time > ACK_TIMEOUT)
+            if (elapsedMs(time) > ACK_TIMEOUT) {
+                this->stats.ackTimeouts++;
                 return nullptr;
+            }
         }
     }
 
-    if (i >= len) {
-        for (i=0; i<len; i++)
-            if (i<4 && this->buffer[i] != FRAME_HEADER[i]                       //Verifies header
-                || i==4 && this->buffer[i] != len-10                            //Verifies expected length
-                || i==5 && this->buffer[i] != 0x00                              //Verifies spacing (0x00)
-                || i==6 && this->buffer[i] != respData                          //Verifies command word for ack
-                || i==7 && this->buffer[i] != 0x01                              //Verifies response acknowledgement (0x01)
-                || i>=len-4 && this->buffer[i] != FRAME_FOOTER[i-(len-4)])      //Verifies footer
-                return nullptr;
+    //Nothing arrived, the buffer still holds an earlier response
+    if (i < len) {
+        this->stats.ackTimeouts++;
+        return nullptr;
     }
-    return this->buffer;
+    return checkAck(respData, len, time) ? this->buffer : nullptr;
+}
+
+bool LD2412::checkAck(uint8_t respData, uint8_t len, unsigned long since) {
+    for (int i=0; i<len; i++)
+        if (i<4 && this->buffer[i] != FRAME_HEADER[i]                       //Verifies header
+            || i==4 && this->buffer[i] != len-10                            //Verifies expected length
+            || i==5 && this->buffer[i] != 0x00                              //Verifies spacing (0x00)
+            || i==6 && this->buffer[i] != respData                          //Verifies command word for ack
+            || i==7 && this->buffer[i] != 0x01                              //Verifies response acknowledgement (0x01)
+            || i>=len-4 && this->buffer[i] != FRAME_FOOTER[i-(len-4)]) {    //Verifies footer
+            this->stats.ackErrors++;
+            return false;
+        }
+    this->stats.countAck(elapsedMs(since));
+    return true;
+}
+
+uint8_t* LD2412::command(uint8_t* data, uint8_t len, uint8_t ackLen) {
+    sendCommand(data, len);
+
+    if (uint8_t* ack = getAck(data[0], ackLen); ack != nullptr && ack[8] == 0x00)
+        return ack;
+    return nullptr;
 }
 
 bool LD2412::enableConfig() {
@@ -70,6 +137,7 @@ bool LD2412::enableConfig() {
 bool LD2412::disableConfig() {
     uint8_t data[] = {0xFE, 0x00};
     sendCommand(data, std::size(data));
+    this->txSession = false;
 
     if (const uint8_t* ack = getAck(data[0], 14); ack != nullptr && ack[8] == 0x00)
         return true;
@@ -77,40 +145,224 @@ bool LD2412::disableConfig() {
 }
 
 bool LD2412::readSerial() {
-    //If serial was already successfully read within the past threshold, this function is skipped
-    if (this->serialLastRead != NULL && CURRENT_TIME_MS - this->serialLastRead < this->refresh_threshold)
+    //If serial was already successfully read within the past threshold, this function is skipped.
+    //Not while waiting for the first frame, which should be picked up as soon as it lands
+    if (this->ready && this->serialReadOnce && elapsedMs(this->serialLastRead) < this->refresh_threshold)
         return true;
+    //Queued commands own the line until their session closes, the bytes waiting are ACKs
+    if (this->txLen != 0 || this->txSession)
+        return this->ready;
+    if (this->lazy_decode)
+        return readSerialLazy();
 
     int i = 0;
-    long int timeRef = CURRENT_TIME_MS;
-    while (this->serial.available() && i < 21) {
-        for (i=0; i<21; i++) {
+    int frameLen = BASIC_FRAME_SIZE;
+    bool skipped = false;
+    unsigned long timeRef = CURRENT_TIME_MS;
+    while (this->serial.available() && i < frameLen) {
+        for (i=0; i<frameLen; i++) {
             this->buffer[i] = this->serial.read();
 
             //Ensures packet capture is properly aligned at header
             if (this->buffer[0] != 0xF4
                 || i>0 && this->buffer[1] != 0xF3
                 || i>1 && this->buffer[2] != 0xF2
-                || i>2 && this->buffer[3] != 0xF1)
+                || i>2 && this->buffer[3] != 0xF1) {
                 i=-1;
+                frameLen = BASIC_FRAME_SIZE;
+                skipped = true;
+            }
+
+            //Data length tells a basic frame from an engineering one
+            else if (i == 5 && (frameLen = frameSize(this->buffer[4], this->buffer[5])) == 0) {
+                this->stats.frameErrors++;
+                return false;
+            }
 
             //Ensures the packet was completely and properly captured by verifying footer
-            if (i>16 && this->buffer[17] != 0xF8
-                || i>17 && this->buffer[18] != 0xF7
-                || i>18 && this->buffer[19] != 0xF6
-                || i>19 && this->buffer[20] != 0xF5)
+            if (i >= frameLen-4 && this->buffer[i] != REPORT_FOOTER[i-(frameLen-4)]) {
+                this->stats.frameErrors++;
+                return false;
+            }
+
+            else if (elapsedMs(timeRef) > ACK_TIMEOUT)
                 return false;
+        }
+    }
+    this->serialLastRead = CURRENT_TIME_MS;
+    this->serialReadOnce = true;
+    if (skipped)
+        this->stats.resyncs++;
+    //Nothing was waiting, the retained frame stays current (there is none before the first frame)
+    if (i < frameLen)
+        return this->ready;
+
+    for (i=0; i<frameLen; i++)
+        this->serialBuffer[this->serialFrame][i] = this->buffer[i];
+    this->serialFrameTime = this->serialLastRead;
+    this->stats.countFrame(this->serialFrameTime);
+    markReady();
+    return true;
+}
+
+bool LD2412::readSerialLazy() {
+    if (!this->serial.available()) {
+        this->serialLastRead = CURRENT_TIME_MS;
+        this->serialReadOnce = true;
+        return this->ready;
+    }
+
+    uint8_t* frame = this->serialBuffer[this->serialFrame ^ 1];
+    bool skipped = false;
+    unsigned long timeRef = CURRENT_TIME_MS;
 
-            else if (CURRENT_TIME_MS - timeRef > ACK_TIMEOUT)
+    //Aligns on the header (F4 F3 F2 F1), time is only checked while hunting for it
+    for (int i=0; i<4;) {
+        int c = this->serial.read();
+        if (c == 0xF4 - i) {
+            frame[i++] = c;
+        }
+        else {
+            i = c == 0xF4 ? 1 : 0;
+            skipped = true;
+            if (elapsedMs(timeRef) > ACK_TIMEOUT)
                 return false;
         }
     }
+    if (skipped)
+        this->stats.resyncs++;
+    frame[4] = this->serial.read();
+    frame[5] = this->serial.read();
+    int frameLen = frameSize(frame[4], frame[5]);
+    for (int i=6; i<frameLen; i++)
+        frame[i] = this->serial.read();
+
+    if (frameLen == 0 || frame[frameLen-4] != 0xF8 || frame[frameLen-3] != 0xF7
+        || frame[frameLen-2] != 0xF6 || frame[frameLen-1] != 0xF5) {
+        this->stats.frameErrors++;
+        return false;
+    }
+
+    this->serialFrame ^= 1;
+    this->serialState = frame[8];
     this->serialLastRead = CURRENT_TIME_MS;
-    for (i=0; i<21; i++)
-        this->serialBuffer[i] = this->buffer[i];
+    this->serialReadOnce = true;
+    this->serialFrameTime = this->serialLastRead;
+    this->stats.countFrame(this->serialFrameTime);
+    markReady();
     return true;
 }
 
+void LD2412::markReady() {
+    if (this->ready)
+        return;
+    this->ready = true;
+    this->startupLatency = elapsedMs(this->startupBegin, this->serialFrameTime);
+    if (this->readyCallback != nullptr)
+        this->readyCallback(this->startupLatency);
+}
+
+void LD2412::loadCommand(const uint8_t* data, uint8_t len, bool head) {
+    for (int i=0; i<4; i++) {
+        this->txFrame[i] = FRAME_HEADER[i];
+        this->txFrame[len+6+i] = FRAME_FOOTER[i];
+    }
+    this->txFrame[4] = len;
+    this->txFrame[5] = 0x00;
+    for (int i=0; i<len; i++)
+        this->txFrame[6+i] = data[i];
+    this->txLen = len + 10;
+    this->txSent = 0;
+    this->txAckPos = 0;
+    this->txHead = head;
+    this->txTime = CURRENT_TIME_MS;
+}
+
+bool LD2412::pumpCommand() {
+    if (this->txLen == 0)
+        return false;
+
+    if (this->txSent < this->txLen) {
+        int space = this->serial.availableForWrite();
+        //Streams which never report TX space (Print's default) get the frame written whole once it stalls
+        if (space <= 0 && elapsedMs(this->txTime) >= TX_STALL)
+            space = this->txLen;
+        if (space > 0) {
+            uint8_t n = this->txLen - this->txSent;
+            if (space < n)
+                n = space;
+            this->serial.write(this->txFrame + this->txSent, n);
+            this->txSent += n;
+            this->txTime = CURRENT_TIME_MS;
+        }
+        if (this->txSent < this->txLen)
+            return true;
+    }
+
+    //Collects the ACK as it arrives, anything ahead of its header is skipped
+    uint8_t word = this->txFrame[6];
+    uint8_t len = ackLength(word);
+    while (this->txAckPos < len && this->serial.available()) {
+        uint8_t c = this->serial.read();
+        if (this->txAckPos < 4 && c != FRAME_HEADER[this->txAckPos])
+            this->txAckPos = 0;
+        if (this->txAckPos < 4 && c != FRAME_HEADER[this->txAckPos])
+            continue;
+        this->buffer[this->txAckPos++] = c;
+    }
+
+    if (this->txAckPos == len) {
+        finishCommand(checkAck(word, len, this->txTime) ? this->buffer : nullptr);
+    }
+    else if (elapsedMs(this->txTime) > ACK_TIMEOUT) {
+        this->stats.ackTimeouts++;
+        finishCommand(nullptr);
+    }
+    return this->txLen != 0;
+}
+
+void LD2412::finishCommand(const uint8_t* ack) {
+    uint8_t word = this->txFrame[6];
+    bool success = ack != nullptr && ack[8] == 0x00;
+    this->txLen = 0;
+
+    if (word == 0xFF)
+        this->txSession = success;
+    //Leaving config mode ends the session whatever the ACK says
+    else if (word == 0xFE)
+        this->txSession = false;
+    //The module only reboots once the session ends, which it does right away
+    bool restarted = word == 0xA3 && success;
+    if (restarted)
+        beginStartup();
+
+    if (!this->txHead) {
+        if (word != 0xFF || success) {
+            this->txRetried = false;
+            return;
+        }
+        //Opening the session is retried once, then the command it was for fails
+        if (!this->txRetried) {
+            this->txRetried = true;
+            return;
+        }
+        this->txRetried = false;
+        word = this->txQueue[0].data[0];
+    }
+
+    CommandCallback onDone = this->txQueue[0].onDone;
+    for (uint8_t i=1; i<this->txCount; i++)
+        this->txQueue[i-1] = this->txQueue[i];
+    this->txCount--;
+    const uint8_t* result = this->txHead && success ? ack : nullptr;
+    if (restarted) {
+        uint8_t disable[] = {0xFE, 0x00};
+        loadCommand(disable, std::size(disable), false);
+    }
+    if (onDone != nullptr)
+        onDone(word, result);
+}
+
 bool LD2412::enterCalibrationMode() {
     uint8_t data[] = {0x0B, 0x00};
     bool success = false;
@@ -143,6 +395,67 @@ int LD2412::checkCalibrationMode() {
     return -1;
 }
 
+bool LD2412::startCalibration(CalibrationCallback onComplete) {
+    if (this->calibrationActive || !enterCalibrationMode())
+        return false;
+
+    this->calibrationCallback = onComplete;
+    this->calibrationActive = true;
+    this->calibrationFailures = 0;
+    this->calibrationSeen = false;
+    this->calibrationStart = CURRENT_TIME_MS;
+    //First poll lands just after the module's own start delay
+    this->calibrationLastPoll = this->calibrationStart;
+    this->calibrationInterval = CALIBRATION_DELAY + CALIBRATION_POLL_MIN;
+    return true;
+}
+
+bool LD2412::updateCalibration() {
+    if (!this->calibrationActive)
+        return false;
+
+    if (elapsedMs(this->calibrationLastPoll) < this->calibrationInterval)
+        return true;
+
+    int status = checkCalibrationMode();
+    this->calibrationLastPoll = CURRENT_TIME_MS;
+
+    bool done = false;
+    bool success = false;
+    if (status > 0)
+        this->calibrationSeen = true;
+    //Not running yet is no success, the module may start late
+    if (status == 0 && this->calibrationSeen) {
+        done = success = true;
+    }
+    else if (status < 0 && ++this->calibrationFailures >= CALIBRATION_MAX_FAILURES) {
+        done = true;
+    }
+    else if (elapsedMs(this->calibrationStart, this->calibrationLastPoll) > CALIBRATION_TIMEOUT) {
+        done = true;
+    }
+    else {
+        if (status >= 0)
+            this->calibrationFailures = 0;
+        //Back-off starts after the first poll past the start delay
+        if (this->calibrationInterval > CALIBRATION_DELAY)
+            this->calibrationInterval = CALIBRATION_POLL_MIN;
+        else if ((this->calibrationInterval *= 2) > CALIBRATION_POLL_MAX)
+            this->calibrationInterval = CALIBRATION_POLL_MAX;
+    }
+
+    if (!done)
+        return true;
+    this->calibrationActive = false;
+    if (this->calibrationCallback != nullptr)
+        this->calibrationCallback(success);
+    return false;
+}
+
+bool LD2412::calibrationRunning() {
+    return this->calibrationActive;
+}
+
 int* LD2412::readFirmwareVersion() {
     uint8_t data[] = {0xA0, 0x00};
 
@@ -177,6 +490,38 @@ bool LD2412::resetDeviceSettings() {
     return success;
 }
 
+bool LD2412::enableEngineeringMode() {
+    uint8_t data[] = {0x62, 0x00};
+    bool success = false;
+
+    if (!enableConfig())
+        if (!enableConfig())
+            return false;
+    sendCommand(data, std::size(data));
+
+    if (const uint8_t* ack = getAck(data[0], 14); ack != nullptr && ack[8] == 0x00)
+        success = this->engineering = true;
+    disableConfig();
+    return success;
+}
+
+bool LD2412::disableEngineeringMode() {
+    uint8_t data[] = {0x63, 0x00};
+    bool success = false;
+
+    if (!enableConfig())
+        if (!enableConfig())
+            return false;
+    sendCommand(data, std::size(data));
+
+    if (const uint8_t* ack = getAck(data[0], 14); ack != nullptr && ack[8] == 0x00) {
+        success = true;
+        this->engineering = false;
+    }
+    disableConfig();
+    return success;
+}
+
 bool LD2412::restartModule() {
     uint8_t data[] = {0xA3, 0x00};
     bool success = false;
@@ -186,12 +531,172 @@ bool LD2412::restartModule() {
             return false;
     sendCommand(data, std::size(data));
 
-    if (const uint8_t* ack = getAck(data[0], 14); ack != nullptr && ack[8] == 0x00)
+    if (const uint8_t* ack = getAck(data[0], 14); ack != nullptr && ack[8] == 0x00) {
         success = true;
+        beginStartup();
+    }
     disableConfig();
     return success;
 }
 
+void LD2412::beginStartup() {
+    //The module boots in basic mode
+    this->engineering = false;
+    this->ready = false;
+    this->startupBegin = CURRENT_TIME_MS;
+    this->startupLatency = -1;
+}
+
+bool LD2412::isReady() {
+    if (this->ready)
+        return true;
+    //Boot output before the first header is dropped by frameWaiting()
+    if (frameWaiting())
+        readSerial();
+    return this->ready;
+}
+
+bool LD2412::frameWaiting() {
+    while (this->serial.available() && this->serial.peek() != 0xF4)
+        this->serial.read();
+    return this->serial.available() >= (this->engineering ? ENGINEERING_FRAME_SIZE : BASIC_FRAME_SIZE);
+}
+
+bool LD2412::awaitReady(unsigned long timeout) {
+    unsigned long start = CURRENT_TIME_MS;
+    while (!isReady()) {
+        if (elapsedMs(start) >= timeout)
+            return false;
+        delay(1);
+    }
+    return true;
+}
+
+int LD2412::ensureConfig(const LD2412Config& config, LD2412ConfigStore& store) {
+    uint8_t firmware[] = {0xA0, 0x00};
+    uint8_t params[] = {0x12, 0x00};
+    uint32_t stored = 0;
+    bool known = store.load(stored);
+
+    if (!enableConfig())
+        if (!enableConfig())
+            return -1;
+
+    //Cheap check: firmware version and basic parameters
+    const uint8_t* ack = command(firmware, std::size(firmware), 22);
+    if (ack == nullptr) {
+        disableConfig();
+        return -1;
+    }
+    this->firmwareResponse[0] = ack[10] + (ack[11] << 8);
+    this->firmwareResponse[1] = ack[12] + (ack[13] << 8);
+    this->firmwareResponse[2] = ack[14] + (ack[15] << 8) + (ack[16] << 16) + (ack[17] << 24);
+    uint32_t fingerprint = config.fingerprint(this->firmwareResponse);
+
+    ack = command(params, std::size(params), 19);
+    if (ack != nullptr && known && stored == fingerprint
+        && ack[10] == config.minGate && ack[11] == config.maxGate
+        && ack[12] == config.duration && ack[14] == config.outPinPolarity) {
+        disableConfig();
+        return 0;
+    }
+
+    //Full apply and read back, still in the same session
+    uint8_t data[16] = {0x02, 0x00, config.minGate, config.maxGate, config.duration, 0x00, config.outPinPolarity};
+    bool success = command(data, 7, 14) != nullptr;
+    for (uint8_t word = 0x03; success && word <= 0x04; word++) {
+        const uint8_t* sen = word == 0x03 ? config.motionSensitivity : config.staticSensitivity;
+        //An unset array would make every gate trigger on anything, the module keeps its own
+        bool set = false;
+        for (int i=0; i<14; i++)
+            set |= sen[i] != 0;
+        if (!set)
+            continue;
+        data[0] = word;
+        for (int i=2; i<16; i++)
+            data[i] = sen[i-2];
+        success = command(data, 16, 14) != nullptr;
+
+        uint8_t query[] = {static_cast<uint8_t>(word + 0x10), 0x00};
+        ack = success ? command(query, std::size(query), 28) : nullptr;
+        for (int i=0; ack != nullptr && i<14; i++)
+            if (ack[10+i] != sen[i])
+                ack = nullptr;
+        success = ack != nullptr;
+    }
+    ack = success ? command(params, std::size(params), 19) : nullptr;
+    success = ack != nullptr && ack[10] == config.minGate && ack[11] == config.maxGate
+        && ack[12] == config.duration && ack[14] == config.outPinPolarity;
+    disableConfig();
+
+    if (!success)
+        return -1;
+    store.save(fingerprint);
+    return 1;
+}
+
+bool LD2412::queueCommand(const uint8_t* data, uint8_t len, CommandCallback onDone, bool recovery) {
+    if (len < 2 || len > TX_DATA_SIZE)
+        return false;
+    //The command on the wire keeps its place at the front until it completes
+    uint8_t first = this->txLen != 0 && this->txHead ? 1 : 0;
+
+    if (isRead(data[0]))
+        for (uint8_t i=first; i<this->txCount; i++)
+            if (this->txQueue[i].len == len && this->txQueue[i].onDone == onDone
+                && memcmp(this->txQueue[i].data, data, len) == 0)
+                return true;
+
+    TxEntry evicted = {};
+    if (this->txCount == TX_SLOTS) {
+        if (!recovery || this->txQueue[TX_SLOTS-1].recovery)
+            return false;
+        evicted = this->txQueue[--this->txCount];
+    }
+
+    uint8_t pos = this->txCount;
+    if (recovery)
+        for (pos=first; pos<this->txCount && this->txQueue[pos].recovery; pos++);
+    for (uint8_t i=this->txCount; i>pos; i--)
+        this->txQueue[i] = this->txQueue[i-1];
+    TxEntry& entry = this->txQueue[pos];
+    memcpy(entry.data, data, len);
+    entry.len = len;
+    entry.recovery = recovery;
+    entry.onDone = onDone;
+    this->txCount++;
+
+    if (evicted.onDone != nullptr)
+        evicted.onDone(evicted.data[0], nullptr);
+    return true;
+}
+
+bool LD2412::updateCommands() {
+    if (this->txLen == 0) {
+        if (this->txCount > 0) {
+            const TxEntry& next = this->txQueue[0];
+            //Everything but entering and leaving config mode needs a session, opened on demand
+            if (!this->txSession && next.data[0] != 0xFF && next.data[0] != 0xFE) {
+                uint8_t enable[] = {0xFF, 0x00, 0x01, 0x00};
+                loadCommand(enable, std::size(enable), false);
+            }
+            else {
+                loadCommand(next.data, next.len, true);
+            }
+        }
+        //Queue drained, reports resume
+        else if (this->txSession) {
+            uint8_t disable[] = {0xFE, 0x00};
+            loadCommand(disable, std::size(disable), false);
+        }
+        else {
+            return false;
+        }
+    }
+    pumpCommand();
+    return this->txLen != 0 || this->txCount > 0 || this->txSession;
+}
+
 /*-----SET Functions-----*/
 bool LD2412::setParamConfig(uint8_t min, uint8_t max, uint8_t duration, uint8_t outPinPolarity) {
     uint8_t data[] = {0x02, 0x00, min, max, duration, 0x00, outPinPolarity};
@@ -208,6 +713,23 @@ bool LD2412::setParamConfig(uint8_t min, uint8_t max, uint8_t duration, uint8_t
     return success;
 }
 
+bool LD2412::setUnmannedDuration(uint8_t duration) {
+    uint8_t params[] = {0x12, 0x00};
+
+    if (!enableConfig())
+        if (!enableConfig())
+            return false;
+
+    const uint8_t* ack = command(params, std::size(params), 19);
+    bool success = ack != nullptr;
+    if (success && ack[12] != duration) {
+        uint8_t data[] = {0x02, 0x00, ack[10], ack[11], duration, 0x00, ack[14]};
+        success = command(data, std::size(data), 14) != nullptr;
+    }
+    disableConfig();
+    return success;
+}
+
 bool LD2412::setMotionSensitivity(uint8_t sen) {
     uint8_t data[16] = {0x03, 0x00};
     for (int i=2; i<16; i++)
@@ -321,6 +843,16 @@ void LD2412::setSerialRefreshThres(unsigned int refreshTime) {
     this->refresh_threshold = refreshTime;
 }
 
+void LD2412::setLazyDecode(bool lazy) {
+    //The retained frame stays valid across the switch, only the state byte needs seeding
+    this->serialState = this->serialBuffer[this->serialFrame][8];
+    this->lazy_decode = lazy;
+}
+
+void LD2412::setReadyCallback(ReadyCallback onReady) {
+    this->readyCallback = onReady;
+}
+
 /*-----GET Functions-----*/
 int* LD2412::getParamConfig() {
     uint8_t data[] = {0x12, 0x00};
@@ -418,33 +950,78 @@ unsigned int LD2412::getSerialRefreshThres() {
     return this->refresh_threshold;
 }
 
+bool LD2412::getLazyDecode() {
+    return this->lazy_decode;
+}
+
+const LD2412Stats& LD2412::getStats() {
+    return this->stats;
+}
+
+long LD2412::getStartupLatency() {
+    return this->startupLatency;
+}
+
 /*-----READ DATA Functions-----*/
 int LD2412::targetState() {
     if (!readSerial())
         return -1;
-    return this->serialBuffer[8];
+    if (this->lazy_decode)
+        return this->serialState;
+    return this->serialBuffer[this->serialFrame][8];
+}
+
+bool LD2412::readFrame(LD2412Frame& frame) {
+    if (!readSerial())
+        return false;
+    const uint8_t* data = this->serialBuffer[this->serialFrame];
+    frame.state = data[8];
+    frame.movingDistance = data[9] + (data[10] << 8);
+    frame.movingEnergy = data[11];
+    frame.staticDistance = data[12] + (data[13] << 8);
+    frame.staticEnergy = data[14];
+    frame.timestamp = this->serialFrameTime;
+    return true;
+}
+
+bool LD2412::readGateEnergies(LD2412GateEnergies& energies) {
+    if (!readSerial())
+        return false;
+    //Engineering frame: basic target data, then [15-28] moving and [29-42] static gate energies, [43] light
+    const uint8_t* data = this->serialBuffer[this->serialFrame];
+    if (data[6] != 0x01)
+        return false;
+    for (unsigned int i=0; i<LD2412GateEnergies::GATES; i++) {
+        energies.moving[i] = data[15+i];
+        energies.stationary[i] = data[29+i];
+    }
+    energies.light = data[43];
+    energies.timestamp = this->serialFrameTime;
+    return true;
 }
 
 int LD2412::movingDistance() {
     if (!readSerial())
         return -1;
-    return this->serialBuffer[9] + (this->serialBuffer[10] << 8);
+    const uint8_t* frame = this->serialBuffer[this->serialFrame];
+    return frame[9] + (frame[10] << 8);
 }
 
 int LD2412::movingEnergy() {
     if (!readSerial())
         return -1;
-    return this->serialBuffer[11];
+    return this->serialBuffer[this->serialFrame][11];
 }
 
 int LD2412::staticDistance() {
     if (!readSerial())
         return -1;
-    return this->serialBuffer[12] + (this->serialBuffer[13] << 8);
+    const uint8_t* frame = this->serialBuffer[this->serialFrame];
+    return frame[12] + (frame[13] << 8);
 }
 
 int LD2412::staticEnergy() {
     if (!readSerial())
         return -1;
-    return this->serialBuffer[14];
+    return this->serialBuffer[this->serialFrame][14];
 }
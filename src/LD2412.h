@@ -11,6 +11,9 @@
 
 #include <Arduino.h>
 #include <type_traits>
+#include "LD2412Frame.h"
+#include "LD2412Config.h"
+#include "LD2412Stats.h"
 
 #define CURRENT_TIME_MS millis()
 #define RETURN_ARRAY (std::true_type{})
@@ -18,6 +21,25 @@
 class LD2412 {
 
 public:
+    /**
+     * @brief Called when a calibration job finishes
+     * @param success True if calibration completed, false if it failed or timed out
+     */
+    typedef void (*CalibrationCallback)(bool success);
+
+    /**
+     * @brief Called when the first report frame arrives after a power-up or restart
+     * @param latencyMs Time from the start of the startup to that frame
+     */
+    typedef void (*ReadyCallback)(unsigned long latencyMs);
+
+    /**
+     * @brief Called when a queued command completes
+     * @param word Command word
+     * @param ack Response frame (status at [8], data from [10]), nullptr if the command failed
+     */
+    typedef void (*CommandCallback)(uint8_t word, const uint8_t* ack);
+
     /**
      * @brief Constructor which uses the passed-in Serial for the object
      * @param ld_serial HardwareSerial or SoftwareSerial object reference
@@ -30,10 +52,16 @@ private:
     Stream& serial;
 
     //Determines when a response takes too long
-    const int ACK_TIMEOUT = 200;
+    static constexpr uint32_t ACK_TIMEOUT = 200;
+    static constexpr uint32_t ACK_GAP = 5;          //An ACK still arriving after the first 20 ms is waited for until the line is quiet this long
+
+    //Milliseconds from a CURRENT_TIME_MS reading to another (default: now), as a 32-bit difference so it stays right across the millis() rollover
+    static uint32_t elapsedMs(unsigned long since, unsigned long until = CURRENT_TIME_MS) {
+        return static_cast<uint32_t>(until - since);
+    }
 
     //Buffer used in various functions
-    static constexpr unsigned int BUFFER_SIZE = 32;
+    static constexpr unsigned int BUFFER_SIZE = 64;
     uint8_t buffer[BUFFER_SIZE];
 
     //Arrays for array responses
@@ -43,9 +71,61 @@ private:
 
     //For use by readSerial()
     unsigned int refresh_threshold = 5;             //Forces serial to be read if 5 ms have passed since last reading
-    unsigned long serialLastRead = NULL;            //Latest time serial was read
-    static constexpr int serialBuffer_SIZE = 21;
-    uint8_t serialBuffer[serialBuffer_SIZE];
+    unsigned long serialLastRead = 0;               //Latest time serial was read
+    bool serialReadOnce = false;                    //Whether serialLastRead holds a reading yet
+    static constexpr int BASIC_FRAME_SIZE = 21;
+    static constexpr int ENGINEERING_FRAME_SIZE = 50;
+    static constexpr int serialBuffer_SIZE = ENGINEERING_FRAME_SIZE;
+    uint8_t serialBuffer[2][serialBuffer_SIZE];     //Retained frame and the one being captured
+    uint8_t serialFrame = 0;                        //Index of the retained frame
+    bool lazy_decode = false;                       //Light validation, fields decoded on request
+    uint8_t serialState = 0;                        //State byte of the retained frame (lazy mode)
+    unsigned long serialFrameTime = 0;              //Time the retained frame was captured
+    bool engineering = false;                       //Whether engineering mode was enabled through this object
+
+    //For use by the calibration job
+    static constexpr unsigned long CALIBRATION_DELAY = 10000;       //Module starts calibrating 10 s after the command
+    static constexpr unsigned long CALIBRATION_POLL_MIN = 1000;     //First status poll interval, doubled per poll
+    static constexpr unsigned long CALIBRATION_POLL_MAX = 16000;
+    static constexpr unsigned long CALIBRATION_TIMEOUT = 300000;
+    static constexpr uint8_t CALIBRATION_MAX_FAILURES = 3;          //Consecutive failed polls before giving up
+    CalibrationCallback calibrationCallback = nullptr;
+    bool calibrationActive = false;
+    unsigned long calibrationStart = 0;
+    unsigned long calibrationLastPoll = 0;
+    unsigned long calibrationInterval = 0;
+    uint8_t calibrationFailures = 0;
+    bool calibrationSeen = false;                   //Whether a poll found calibration running
+
+    //For use by the ready state. Startup is timed from 0 (MCU power-up) until restartModule() or beginStartup()
+    ReadyCallback readyCallback = nullptr;
+    bool ready = false;                             //Whether a frame arrived since the startup began
+    unsigned long startupBegin = 0;
+    long startupLatency = -1;                       //Startup to first frame (ms), -1 until ready
+
+    //For use by the command queue
+    static constexpr uint8_t TX_SLOTS = 4;
+    static constexpr uint8_t TX_DATA_SIZE = 16;                 //Largest command: per-gate sensitivity
+    static constexpr unsigned long TX_STALL = 10;               //Frame is written whole if the stream reports no space this long
+    struct TxEntry {
+        uint8_t data[TX_DATA_SIZE];
+        uint8_t len;
+        bool recovery;
+        CommandCallback onDone;
+    };
+    TxEntry txQueue[TX_SLOTS];                      //Queued commands, recovery ones first
+    uint8_t txCount = 0;
+    uint8_t txFrame[TX_DATA_SIZE + 10];             //Frame on the wire
+    uint8_t txLen = 0;                              //Its length, 0 when no frame is in flight
+    uint8_t txSent = 0;                             //Bytes of it written so far
+    uint8_t txAckPos = 0;                           //Bytes of its ACK captured so far
+    bool txHead = false;                            //Whether it carries txQueue[0] rather than a session command
+    bool txSession = false;                         //Config session opened by the queue
+    bool txRetried = false;                         //Whether opening the session was already retried
+    unsigned long txTime = 0;                       //Time of the last write
+
+    //Link health counters
+    LD2412Stats stats;
 
     //Frame structure
     const uint8_t FRAME_HEADER[4] = {0xFD, 0xFC, 0xFB, 0xFA};
@@ -68,6 +148,24 @@ private:
      */
     uint8_t* getAck(uint8_t respData, uint8_t len);
 
+    /**
+     * @brief Verifies an ACK captured in the buffer and counts it
+     * @param respData Response data (command word byte)
+     * @param len Total length of expected response
+     * @param since Time the command went out
+     * @return Whether the ACK is well-formed
+     */
+    bool checkAck(uint8_t respData, uint8_t len, unsigned long since);
+
+    /**
+     * @brief Sends a command inside an open configuration session and checks its ACK status
+     * @param data The data (command word and command value)
+     * @param len Total length of data
+     * @param ackLen Total length of expected response
+     * @return Array ptr of the response or nullptr if failed
+     */
+    uint8_t* command(uint8_t* data, uint8_t len, uint8_t ackLen);
+
     /**
      * @brief Enables configuration mode
      * @return Success status
@@ -86,6 +184,39 @@ private:
      */
     bool readSerial();
 
+    /**
+     * @brief readSerial() for lazy decode mode: aligns on the header, checks the footer
+     * and captures straight into the spare frame buffer instead of copying
+     * @return Success status
+     */
+    bool readSerialLazy();
+
+    /**
+     * @brief Records the first frame of a startup and notifies the ready callback
+     */
+    void markReady();
+
+    /**
+     * @brief Puts a frame on the wire for the command queue
+     * @param data The data (command word and command value)
+     * @param len Total length of data
+     * @param head Whether it is the command at the front of the queue
+     */
+    void loadCommand(const uint8_t* data, uint8_t len, bool head);
+
+    /**
+     * @brief Advances the frame in flight: writes what the stream has room for, then collects
+     * its ACK without blocking
+     * @return True while a frame is in flight
+     */
+    bool pumpCommand();
+
+    /**
+     * @brief Completes the frame in flight and notifies its command's callback
+     * @param ack Response frame or nullptr if failed
+     */
+    void finishCommand(const uint8_t* ack);
+
 public:
     /**
      * Enters calibration mode after 10 seconds from function call
@@ -99,6 +230,29 @@ public:
      */
     int checkCalibrationMode();
 
+    /**
+     * @brief Starts a non-blocking calibration job. Calibration is triggered right away and its
+     * status is then polled from updateCalibration() with a growing interval, each poll being a
+     * single short config session, so the report stream keeps flowing in between.
+     * Calibration counts as finished only once a poll has seen it running and a later one sees it
+     * done; a module which never starts calibrating fails at the timeout.
+     * @param onComplete Called once when calibration finishes or fails (may be nullptr)
+     * @return False if a job is already running or the trigger failed
+     */
+    bool startCalibration(CalibrationCallback onComplete);
+
+    /**
+     * @brief Advances the calibration job, call it from loop(). Only talks to the module when a poll is due
+     * @return True while the job is running
+     */
+    bool updateCalibration();
+
+    /**
+     * @brief Whether a calibration job is running
+     * @return Calibration job status
+     */
+    bool calibrationRunning();
+
     /**
      * @brief Reads firmware version information
      * @return Array pointer: [0] Firmware type, [1] major version number, [2] minor version number
@@ -111,12 +265,76 @@ public:
      */
     bool resetDeviceSettings();
 
+    /**
+     * @brief Enables engineering mode: report frames then carry the energy of every distance gate
+     * @return Success status
+     */
+    bool enableEngineeringMode();
+
+    /**
+     * @brief Disables engineering mode, back to basic report frames
+     * @return Success status
+     */
+    bool disableEngineeringMode();
+
     /**
      * @brief Restarts the module
      * @return Success status
      */
     bool restartModule();
 
+    /**
+     * @brief Starts timing a startup: the module is not ready until its next report frame.
+     * restartModule() calls it, call it when powering the module back up
+     */
+    void beginStartup();
+
+    /**
+     * @brief Whether a report frame arrived since the startup began. Only reads when a
+     * whole frame is waiting, so it is cheap to poll
+     * @return Ready status
+     */
+    bool isReady();
+
+    /**
+     * @brief Waits until the module is ready, checking every millisecond so the first frame
+     * is picked up as soon as its last byte lands
+     * @param timeout Maximum wait in ms
+     * @return True if ready, false if timed out
+     */
+    bool awaitReady(unsigned long timeout);
+
+    /**
+     * @brief Makes sure the module runs a configuration, cheaply when it already does.
+     * One short session reads the firmware version and the basic parameters; if they match and
+     * the store holds this configuration's fingerprint, nothing else is sent. Otherwise the full
+     * configuration is written and read back in one session and its fingerprint stored. Sensitivity
+     * arrays left all 0 are not written, the module keeps its own
+     * @param config Configuration the module should run
+     * @param store Non-volatile storage for the fingerprint
+     * @return 0 if it was already applied, 1 if it was applied now, -1 if failed
+     */
+    int ensureConfig(const LD2412Config& config, LD2412ConfigStore& store);
+
+    /**
+     * @brief Queues a command without blocking; updateCommands() sends it as TX space allows,
+     * inside a config session opened and closed on demand. Recovery commands (e.g. 0xFE end
+     * configuration, 0xA3 restart) go ahead of queued routine ones. A read already queued with
+     * the same callback is not queued again
+     * @param data The data (command word and command value), at most 16 bytes
+     * @param len Total length of data
+     * @param onDone Called with the ACK when the command completes (may be nullptr)
+     * @param recovery Recovery priority
+     * @return False if the queue is full. A recovery command then takes the newest routine one's place
+     */
+    bool queueCommand(const uint8_t* data, uint8_t len, CommandCallback onDone, bool recovery = false);
+
+    /**
+     * @brief Advances the command queue, call it from loop(). Never waits for TX to drain or for an ACK
+     * @return True while commands are queued or in flight
+     */
+    bool updateCommands();
+
     /*-----SET Functions-----*/
     /**
      * @brief Sets basic parameter configuration
@@ -128,6 +346,14 @@ public:
      */
     bool setParamConfig(uint8_t min, uint8_t max, uint8_t duration, uint8_t outPinPolarity);
 
+    /**
+     * @brief Sets only the unmanned duration, keeping the other basic parameters. Reads and
+     * writes them in one configuration session, and sends nothing more if it is already set
+     * @param duration Unmanned duration in seconds
+     * @return Success status
+     */
+    bool setUnmannedDuration(uint8_t duration);
+
     /**
      * @brief Sets the motion sensitivity for all gates.
      * Detections only count as presence when energy is above set sensitivity
@@ -165,6 +391,20 @@ public:
      */
     void setSerialRefreshThres(unsigned int refreshTime);
 
+    /**
+     * @brief Enables lazy decoding of report frames. Frames only get their header and footer
+     * checked and the target state is read on capture; distances and energies are decoded
+     * from the retained frame when requested. Cheapest mode for state-only consumers (default: off)
+     * @param lazy Lazy decode on/off
+     */
+    void setLazyDecode(bool lazy);
+
+    /**
+     * @brief Sets the function called when the module becomes ready (may be nullptr)
+     * @param onReady Ready callback
+     */
+    void setReadyCallback(ReadyCallback onReady);
+
     /*-----GET Functions-----*/
     /**
      * @brief Reads basic parameters of the radar
@@ -199,6 +439,25 @@ public:
      */
     unsigned int getSerialRefreshThres();
 
+    /**
+     * @brief Gets whether lazy decoding of report frames is enabled
+     * @return Lazy decode status
+     */
+    bool getLazyDecode();
+
+    /**
+     * @brief Gets the link health counters: frames, resyncs, bad frames, ACK timeouts and
+     * latency histograms. Updated as a side effect of reads and commands, at no extra I/O
+     * @return Counters reference, valid for the lifetime of the object
+     */
+    const LD2412Stats& getStats();
+
+    /**
+     * @brief Gets the time from the start of the last startup to its first report frame
+     * @return Startup latency (ms), -1 if not ready yet
+     */
+    long getStartupLatency();
+
     /*-----READ DATA Functions-----*/
     /**
      * @brief Gets target status (0 none, 1 moving, 2 stationary, 3 both)
@@ -206,6 +465,28 @@ public:
      */
     int targetState();
 
+    /**
+     * @brief Whether a whole report frame (basic, or engineering once enabled through this object)
+     * is waiting, so a read loop woken by its first bytes does not take it half arrived. Bytes
+     * before the frame header are dropped
+     * @return True if a frame can be read
+     */
+    bool frameWaiting();
+
+    /**
+     * @brief Decodes every field of the latest report frame at once
+     * @param frame Filled with the frame and the time it was captured
+     * @return Success status
+     */
+    bool readFrame(LD2412Frame& frame);
+
+    /**
+     * @brief Gets the per-gate energies of the latest report frame
+     * @param energies Filled with the energies and the time the frame was captured
+     * @return False if failed or the frame is not an engineering-mode frame
+     */
+    bool readGateEnergies(LD2412GateEnergies& energies);
+
     /**
      * @brief Gets moving target distance
      * @return Moving target distance (cm), -1 if failed
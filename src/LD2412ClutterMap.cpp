@@ -0,0 +1,87 @@
+/**
+ * @file LD2412ClutterMap.cpp
+ * @author Trent Tobias
+ * @brief Per-gate clutter map
+ */
+
+#include "LD2412ClutterMap.h"
+
+void LD2412ClutterMap::setThresholds(uint8_t moving, uint8_t stationary) {
+    this->thresholds[0] = moving;
+    this->thresholds[1] = stationary;
+}
+
+uint8_t LD2412ClutterMap::update(const LD2412GateEnergies& energies) {
+    const uint8_t* values[2] = {energies.moving, energies.stationary};
+    this->presence = 0;
+    for (unsigned int kind=0; kind<2; kind++)
+        for (unsigned int gate=0; gate<GATES; gate++) {
+            uint8_t fg = track(this->background[kind][gate], values[kind][gate], this->thresholds[kind]);
+            this->foreground[kind][gate] = fg;
+            if (fg >= this->thresholds[kind])
+                this->presence |= 1 << kind;
+        }
+    if (this->frames < LEARN_FRAMES)
+        this->frames++;
+    return this->presence;
+}
+
+void LD2412ClutterMap::reset() {
+    for (unsigned int kind=0; kind<2; kind++)
+        for (unsigned int gate=0; gate<GATES; gate++) {
+            this->background[kind][gate] = 0;
+            this->foreground[kind][gate] = 0;
+        }
+    this->frames = 0;
+    this->presence = 0;
+}
+
+bool LD2412ClutterMap::learned() const {
+    return this->frames >= LEARN_FRAMES;
+}
+
+uint8_t LD2412ClutterMap::state() const {
+    return this->presence;
+}
+
+uint8_t LD2412ClutterMap::movingForeground(uint8_t gate) const {
+    return gate < GATES ? this->foreground[0][gate] : 0;
+}
+
+uint8_t LD2412ClutterMap::staticForeground(uint8_t gate) const {
+    return gate < GATES ? this->foreground[1][gate] : 0;
+}
+
+bool LD2412ClutterMap::gateActive(uint8_t gate) const {
+    return gate < GATES && (this->foreground[0][gate] >= this->thresholds[0] || this->foreground[1][gate] >= this->thresholds[1]);
+}
+
+uint8_t LD2412ClutterMap::movingBackground(uint8_t gate) const {
+    return gate < GATES ? (this->background[0][gate] + 0x8000) >> 16 : 0;
+}
+
+uint8_t LD2412ClutterMap::staticBackground(uint8_t gate) const {
+    return gate < GATES ? (this->background[1][gate] + 0x8000) >> 16 : 0;
+}
+
+uint8_t LD2412ClutterMap::track(uint32_t& background, uint8_t energy, uint8_t threshold) {
+    uint32_t level = static_cast<uint32_t>(energy) << 16;
+    uint8_t base = (background + 0x8000) >> 16;
+    uint8_t fg = energy > base ? energy - base : 0;
+
+    if (this->frames < LEARN_FRAMES) {
+        //Learning: the first frame seeds the average, the next ones converge fast
+        if (this->frames == 0)
+            background = level;
+        else if (level > background)
+            background += (level - background) >> LEARN_SHIFT;
+        else
+            background -= (background - level) >> LEARN_SHIFT;
+        return 0;
+    }
+    if (level > background)
+        background += (level - background) >> (fg >= threshold ? TARGET_SHIFT : ADAPT_SHIFT);
+    else
+        background -= (background - level) >> ADAPT_SHIFT;
+    return fg;
+}
@@ -0,0 +1,96 @@
+/**
+ * @file LD2412ClutterMap.h
+ * @author Trent Tobias
+ * @brief Per-gate background of engineering-mode energies and presence from what stands out of it
+ */
+
+#ifndef LD2412_CLUTTER_MAP_H
+#define LD2412_CLUTTER_MAP_H
+
+#include <Arduino.h>
+#include "LD2412Frame.h"
+
+/**
+ * @brief Keeps an exponential moving average of every gate's moving and static energy in 16.16
+ * fixed point. The first LEARN_FRAMES frames after a reset learn the room quickly (it should be
+ * empty then). Afterwards the background follows slowly, and on gates where a target stands out
+ * it rises far slower still: a seated person stays visible for about half an hour, and clutter
+ * appearing later (a fan switched on) is absorbed in as long.
+ * Presence is any gate whose energy exceeds its background by the threshold
+ */
+class LD2412ClutterMap {
+public:
+    static constexpr unsigned int GATES = LD2412GateEnergies::GATES;
+    static constexpr uint16_t LEARN_FRAMES = 50;            //5 s at the default 10 Hz
+    static constexpr uint8_t LEARN_SHIFT = 3;
+    static constexpr uint8_t ADAPT_SHIFT = 10;              //~100 s time constant
+    static constexpr uint8_t TARGET_SHIFT = 14;             //~27 min for a gate's background to rise under a target
+
+    /**
+     * @brief Sets how far above the background a gate's energy has to be to count as a target
+     * @param moving Moving energy margin (default: 15)
+     * @param stationary Static energy margin (default: 10)
+     */
+    void setThresholds(uint8_t moving, uint8_t stationary);
+
+    /**
+     * @brief Feeds one engineering-mode frame, e.g. from LD2412::readGateEnergies()
+     * @param energies Per-gate energies
+     * @return Target status from the background-subtracted energies (0 none, 1 moving, 2 stationary,
+     * 3 both), 0 while learning
+     */
+    uint8_t update(const LD2412GateEnergies& energies);
+
+    /**
+     * @brief Forgets the background and learns it again from the next frames
+     */
+    void reset();
+
+    /**
+     * @brief Whether the initial learning is done
+     */
+    bool learned() const;
+
+    /**
+     * @brief Gets the target status of the latest frame
+     * @return Target status (0 none, 1 moving, 2 stationary, 3 both)
+     */
+    uint8_t state() const;
+
+    /**
+     * @brief Gets a gate's energy above its background in the latest frame
+     * @param gate Distance gate (0-13)
+     * @return Background-subtracted energy, 0 if at or below the background
+     */
+    uint8_t movingForeground(uint8_t gate) const;
+    uint8_t staticForeground(uint8_t gate) const;
+
+    /**
+     * @brief Whether a gate's moving or static energy stood out of its background in the latest frame
+     * @param gate Distance gate (0-13)
+     * @return Gate target status
+     */
+    bool gateActive(uint8_t gate) const;
+
+    /**
+     * @brief Gets a gate's background energy
+     * @param gate Distance gate (0-13)
+     * @return Background energy, rounded
+     */
+    uint8_t movingBackground(uint8_t gate) const;
+    uint8_t staticBackground(uint8_t gate) const;
+
+private:
+    uint8_t thresholds[2] = {15, 10};
+    uint32_t background[2][GATES] = {};     //16.16 fixed point, [0] moving, [1] static
+    uint8_t foreground[2][GATES] = {};
+    uint16_t frames = 0;
+    uint8_t presence = 0;
+
+    /**
+     * @brief Updates one gate and returns its foreground
+     */
+    uint8_t track(uint32_t& background, uint8_t energy, uint8_t threshold);
+};
+
+#endif //LD2412_CLUTTER_MAP_H
@@ -0,0 +1,90 @@
+/**
+ * @file LD2412Confidence.cpp
+ * @author Trent Tobias
+ * @brief Presence confidence score
+ */
+
+#include "LD2412Confidence.h"
+#include "LD2412.h"
+
+namespace {
+    //Energy above the sensitivity, in steps of 5 (0-4, 5-9, ... 40 and more)
+    constexpr uint8_t MARGIN_POINTS[] = {5, 12, 20, 27, 33, 38, 42, 46, 50};
+    //Frames in the run (0-15 and more)
+    constexpr uint8_t RUN_POINTS[] = {0, 6, 11, 15, 18, 21, 23, 25, 26, 27, 28, 29, 29, 30, 30, 30};
+    //Distance change in steps of 10 cm (0-9, 10-19, ... 70 and more)
+    constexpr uint8_t STEADY_POINTS[] = {20, 18, 15, 11, 7, 4, 2, 0};
+}
+
+bool LD2412Confidence::load(LD2412& radar) {
+    const int* motion = radar.getMotionSensitivity(RETURN_ARRAY);
+    if (motion == nullptr)
+        return false;
+    uint8_t values[GATES];
+    for (unsigned int gate=0; gate<GATES; gate++)
+        values[gate] = static_cast<uint8_t>(motion[gate]);
+    //Both queries return the same buffer
+    const int* stationary = radar.getStaticSensitivity(RETURN_ARRAY);
+    if (stationary == nullptr)
+        return false;
+    for (unsigned int gate=0; gate<GATES; gate++) {
+        this->motionSensitivity[gate] = values[gate];
+        this->staticSensitivity[gate] = static_cast<uint8_t>(stationary[gate]);
+    }
+    return true;
+}
+
+void LD2412Confidence::setSensitivities(const uint8_t motion[GATES], const uint8_t stationary[GATES]) {
+    for (unsigned int gate=0; gate<GATES; gate++) {
+        this->motionSensitivity[gate] = motion[gate];
+        this->staticSensitivity[gate] = stationary[gate];
+    }
+}
+
+uint8_t LD2412Confidence::update(const LD2412Frame& frame) {
+    if (frame.state == 0) {
+        this->run /= 2;
+        this->score = 0;
+        return 0;
+    }
+    if (this->run < std::size(RUN_POINTS) - 1)
+        this->run++;
+
+    uint8_t energy = 0;
+    if (frame.state & 1)
+        energy = energyPoints(frame.movingEnergy, frame.movingDistance, this->motionSensitivity);
+    if (frame.state & 2) {
+        uint8_t points = energyPoints(frame.staticEnergy, frame.staticDistance, this->staticSensitivity);
+        if (points > energy)
+            energy = points;
+    }
+
+    uint16_t distance = frame.state & 1 ? frame.movingDistance : frame.staticDistance;
+    uint8_t steady = 0;
+    if (this->tracking) {
+        uint16_t jump = distance > this->lastDistance ? distance - this->lastDistance : this->lastDistance - distance;
+        steady = STEADY_POINTS[jump / 10 < std::size(STEADY_POINTS) ? jump / 10 : std::size(STEADY_POINTS) - 1];
+    }
+    this->tracking = true;
+    this->lastDistance = distance;
+
+    this->score = energy + RUN_POINTS[this->run] + steady;
+    return this->score;
+}
+
+uint8_t LD2412Confidence::value() const {
+    return this->score;
+}
+
+void LD2412Confidence::reset() {
+    this->run = 0;
+    this->tracking = false;
+    this->lastDistance = 0;
+    this->score = 0;
+}
+
+uint8_t LD2412Confidence::energyPoints(uint8_t energy, uint16_t distance, const uint8_t sensitivity[GATES]) {
+    uint8_t gate = LD2412GateEnergies::gateOf(distance);
+    uint8_t margin = energy > sensitivity[gate] ? energy - sensitivity[gate] : 0;
+    return MARGIN_POINTS[margin / 5 < std::size(MARGIN_POINTS) ? margin / 5 : std::size(MARGIN_POINTS) - 1];
+}
@@ -0,0 +1,76 @@
+/**
+ * @file LD2412Confidence.h
+ * @author Trent Tobias
+ * @brief Per-frame presence confidence (0-100) from energy above the configured sensitivities,
+ * persistence and distance stability
+ */
+
+#ifndef LD2412_CONFIDENCE_H
+#define LD2412_CONFIDENCE_H
+
+#include <Arduino.h>
+#include "LD2412Frame.h"
+
+class LD2412;
+
+/**
+ * @brief Sum of three table lookups, integer only:
+ * - energy: up to 50 points for how far the target's energy is above the sensitivity of its gate
+ * (the better of moving and static when both are reported)
+ * - persistence: up to 30 points for the run of frames with a target; a frame without one
+ * halves the run rather than ending it, so single dropouts cost little
+ * - stability: up to 20 points for a small distance change since the previous target frame
+ * A frame without a target scores 0
+ */
+class LD2412Confidence {
+public:
+    static constexpr unsigned int GATES = LD2412GateEnergies::GATES;
+
+    /**
+     * @brief Caches the module's per-gate motion and static sensitivities (two short config sessions)
+     * @param radar Module to read
+     * @return Success status, the cached values are kept on failure
+     */
+    bool load(LD2412& radar);
+
+    /**
+     * @brief Sets the per-gate sensitivities directly, e.g. from the configuration the module runs
+     * (default: 0 on every gate)
+     * @param motion Motion sensitivity per gate (0-100)
+     * @param stationary Static sensitivity per gate (0-100)
+     */
+    void setSensitivities(const uint8_t motion[GATES], const uint8_t stationary[GATES]);
+
+    /**
+     * @brief Scores one report frame
+     * @param frame Decoded frame
+     * @return Confidence (0-100)
+     */
+    uint8_t update(const LD2412Frame& frame);
+
+    /**
+     * @brief Gets the confidence of the latest frame
+     * @return Confidence (0-100)
+     */
+    uint8_t value() const;
+
+    /**
+     * @brief Forgets the run and the previous distance, keeps the sensitivities
+     */
+    void reset();
+
+private:
+    uint8_t motionSensitivity[GATES] = {};
+    uint8_t staticSensitivity[GATES] = {};
+    uint8_t run = 0;
+    bool tracking = false;
+    uint16_t lastDistance = 0;
+    uint8_t score = 0;
+
+    /**
+     * @brief Points for one kind of energy at a distance
+     */
+    static uint8_t energyPoints(uint8_t energy, uint16_t distance, const uint8_t sensitivity[GATES]);
+};
+
+#endif //LD2412_CONFIDENCE_H
@@ -0,0 +1,30 @@
+/**
+ * @file LD2412Config.cpp
+ * @author Trent Tobias
+ * @brief Configuration fingerprint
+ */
+
+#include "LD2412Config.h"
+
+namespace {
+    uint32_t fnv1a(uint32_t hash, uint8_t byte) {
+        return (hash ^ byte) * 16777619UL;
+    }
+}
+
+uint32_t LD2412Config::fingerprint(const int firmware[3]) const {
+    uint32_t hash = 2166136261UL;
+    for (int i=0; i<3; i++)
+        for (int b=0; b<32; b+=8)
+            hash = fnv1a(hash, static_cast<uint32_t>(firmware[i]) >> b);
+
+    hash = fnv1a(hash, this->minGate);
+    hash = fnv1a(hash, this->maxGate);
+    hash = fnv1a(hash, this->duration);
+    hash = fnv1a(hash, this->outPinPolarity);
+    for (int i=0; i<14; i++)
+        hash = fnv1a(hash, this->motionSensitivity[i]);
+    for (int i=0; i<14; i++)
+        hash = fnv1a(hash, this->staticSensitivity[i]);
+    return hash;
+}
@@ -0,0 +1,54 @@
+/**
+ * @file LD2412Config.h
+ * @author Trent Tobias
+ * @brief Full module configuration, its fingerprint and the storage interface used to
+ * skip re-applying it on every boot
+ */
+
+#ifndef LD2412_CONFIG_H
+#define LD2412_CONFIG_H
+
+#include <Arduino.h>
+
+/**
+ * @brief Configuration applied by LD2412::ensureConfig()
+ */
+struct LD2412Config {
+    uint8_t minGate = 1;                    //Minimum distance gate (1-14)
+    uint8_t maxGate = 12;                   //Maximum distance gate (1-14)
+    uint8_t duration = 5;                   //Unmanned duration (s)
+    uint8_t outPinPolarity = 0;             //0 manned output HIGH, 1 unmanned output LOW
+    uint8_t motionSensitivity[14] = {};     //Per gate (0-100), all 0 (unset) keeps the module's values
+    uint8_t staticSensitivity[14] = {};     //Per gate (0-100), all 0 (unset) keeps the module's values
+
+    /**
+     * @brief 32-bit FNV-1a hash of the configuration and the firmware it runs on, so a
+     * firmware update also counts as a mismatch
+     * @param firmware Firmware type, major and minor version as returned by readFirmwareVersion()
+     * @return Fingerprint
+     */
+    uint32_t fingerprint(const int firmware[3]) const;
+};
+
+/**
+ * @brief Non-volatile home of the last applied fingerprint: EEPROM, NVS, flash or a file.
+ * Implement both calls for the target's storage and pass it to LD2412::ensureConfig()
+ */
+class LD2412ConfigStore {
+public:
+    virtual ~LD2412ConfigStore() = default;
+
+    /**
+     * @brief Reads the stored fingerprint
+     * @return False if none was stored yet or it could not be read
+     */
+    virtual bool load(uint32_t& fingerprint) = 0;
+
+    /**
+     * @brief Stores a fingerprint
+     * @return Success status
+     */
+    virtual bool save(uint32_t fingerprint) = 0;
+};
+
+#endif //LD2412_CONFIG_H
@@ -0,0 +1,140 @@
+/**
+ * @file LD2412Direction.cpp
+ * @author Trent Tobias
+ * @brief Approach/departure classifier
+ */
+
+#include "LD2412Direction.h"
+
+void LD2412Direction::setCallback(MotionCallback onChange) {
+    this->callback = onChange;
+}
+
+bool LD2412Direction::update(const LD2412Frame& frame) {
+    //readFrame() returns the same frame until the next one arrives
+    if (this->fed && frame.timestamp == this->lastFrame)
+        return false;
+    this->fed = true;
+    this->lastFrame = frame.timestamp;
+
+    bool moving = frame.state == 1 || frame.state == 3;
+    bool expired = this->count > 0 && static_cast<uint32_t>(frame.timestamp - this->lastMoving) > GAP_MS;
+
+    if (expired) {
+        clearTrack();
+        this->streak = 0;
+        if (this->label != NONE) {
+            this->label = this->candidate = NONE;
+            this->lastSpeed = 0;
+            if (this->callback != nullptr)
+                this->callback(NONE, 0);
+            return true;
+        }
+    }
+    if (!moving)
+        return false;
+
+    uint16_t distance = frame.movingDistance < 4095 ? frame.movingDistance : 4095;
+    if (this->count > 0) {
+        uint16_t last = this->distances[(this->head + this->count - 1) % WINDOW];
+        if ((distance > last ? distance - last : last - distance) > MAX_JUMP) {
+            //A single jump is dropped; two that agree are a new target
+            bool agrees = this->outlier != 0
+                && (distance > this->outlier ? distance - this->outlier : this->outlier - distance) <= MAX_JUMP;
+            if (!agrees) {
+                this->outlier = distance != 0 ? distance : 1;
+                return false;
+            }
+            clearTrack();
+        }
+    }
+    this->outlier = 0;
+    this->lastMoving = frame.timestamp;
+    push(distance, frame.timestamp);
+
+    if (this->count < MIN_SAMPLES)
+        return false;
+    return propose(classify(frame.timestamp));
+}
+
+void LD2412Direction::reset() {
+    clearTrack();
+    this->fed = false;
+    this->label = this->candidate = NONE;
+    this->streak = 0;
+    this->lastSpeed = 0;
+}
+
+uint8_t LD2412Direction::motion() const {
+    return this->label;
+}
+
+int LD2412Direction::speed() const {
+    return this->lastSpeed;
+}
+
+void LD2412Direction::clearTrack() {
+    this->head = this->count = 0;
+    this->sumD = this->sumDD = this->sumXD = 0;
+    this->outlier = 0;
+    this->lateral = false;
+}
+
+void LD2412Direction::push(uint16_t distance, unsigned long time) {
+    int32_t d = distance;
+    if (this->count == WINDOW) {
+        //Every remaining sample moves down one index
+        int32_t oldest = this->distances[this->head];
+        this->sumXD -= this->sumD - oldest;
+        this->sumD -= oldest;
+        this->sumDD -= oldest * oldest;
+        this->head = (this->head + 1) % WINDOW;
+        this->count--;
+    }
+    uint8_t slot = (this->head + this->count) % WINDOW;
+    this->distances[slot] = distance;
+    this->times[slot] = time;
+    this->sumXD += this->count * d;
+    this->sumD += d;
+    this->sumDD += d * d;
+    this->count++;
+}
+
+uint8_t LD2412Direction::classify(unsigned long now) {
+    int64_t n = this->count;
+    int64_t sumX = n * (n - 1) / 2;
+    int64_t sumXX = (n - 1) * n * (2 * n - 1) / 6;
+    int64_t num = n * this->sumXD - sumX * this->sumD;
+    int64_t varX = n * sumXX - sumX * sumX;
+    int64_t varD = n * this->sumDD - static_cast<int64_t>(this->sumD) * this->sumD;
+
+    //Slope is cm per frame, the window's span turns it into cm/s
+    uint32_t span = this->times[(this->head + this->count - 1) % WINDOW] - this->times[this->head];
+    this->lastSpeed = span > 0 ? static_cast<int>(num * (n - 1) * 1000 / (varX * span)) : 0;
+
+    int speed = this->lastSpeed < 0 ? -this->lastSpeed : this->lastSpeed;
+    if (speed >= MOVE_SPEED && num * num * 100 >= TREND_R2 * varX * varD) {
+        this->lateral = false;
+        return this->lastSpeed < 0 ? APPROACHING : DEPARTING;
+    }
+    if (!this->lateral) {
+        this->lateral = true;
+        this->lateralSince = now;
+    }
+    return static_cast<uint32_t>(now - this->lateralSince) >= LOITER_MS ? LOITERING : CROSSING;
+}
+
+bool LD2412Direction::propose(uint8_t motion) {
+    if (motion != this->candidate) {
+        this->candidate = motion;
+        this->streak = 0;
+    }
+    if (this->streak < CONFIRM)
+        this->streak++;
+    if (this->streak < CONFIRM || motion == this->label)
+        return false;
+    this->label = motion;
+    if (this->callback != nullptr)
+        this->callback(motion, this->lastSpeed);
+    return true;
+}
@@ -0,0 +1,124 @@
+/**
+ * @file LD2412Direction.h
+ * @author Trent Tobias
+ * @brief Labels the moving target as approaching, departing, crossing or loitering from
+ * its distance over a short window of frames
+ */
+
+#ifndef LD2412_DIRECTION_H
+#define LD2412_DIRECTION_H
+
+#include <Arduino.h>
+#include "LD2412Frame.h"
+
+/**
+ * @brief Least-squares slope of the moving distance over the last WINDOW frames, kept as
+ * running integer sums so each frame costs the same few multiplications. A clear radial trend
+ * is approaching or departing. Motion without one is crossing the beam, or loitering once
+ * it has lasted LOITER_MS. A label has to win CONFIRM frames in a row before it is reported
+ */
+class LD2412Direction {
+public:
+    enum Motion : uint8_t {
+        NONE,
+        APPROACHING,
+        DEPARTING,
+        CROSSING,
+        LOITERING
+    };
+
+    /**
+     * @brief Called when the label changes
+     * @param motion New label
+     * @param speed Radial speed at that frame (cm/s, negative towards the sensor)
+     */
+    typedef void (*MotionCallback)(uint8_t motion, int speed);
+
+    static constexpr uint8_t WINDOW = 16;                   //Frames in the fit, 1.6 s at the default 10 Hz
+    static constexpr uint8_t MIN_SAMPLES = 8;               //Frames before a track is labelled
+    static constexpr uint8_t CONFIRM = 3;
+    static constexpr unsigned long GAP_MS = 500;            //Longer without a moving target ends the track
+    static constexpr uint16_t MAX_JUMP = 100;               //cm between frames; further is an outlier or a new target
+    static constexpr int MOVE_SPEED = 20;                   //cm/s for a radial trend
+    static constexpr int TREND_R2 = 60;                     //Percent of the distance variance the trend has to explain
+    static constexpr unsigned long LOITER_MS = 5000;
+
+    /**
+     * @brief Sets the function called on label changes (may be nullptr)
+     */
+    void setCallback(MotionCallback onChange);
+
+    /**
+     * @brief Feeds one report frame, e.g. from LD2412::readFrame(). A repeat of the frame fed
+     * last (same timestamp) is ignored
+     * @param frame Decoded frame with its capture time
+     * @return True if the label changed
+     */
+    bool update(const LD2412Frame& frame);
+
+    /**
+     * @brief Forgets the track and the label
+     */
+    void reset();
+
+    /**
+     * @brief Gets the current label
+     * @return Motion label
+     */
+    uint8_t motion() const;
+
+    /**
+     * @brief Gets the radial speed of the latest fit
+     * @return Speed (cm/s, negative towards the sensor), 0 without a track
+     */
+    int speed() const;
+
+private:
+    MotionCallback callback = nullptr;
+
+    //Window ring, oldest at head
+    uint16_t distances[WINDOW];
+    unsigned long times[WINDOW];
+    uint8_t head = 0;
+    uint8_t count = 0;
+
+    //Running sums over the window, sample index 0 being the oldest
+    int32_t sumD = 0;
+    int32_t sumDD = 0;
+    int32_t sumXD = 0;
+
+    uint16_t outlier = 0;                   //Distance of a pending jump, 0 if none
+    unsigned long lastMoving = 0;           //Time of the latest moving frame
+    unsigned long lastFrame = 0;            //Time of the latest frame fed
+    bool fed = false;                       //Whether lastFrame holds a frame
+    unsigned long lateralSince = 0;         //Start of the current run without a radial trend
+    bool lateral = false;
+
+    uint8_t label = NONE;
+    uint8_t candidate = NONE;
+    uint8_t streak = 0;
+    int lastSpeed = 0;
+
+    /**
+     * @brief Clears the window for a new track
+     */
+    void clearTrack();
+
+    /**
+     * @brief Appends a distance, dropping the oldest one when the window is full
+     */
+    void push(uint16_t distance, unsigned long time);
+
+    /**
+     * @brief Label for the current window
+     */
+    uint8_t classify(unsigned long now);
+
+    /**
+     * @brief Debounces a label and reports a change
+     * @return True if the label changed
+     */
+    bool propose(uint8_t motion);
+};
+
+#endif //LD2412_DIRECTION_H
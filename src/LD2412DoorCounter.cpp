@@ -0,0 +1,95 @@
+/**
+ * @file LD2412DoorCounter.cpp
+ * @author Trent Tobias
+ * @brief Doorway people counter
+ */
+
+#include "LD2412DoorCounter.h"
+
+void LD2412DoorCounter::setCallback(CountCallback onChange) {
+    this->callback = onChange;
+}
+
+void LD2412DoorCounter::setEmptyTimeout(unsigned long ms) {
+    this->emptyTimeout = ms;
+}
+
+bool LD2412DoorCounter::update(Side side, const LD2412Frame& frame) {
+    LD2412Direction& own = this->direction[side];
+    uint8_t other = side ^ 1;
+    bool relabelled = own.update(frame);
+
+    bool changed = false;
+    if (own.motion() == LD2412Direction::APPROACHING) {
+        this->armed[side] = true;
+        this->armedAt[side] = frame.timestamp;
+    }
+    else if (relabelled && own.motion() == LD2412Direction::DEPARTING && this->armed[other]) {
+        //Someone came up to the door on the other side and now walks away from it on this one
+        if (static_cast<uint32_t>(frame.timestamp - this->armedAt[other]) <= PAIR_MS) {
+            if (side == INSIDE) {
+                this->entryCount++;
+                change(this->people + 1, 1);
+            }
+            else {
+                this->exitCount++;
+                change(this->people > 0 ? this->people - 1 : 0, -1);
+            }
+            changed = true;
+        }
+        this->armed[other] = false;
+    }
+    //Whoever approached without going through has left the door
+    if (own.motion() != LD2412Direction::APPROACHING && this->armed[side]
+        && static_cast<uint32_t>(frame.timestamp - this->armedAt[side]) > PAIR_MS)
+        this->armed[side] = false;
+
+    if (side == INSIDE)
+        changed = correct(frame) || changed;
+    return changed;
+}
+
+void LD2412DoorCounter::setCount(int count) {
+    this->people = count > 0 ? count : 0;
+}
+
+int LD2412DoorCounter::count() const {
+    return this->people;
+}
+
+uint32_t LD2412DoorCounter::entries() const {
+    return this->entryCount;
+}
+
+uint32_t LD2412DoorCounter::exits() const {
+    return this->exitCount;
+}
+
+uint32_t LD2412DoorCounter::corrections() const {
+    return this->correctionCount;
+}
+
+void LD2412DoorCounter::change(int count, int change) {
+    this->people = count;
+    if (this->callback != nullptr)
+        this->callback(count, change);
+}
+
+bool LD2412DoorCounter::correct(const LD2412Frame& frame) {
+    bool target = frame.state != 0;
+    if (!this->insideKnown || target != this->inside) {
+        this->insideKnown = true;
+        this->inside = target;
+        this->insideSince = frame.timestamp;
+        return false;
+    }
+    if (this->emptyTimeout == 0 || static_cast<uint32_t>(frame.timestamp - this->insideSince) < this->emptyTimeout)
+        return false;
+    //Only corrects once per run, the count then agrees with the sensor
+    if (!target && this->people != 0 || target && this->people == 0) {
+        this->correctionCount++;
+        change(target ? 1 : 0, 0);
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,104 @@
+/**
+ * @file LD2412DoorCounter.h
+ * @author Trent Tobias
+ * @brief Counts people through a doorway watched by two LD2412s, one facing out of the
+ * room and one facing into it
+ */
+
+#ifndef LD2412_DOOR_COUNTER_H
+#define LD2412_DOOR_COUNTER_H
+
+#include <Arduino.h>
+#include "LD2412Direction.h"
+#include "LD2412Frame.h"
+
+/**
+ * @brief A crossing is someone approaching the door on one side, then departing from it on
+ * the other within PAIR_MS: outside then inside is an entry, inside then outside an exit.
+ * The room count is reset to 0 when the inside sensor sees nobody for the empty timeout, and
+ * raised to 1 when it sees someone for as long while the count says the room is empty
+ */
+class LD2412DoorCounter {
+public:
+    enum Side : uint8_t {
+        OUTSIDE,
+        INSIDE
+    };
+
+    /**
+     * @brief Called when the room count changes
+     * @param count New room count
+     * @param change +1 entry, -1 exit, 0 drift correction
+     */
+    typedef void (*CountCallback)(int count, int change);
+
+    static constexpr unsigned long PAIR_MS = 4000;              //Approach on one side to departure on the other
+    static constexpr unsigned long EMPTY_MS = 60000;            //Default empty timeout
+
+    /**
+     * @brief Sets the function called on count changes (may be nullptr)
+     */
+    void setCallback(CountCallback onChange);
+
+    /**
+     * @brief Sets how long the inside sensor has to agree with a wrong count before it is corrected
+     * @param ms Timeout, 0 disables drift correction
+     */
+    void setEmptyTimeout(unsigned long ms);
+
+    /**
+     * @brief Feeds one report frame from either sensor, in capture order
+     * @param side Sensor the frame came from
+     * @param frame Decoded frame with its capture time
+     * @return True if the count changed
+     */
+    bool update(Side side, const LD2412Frame& frame);
+
+    /**
+     * @brief Sets the room count, e.g. when known at start-up
+     */
+    void setCount(int count);
+
+    /**
+     * @brief Gets the room count
+     * @return People in the room
+     */
+    int count() const;
+
+    /**
+     * @brief Gets the totals since construction
+     */
+    uint32_t entries() const;
+    uint32_t exits() const;
+    uint32_t corrections() const;
+
+private:
+    CountCallback callback = nullptr;
+    unsigned long emptyTimeout = EMPTY_MS;
+
+    LD2412Direction direction[2];
+    bool armed[2] = {};                     //Side saw someone approach the door
+    unsigned long armedAt[2] = {};          //Latest frame of that approach
+
+    bool inside = false;                    //Inside sensor currently sees a target
+    bool insideKnown = false;
+    unsigned long insideSince = 0;          //Start of the current inside target/no target run
+
+    int people = 0;
+    uint32_t entryCount = 0;
+    uint32_t exitCount = 0;
+    uint32_t correctionCount = 0;
+
+    /**
+     * @brief Applies a count change and notifies
+     */
+    void change(int count, int change);
+
+    /**
+     * @brief Checks the inside sensor's view against the count
+     * @return True if the count was corrected
+     */
+    bool correct(const LD2412Frame& frame);
+};
+
+#endif //LD2412_DOOR_COUNTER_H
@@ -0,0 +1,152 @@
+/**
+ * @file LD2412Dwell.cpp
+ * @author Trent Tobias
+ * @brief Per-zone dwell analytics
+ */
+
+#include "LD2412Dwell.h"
+
+bool LD2412Dwell::setZone(uint8_t zone, uint16_t minCm, uint16_t maxCm) {
+    if (zone >= ZONES || maxCm != 0 && maxCm <= minCm)
+        return false;
+    if (this->zones[zone].open)
+        finish(zone);
+    this->zones[zone].minCm = minCm;
+    this->zones[zone].maxCm = maxCm;
+    return true;
+}
+
+void LD2412Dwell::setGap(unsigned long ms) {
+    this->gap = ms;
+}
+
+void LD2412Dwell::setCallback(DwellCallback onClose) {
+    this->callback = onClose;
+}
+
+void LD2412Dwell::update(const LD2412Frame& frame) {
+    for (uint8_t i=0; i<ZONES; i++) {
+        Zone& zone = this->zones[i];
+        if (zone.maxCm == 0)
+            continue;
+
+        //Targets inside the zone: both count towards the mean distance, the stronger is the energy
+        uint32_t distance = 0;
+        uint8_t targets = 0;
+        uint8_t energy = 0;
+        if (frame.state & 1 && frame.movingDistance >= zone.minCm && frame.movingDistance < zone.maxCm) {
+            distance += frame.movingDistance;
+            targets++;
+            energy = frame.movingEnergy;
+        }
+        if (frame.state & 2 && frame.staticDistance >= zone.minCm && frame.staticDistance < zone.maxCm) {
+            distance += frame.staticDistance;
+            targets++;
+            if (frame.staticEnergy > energy)
+                energy = frame.staticEnergy;
+        }
+
+        if (targets == 0) {
+            if (zone.open && static_cast<uint32_t>(frame.timestamp - zone.lastSeen) >= this->gap)
+                finish(i);
+            continue;
+        }
+        if (!zone.open) {
+            zone.open = true;
+            zone.start = frame.timestamp;
+            zone.distanceSum = 0;
+            zone.frames = 0;
+            zone.peakEnergy = 0;
+        }
+        zone.lastSeen = frame.timestamp;
+        zone.distanceSum += distance / targets;
+        zone.frames++;
+        if (energy > zone.peakEnergy)
+            zone.peakEnergy = energy;
+    }
+}
+
+void LD2412Dwell::close() {
+    for (uint8_t i=0; i<ZONES; i++)
+        if (this->zones[i].open)
+            finish(i);
+}
+
+bool LD2412Dwell::occupied(uint8_t zone) const {
+    return zone < ZONES && this->zones[zone].open;
+}
+
+uint8_t LD2412Dwell::intervalCount() const {
+    return this->ringCount;
+}
+
+const LD2412DwellInterval* LD2412Dwell::interval(uint8_t index) const {
+    if (index >= this->ringCount)
+        return nullptr;
+    return &this->ring[(this->ringHead + INTERVALS - 1 - index) % INTERVALS];
+}
+
+uint32_t LD2412Dwell::count(uint8_t zone) const {
+    return zone < ZONES ? this->zones[zone].count : 0;
+}
+
+uint64_t LD2412Dwell::total(uint8_t zone) const {
+    return zone < ZONES ? this->zones[zone].total : 0;
+}
+
+unsigned long LD2412Dwell::percentile(uint8_t zone, uint8_t percent) const {
+    if (zone >= ZONES || this->zones[zone].count == 0)
+        return 0;
+    const Zone& z = this->zones[zone];
+    //Rank of the wanted interval, rounded up
+    uint64_t rank = (static_cast<uint64_t>(z.count) * (percent > 100 ? 100 : percent) + 99) / 100;
+    uint64_t seen = 0;
+    for (unsigned int b=0; b<DWELL_BUCKETS - 1; b++) {
+        seen += z.histogram[b];
+        if (seen >= rank && seen > 0)
+            return DWELL_BOUNDS[b] < z.longest ? DWELL_BOUNDS[b] : z.longest;
+    }
+    return z.longest;
+}
+
+void LD2412Dwell::reset() {
+    for (uint8_t i=0; i<ZONES; i++) {
+        Zone& zone = this->zones[i];
+        zone.open = false;
+        zone.count = 0;
+        zone.total = 0;
+        zone.longest = 0;
+        for (unsigned int b=0; b<DWELL_BUCKETS; b++)
+            zone.histogram[b] = 0;
+    }
+    this->ringHead = 0;
+    this->ringCount = 0;
+}
+
+void LD2412Dwell::finish(uint8_t zone) {
+    Zone& z = this->zones[zone];
+    z.open = false;
+    unsigned long dwell = static_cast<uint32_t>(z.lastSeen - z.start);
+
+    LD2412DwellInterval& record = this->ring[this->ringHead];
+    record.start = z.start;
+    record.end = z.lastSeen;
+    record.meanDistance = static_cast<uint16_t>(z.frames > 0 ? z.distanceSum / z.frames : 0);
+    record.peakEnergy = z.peakEnergy;
+    record.zone = zone;
+    this->ringHead = (this->ringHead + 1) % INTERVALS;
+    if (this->ringCount < INTERVALS)
+        this->ringCount++;
+
+    z.count++;
+    z.total += dwell;
+    if (dwell > z.longest)
+        z.longest = dwell;
+    unsigned int bucket = 0;
+    while (bucket < DWELL_BUCKETS - 1 && dwell > DWELL_BOUNDS[bucket])
+        bucket++;
+    z.histogram[bucket]++;
+
+    if (this->callback != nullptr)
+        this->callback(record);
+}
@@ -0,0 +1,145 @@
+/**
+ * @file LD2412Dwell.h
+ * @author Trent Tobias
+ * @brief Occupancy intervals and dwell-time statistics per distance zone, updated frame by frame
+ */
+
+#ifndef LD2412_DWELL_H
+#define LD2412_DWELL_H
+
+#include <Arduino.h>
+#include "LD2412Frame.h"
+
+/**
+ * @brief One closed occupancy interval of a zone
+ */
+struct LD2412DwellInterval {
+    unsigned long start;        //Capture time of the first frame with a target in the zone
+    unsigned long end;          //Capture time of the last one
+    uint16_t meanDistance;      //cm, over the frames with a target in the zone
+    uint8_t peakEnergy;
+    uint8_t zone;
+};
+
+/**
+ * @brief A zone is a distance range; it is occupied while a moving or static target is reported
+ * inside it. An interval ends once the zone has been empty for the gap time, at the last frame
+ * the target was seen. Closed intervals go to a ring of the latest INTERVALS (all zones) and
+ * into each zone's count, total and a fixed-bucket histogram of dwell times for percentiles
+ */
+class LD2412Dwell {
+public:
+    /**
+     * @brief Called when an interval closes
+     */
+    typedef void (*DwellCallback)(const LD2412DwellInterval& interval);
+
+    static constexpr uint8_t ZONES = 4;
+    static constexpr uint8_t INTERVALS = 16;
+    static constexpr unsigned long GAP_MS = 10000;          //Default gap that ends an interval
+    static constexpr unsigned int DWELL_BUCKETS = 12;
+    //Bucket upper bounds in ms; the last bucket holds everything above
+    static constexpr unsigned long DWELL_BOUNDS[DWELL_BUCKETS - 1] = {10000, 30000, 60000, 120000, 300000, 600000,
+                                                                      1200000, 1800000, 3600000, 7200000, 14400000};
+
+    /**
+     * @brief Sets a zone's distance range
+     * @param zone Zone (0-3)
+     * @param minCm Start of the range, inclusive
+     * @param maxCm End of the range, exclusive (0 disables the zone)
+     * @return False if the zone or range is invalid
+     */
+    bool setZone(uint8_t zone, uint16_t minCm, uint16_t maxCm);
+
+    /**
+     * @brief Sets how long a zone has to be empty to end its interval (default: 10 s)
+     */
+    void setGap(unsigned long ms);
+
+    /**
+     * @brief Sets the function called when an interval closes (may be nullptr)
+     */
+    void setCallback(DwellCallback onClose);
+
+    /**
+     * @brief Feeds one report frame, e.g. from LD2412::readFrame()
+     * @param frame Decoded frame with its capture time
+     */
+    void update(const LD2412Frame& frame);
+
+    /**
+     * @brief Closes every open interval, e.g. at the end of a reporting period
+     */
+    void close();
+
+    /**
+     * @brief Whether a zone has an open interval
+     */
+    bool occupied(uint8_t zone) const;
+
+    /**
+     * @brief Gets the number of intervals kept
+     */
+    uint8_t intervalCount() const;
+
+    /**
+     * @brief Gets a kept interval
+     * @param index 0 for the latest
+     * @return Interval or nullptr if out of range
+     */
+    const LD2412DwellInterval* interval(uint8_t index) const;
+
+    /**
+     * @brief Gets the number of closed intervals of a zone
+     */
+    uint32_t count(uint8_t zone) const;
+
+    /**
+     * @brief Gets the total dwell time of a zone's closed intervals
+     * @return Total in ms
+     */
+    uint64_t total(uint8_t zone) const;
+
+    /**
+     * @brief Gets a dwell-time percentile of a zone from its histogram
+     * @param zone Zone (0-3)
+     * @param percent Percentile (1-100), e.g. 50 or 95
+     * @return Upper bound of the bucket holding it (at most the longest dwell), 0 without intervals
+     */
+    unsigned long percentile(uint8_t zone, uint8_t percent) const;
+
+    /**
+     * @brief Forgets all intervals and statistics, keeps the zones
+     */
+    void reset();
+
+private:
+    struct Zone {
+        uint16_t minCm = 0;
+        uint16_t maxCm = 0;
+        bool open = false;
+        unsigned long start = 0;
+        unsigned long lastSeen = 0;
+        uint32_t distanceSum = 0;
+        uint32_t frames = 0;
+        uint8_t peakEnergy = 0;
+        uint32_t count = 0;
+        uint64_t total = 0;
+        unsigned long longest = 0;
+        uint32_t histogram[DWELL_BUCKETS] = {};
+    };
+
+    Zone zones[ZONES];
+    LD2412DwellInterval ring[INTERVALS] = {};
+    uint8_t ringHead = 0;
+    uint8_t ringCount = 0;
+    unsigned long gap = GAP_MS;
+    DwellCallback callback = nullptr;
+
+    /**
+     * @brief Ends a zone's interval and records it
+     */
+    void finish(uint8_t zone);
+};
+
+#endif //LD2412_DWELL_H
@@ -0,0 +1,57 @@
+/**
+ * @file LD2412Frame.cpp
+ * @author Trent Tobias
+ * @brief Decoded report frame and its packed 8-byte form for history buffers and logs
+ */
+
+#include "LD2412Frame.h"
+
+uint8_t LD2412GateEnergies::gateOf(uint16_t distance) {
+    unsigned int gate = distance / GATE_CM;
+    return gate < GATES ? gate : GATES - 1;
+}
+
+LD2412PackedFrame LD2412PackedFrame::pack(const LD2412Frame& frame, unsigned long previous) {
+    uint32_t md = frame.movingDistance < MAX_DISTANCE ? frame.movingDistance : MAX_DISTANCE;
+    uint32_t me = frame.movingEnergy < MAX_ENERGY ? frame.movingEnergy : MAX_ENERGY;
+    uint32_t sd = frame.staticDistance < MAX_DISTANCE ? frame.staticDistance : MAX_DISTANCE;
+    uint32_t se = frame.staticEnergy < MAX_ENERGY ? frame.staticEnergy : MAX_ENERGY;
+    //32-bit difference so the delta survives millis() wraparound
+    uint32_t dt = static_cast<uint32_t>(frame.timestamp - previous);
+    if (dt > MAX_DELTA)
+        dt = MAX_DELTA;
+
+    //Two 32-bit halves keep this cheap on 8-bit cores
+    uint32_t lo = (frame.state & 0x03) | md << 2 | me << 14 | sd << 21;
+    uint32_t hi = sd >> 11 | se << 1 | dt << 8;
+
+    LD2412PackedFrame packed;
+    for (unsigned int i=0; i<4; i++) {
+        packed.bytes[i] = lo >> (8*i);
+        packed.bytes[i+4] = hi >> (8*i);
+    }
+    return packed;
+}
+
+LD2412Frame LD2412PackedFrame::unpack(unsigned long previous) const {
+    uint32_t lo = 0;
+    uint32_t hi = 0;
+    for (unsigned int i=0; i<4; i++) {
+        lo |= static_cast<uint32_t>(this->bytes[i]) << (8*i);
+        hi |= static_cast<uint32_t>(this->bytes[i+4]) << (8*i);
+    }
+
+    LD2412Frame frame;
+    frame.state = lo & 0x03;
+    frame.movingDistance = (lo >> 2) & MAX_DISTANCE;
+    frame.movingEnergy = (lo >> 14) & MAX_ENERGY;
+    frame.staticDistance = ((lo >> 21) | (hi << 11)) & MAX_DISTANCE;
+    frame.staticEnergy = (hi >> 1) & MAX_ENERGY;
+    frame.timestamp = static_cast<uint32_t>(previous + (hi >> 8));
+    return frame;
+}
+
+unsigned long LD2412PackedFrame::delta() const {
+    return this->bytes[5] | static_cast<unsigned long>(this->bytes[6]) << 8
+        | static_cast<unsigned long>(this->bytes[7]) << 16;
+}
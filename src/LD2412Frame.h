@@ -0,0 +1,79 @@
+/**
+ * @file LD2412Frame.h
+ * @author Trent Tobias
+ * @brief Decoded report frame and its packed 8-byte form for history buffers and logs
+ */
+
+#ifndef LD2412_FRAME_H
+#define LD2412_FRAME_H
+
+#include <Arduino.h>
+
+/**
+ * @brief One decoded basic-mode report frame
+ */
+struct LD2412Frame {
+    uint8_t state;                  //Target status (0 none, 1 moving, 2 stationary, 3 both)
+    uint16_t movingDistance;        //Moving target distance (cm)
+    uint8_t movingEnergy;           //Moving target energy (0-100)
+    uint16_t staticDistance;        //Static target distance (cm)
+    uint8_t staticEnergy;           //Static target energy (0-100)
+    unsigned long timestamp;        //millis() when the frame was captured
+};
+
+/**
+ * @brief Per-gate energies of an engineering-mode report frame
+ */
+struct LD2412GateEnergies {
+    static constexpr unsigned int GATES = 14;
+    static constexpr uint16_t GATE_CM = 75;         //Distance gate resolution (cm)
+
+    uint8_t moving[GATES];          //Moving energy per distance gate (0-100)
+    uint8_t stationary[GATES];      //Static energy per distance gate (0-100)
+    uint8_t light;                  //Photosensitive detection value
+    unsigned long timestamp;        //millis() when the frame was captured
+
+    /**
+     * @brief Distance gate of a target distance, beyond the last gate counts as the last
+     */
+    static uint8_t gateOf(uint16_t distance);
+};
+
+/**
+ * @brief Bit-packed frame, 8 bytes, little-endian bit order:
+ * [0-1] state, [2-13] moving distance, [14-20] moving energy, [21-32] static distance,
+ * [33-39] static energy, [40-63] ms since the previous frame in the history.
+ * Distances saturate at 4095 cm, energies at 127 and the delta at ~4.6 hours.
+ */
+struct LD2412PackedFrame {
+    static constexpr unsigned int SIZE = 8;
+    static constexpr uint16_t MAX_DISTANCE = 0x0FFF;
+    static constexpr uint8_t MAX_ENERGY = 0x7F;
+    static constexpr unsigned long MAX_DELTA = 0xFFFFFF;
+
+    uint8_t bytes[SIZE];
+
+    /**
+     * @brief Packs a frame
+     * @param frame Decoded frame
+     * @param previous Timestamp of the previous frame in the history (the delta base)
+     * @return Packed frame
+     */
+    static LD2412PackedFrame pack(const LD2412Frame& frame, unsigned long previous);
+
+    /**
+     * @brief Unpacks a frame
+     * @param previous Timestamp of the previous frame in the history
+     * @return Decoded frame with timestamp = previous + delta
+     */
+    LD2412Frame unpack(unsigned long previous) const;
+
+    /**
+     * @brief Milliseconds since the previous frame
+     */
+    unsigned long delta() const;
+};
+
+static_assert(sizeof(LD2412PackedFrame) == LD2412PackedFrame::SIZE, "packed frame must stay 8 bytes");
+
+#endif //LD2412_FRAME_H
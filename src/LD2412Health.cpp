@@ -0,0 +1,136 @@
+/**
+ * @file LD2412Health.cpp
+ * @author Trent Tobias
+ * @brief Sensor health and interference detection
+ */
+
+#include "LD2412Health.h"
+
+namespace {
+    //Rated signatures: saturation, distance jumps, frame rate, resyncs
+    constexpr uint8_t BITS[] = {LD2412Health::SATURATION, LD2412Health::DISTANCE_JUMPS,
+                                LD2412Health::FRAME_RATE, LD2412Health::RESYNCS};
+    constexpr uint16_t THRESHOLDS[] = {LD2412Health::SATURATION_PERMILLE, LD2412Health::JUMP_PERMILLE,
+                                       LD2412Health::FRAME_RATE_PERMILLE, LD2412Health::RESYNC_PERMILLE};
+    constexpr uint8_t WEIGHTS[] = {25, 20, 15, 25};
+    constexpr uint8_t STUCK_WEIGHT = 40;
+    constexpr uint8_t INTERVAL_SHIFT = 5;
+    constexpr uint32_t MAX_INTERVAL = 10000;
+
+    uint16_t absDiff(uint16_t a, uint16_t b) {
+        return a > b ? a - b : b - a;
+    }
+}
+
+void LD2412Health::setCallback(AnomalyCallback onChange) {
+    this->callback = onChange;
+}
+
+void LD2412Health::update(const LD2412GateEnergies& energies) {
+    uint8_t saturated = 0;
+    for (unsigned int gate=0; gate<LD2412GateEnergies::GATES; gate++)
+        if (energies.moving[gate] >= SATURATED || energies.stationary[gate] >= SATURATED)
+            saturated++;
+    this->gatesSaturated = saturated >= SATURATED_GATES;
+}
+
+uint8_t LD2412Health::update(const LD2412Frame& frame, const LD2412Stats& stats) {
+    uint32_t errors = stats.resyncs + stats.frameErrors;
+    if (!this->started) {
+        this->started = true;
+        this->last = frame;
+        this->unchangedSince = frame.timestamp;
+        this->lastErrors = errors;
+        this->gatesSaturated = false;
+        return this->active;
+    }
+    //readFrame() returns the same frame until the next one arrives, a repeat is no new frame
+    if (frame.timestamp == this->last.timestamp)
+        return this->active;
+    uint32_t elapsed = static_cast<uint32_t>(frame.timestamp - this->last.timestamp);
+
+    bool saturated = this->gatesSaturated || frame.movingEnergy >= SATURATED && frame.staticEnergy >= SATURATED;
+    this->gatesSaturated = false;
+    decay(this->rates[0], saturated ? 1000 : 0);
+
+    bool jump = false;
+    if (frame.state & 1 && this->last.state & 1) {
+        uint32_t diff = absDiff(frame.movingDistance, this->last.movingDistance);
+        //A change of one gate or less is quantisation
+        jump = diff > LD2412GateEnergies::GATE_CM && diff * 1000 > static_cast<uint32_t>(JUMP_CM_PER_S) * elapsed;
+    }
+    decay(this->rates[1], jump ? 1000 : 0);
+
+    //Mean absolute deviation of the interval, relative to the mean interval
+    int32_t interval = static_cast<int32_t>((elapsed < MAX_INTERVAL ? elapsed : MAX_INTERVAL) << 8);
+    if (this->meanInterval == 0)
+        this->meanInterval = interval;
+    int32_t deviation = interval > this->meanInterval ? interval - this->meanInterval : this->meanInterval - interval;
+    this->meanInterval += (interval - this->meanInterval) >> INTERVAL_SHIFT;
+    this->intervalDeviation += (deviation - this->intervalDeviation) >> INTERVAL_SHIFT;
+    uint32_t irregularity = this->meanInterval <= 0 ? 0 : static_cast<uint32_t>(this->intervalDeviation) * 1000 / this->meanInterval;
+    this->rates[2] = static_cast<int32_t>((irregularity < 1000 ? irregularity : 1000) << 8);
+
+    decay(this->rates[3], errors != this->lastErrors ? 1000 : 0);
+    this->lastErrors = errors;
+
+    //A live target never reports exactly the same distances and energies for long
+    bool unchanged = frame.state != 0 && frame.state == this->last.state
+        && frame.movingDistance == this->last.movingDistance && frame.movingEnergy == this->last.movingEnergy
+        && frame.staticDistance == this->last.staticDistance && frame.staticEnergy == this->last.staticEnergy;
+    if (!unchanged)
+        this->unchangedSince = frame.timestamp;
+    this->last = frame;
+
+    for (uint8_t i=0; i<SIGNATURES; i++) {
+        uint16_t value = static_cast<uint16_t>(this->rates[i] >> 8);
+        raise(BITS[i], value >= (this->active & BITS[i] ? THRESHOLDS[i] / 2 : THRESHOLDS[i]));
+    }
+    raise(STUCK, unchanged && static_cast<uint32_t>(frame.timestamp - this->unchangedSince) >= STUCK_MS);
+    return this->active;
+}
+
+uint8_t LD2412Health::score() const {
+    int penalty = this->active & STUCK ? STUCK_WEIGHT : 0;
+    for (uint8_t i=0; i<SIGNATURES; i++) {
+        uint32_t value = static_cast<uint32_t>(this->rates[i] >> 8);
+        uint32_t part = WEIGHTS[i] * value / (2 * THRESHOLDS[i]);
+        penalty += part < WEIGHTS[i] ? part : WEIGHTS[i];
+    }
+    return penalty < 100 ? 100 - penalty : 0;
+}
+
+uint8_t LD2412Health::anomalies() const {
+    return this->active;
+}
+
+uint16_t LD2412Health::rate(Anomaly anomaly) const {
+    if (anomaly == STUCK)
+        return this->active & STUCK ? 1000 : 0;
+    for (uint8_t i=0; i<SIGNATURES; i++)
+        if (BITS[i] == anomaly)
+            return static_cast<uint16_t>(this->rates[i] >> 8);
+    return 0;
+}
+
+void LD2412Health::reset() {
+    for (uint8_t i=0; i<SIGNATURES; i++)
+        this->rates[i] = 0;
+    this->active = 0;
+    this->started = false;
+    this->gatesSaturated = false;
+    this->meanInterval = 0;
+    this->intervalDeviation = 0;
+}
+
+void LD2412Health::decay(int32_t& rate, uint32_t sample) {
+    rate += (static_cast<int32_t>(sample << 8) - rate) >> RATE_SHIFT;
+}
+
+void LD2412Health::raise(uint8_t anomaly, bool on) {
+    if (on == ((this->active & anomaly) != 0))
+        return;
+    this->active ^= anomaly;
+    if (this->callback != nullptr)
+        this->callback(anomaly, on);
+}
@@ -0,0 +1,121 @@
+/**
+ * @file LD2412Health.h
+ * @author Trent Tobias
+ * @brief Flags interference and failing sensors from per-frame statistics
+ */
+
+#ifndef LD2412_HEALTH_H
+#define LD2412_HEALTH_H
+
+#include <Arduino.h>
+#include "LD2412Frame.h"
+#include "LD2412Stats.h"
+
+/**
+ * @brief Each signature is kept as an exponentially decayed per-mille rate of the frames showing it
+ * (a few integers each, no history buffer):
+ * - saturation: energy at the top of the scale on most gates, typical of a neighbouring radar
+ * - distance jumps: the target moving further between two frames than a person can
+ * - frame rate: mean absolute deviation of the frame interval relative to its mean
+ * - resyncs: new resyncs and frame errors in LD2412Stats, typical of a loose connector or noise
+ * Stuck is a target reported with every field unchanged for STUCK_MS.
+ * An anomaly is raised when its rate reaches the threshold and cleared below half of it.
+ * The health score starts at 100 and loses up to each signature's weight as its rate nears twice the threshold
+ */
+class LD2412Health {
+public:
+    enum Anomaly : uint8_t {
+        SATURATION = 0x01,
+        DISTANCE_JUMPS = 0x02,
+        STUCK = 0x04,
+        FRAME_RATE = 0x08,
+        RESYNCS = 0x10
+    };
+
+    /**
+     * @brief Called when an anomaly is raised or cleared
+     * @param anomaly Anomaly (one bit)
+     * @param active Raised or cleared
+     */
+    typedef void (*AnomalyCallback)(uint8_t anomaly, bool active);
+
+    static constexpr uint8_t RATE_SHIFT = 8;                //~256 frame time constant, 25 s at 10 Hz
+    static constexpr uint8_t SATURATED = 95;                //Energy counted as saturated
+    static constexpr uint8_t SATURATED_GATES = 7;           //Gates that have to be saturated at once
+    static constexpr uint16_t JUMP_CM_PER_S = 1000;         //Faster than anyone walks or runs indoors
+    static constexpr unsigned long STUCK_MS = 30000;
+    static constexpr uint16_t SATURATION_PERMILLE = 200;
+    static constexpr uint16_t JUMP_PERMILLE = 50;
+    static constexpr uint16_t FRAME_RATE_PERMILLE = 300;
+    static constexpr uint16_t RESYNC_PERMILLE = 20;
+
+    /**
+     * @brief Sets the function called on anomaly changes (may be nullptr)
+     */
+    void setCallback(AnomalyCallback onChange);
+
+    /**
+     * @brief Feeds the gate energies of an engineering-mode frame, before the frame itself is fed
+     * @param energies Per-gate energies, e.g. from LD2412::readGateEnergies()
+     */
+    void update(const LD2412GateEnergies& energies);
+
+    /**
+     * @brief Feeds one report frame with the link counters after it. A repeat of the frame fed
+     * last (same timestamp), as readFrame() returns until a new frame arrives, is ignored
+     * @param frame Decoded frame with its capture time
+     * @param stats Counters, e.g. from LD2412::getStats()
+     * @return Active anomalies
+     */
+    uint8_t update(const LD2412Frame& frame, const LD2412Stats& stats);
+
+    /**
+     * @brief Gets the health score
+     * @return Score (0-100), 100 when no signature shows
+     */
+    uint8_t score() const;
+
+    /**
+     * @brief Gets the active anomalies
+     * @return Anomaly bits
+     */
+    uint8_t anomalies() const;
+
+    /**
+     * @brief Gets the current rate of a signature
+     * @param anomaly Anomaly (one bit); STUCK gives 1000 while stuck, else 0
+     * @return Per mille of frames (of the interval mean for FRAME_RATE)
+     */
+    uint16_t rate(Anomaly anomaly) const;
+
+    /**
+     * @brief Forgets all rates and anomalies
+     */
+    void reset();
+
+private:
+    static constexpr uint8_t SIGNATURES = 4;                //Saturation, distance jumps, frame rate, resyncs
+
+    AnomalyCallback callback = nullptr;
+    int32_t rates[SIGNATURES] = {};                         //Per mille, 24.8 fixed point
+    uint8_t active = 0;
+    bool started = false;
+    bool gatesSaturated = false;
+    LD2412Frame last = {};
+    unsigned long unchangedSince = 0;
+    int32_t meanInterval = 0;                               //ms, 24.8 fixed point
+    int32_t intervalDeviation = 0;
+    uint32_t lastErrors = 0;
+
+    /**
+     * @brief Folds one frame's sample into a decayed rate
+     */
+    static void decay(int32_t& rate, uint32_t sample);
+
+    /**
+     * @brief Raises or clears an anomaly with hysteresis
+     */
+    void raise(uint8_t anomaly, bool on);
+};
+
+#endif //LD2412_HEALTH_H
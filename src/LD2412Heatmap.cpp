@@ -0,0 +1,154 @@
+/**
+ * @file LD2412Heatmap.cpp
+ * @author Trent Tobias
+ * @brief Per-gate occupancy heatmap
+ */
+
+#include "LD2412Heatmap.h"
+#include <stdio.h>
+
+void LD2412Heatmap::setBucketLength(unsigned long ms) {
+    this->bucketLength = ms == 0 ? 1 : ms > MAX_BUCKET_MS ? MAX_BUCKET_MS : ms;
+    this->position %= cycle();
+}
+
+void LD2412Heatmap::setTimeOffset(unsigned long ms) {
+    if (this->started)
+        this->position = (this->position + static_cast<uint32_t>(ms - this->offset) % cycle()) % cycle();
+    this->offset = ms;
+}
+
+void LD2412Heatmap::setHalvingPeriod(unsigned long ms) {
+    this->halvingPeriod = ms;
+}
+
+void LD2412Heatmap::setThresholds(uint8_t moving, uint8_t stationary) {
+    this->thresholds[MOVING] = moving;
+    this->thresholds[STATIONARY] = stationary;
+}
+
+void LD2412Heatmap::update(const LD2412Frame& frame) {
+    uint8_t bucket = advance(frame.timestamp);
+    if (frame.state & 1)
+        add(MOVING, LD2412GateEnergies::gateOf(frame.movingDistance), bucket);
+    if (frame.state & 2)
+        add(STATIONARY, LD2412GateEnergies::gateOf(frame.staticDistance), bucket);
+}
+
+void LD2412Heatmap::update(const LD2412GateEnergies& energies) {
+    uint8_t bucket = advance(energies.timestamp);
+    for (uint8_t gate=0; gate<GATES; gate++) {
+        if (energies.moving[gate] >= this->thresholds[MOVING])
+            add(MOVING, gate, bucket);
+        if (energies.stationary[gate] >= this->thresholds[STATIONARY])
+            add(STATIONARY, gate, bucket);
+    }
+}
+
+uint16_t LD2412Heatmap::count(Kind kind, uint8_t gate, uint8_t bucket) const {
+    if (kind > STATIONARY || gate >= GATES || bucket >= BUCKETS)
+        return 0;
+    return this->counts[kind][gate][bucket];
+}
+
+uint32_t LD2412Heatmap::gateTotal(Kind kind, uint8_t gate) const {
+    uint32_t total = 0;
+    for (uint8_t bucket=0; bucket<BUCKETS; bucket++)
+        total += count(kind, gate, bucket);
+    return total;
+}
+
+uint8_t LD2412Heatmap::bucketOf(unsigned long timestamp) const {
+    return static_cast<uint8_t>(positionAt(timestamp) / this->bucketLength);
+}
+
+size_t LD2412Heatmap::exportTo(Print& out) const {
+    static const char* const KINDS[] = {"moving", "static"};
+    char line[16];
+    size_t n = 0;
+
+    snprintf(line, sizeof(line), "%lu", this->bucketLength);
+    n += out.write("# ld2412 heatmap bucket_ms=");
+    n += out.write(line);
+    n += out.write("\nkind,gate");
+    for (uint8_t bucket=0; bucket<BUCKETS; bucket++) {
+        snprintf(line, sizeof(line), ",b%u", bucket);
+        n += out.write(line);
+    }
+    n += out.write("\n");
+    for (uint8_t kind=MOVING; kind<=STATIONARY; kind++)
+        for (uint8_t gate=0; gate<GATES; gate++) {
+            n += out.write(KINDS[kind]);
+            snprintf(line, sizeof(line), ",%u", gate);
+            n += out.write(line);
+            for (uint8_t bucket=0; bucket<BUCKETS; bucket++) {
+                snprintf(line, sizeof(line), ",%u", this->counts[kind][gate][bucket]);
+                n += out.write(line);
+            }
+            n += out.write("\n");
+        }
+    return n;
+}
+
+void LD2412Heatmap::reset() {
+    for (uint8_t kind=MOVING; kind<=STATIONARY; kind++)
+        for (uint8_t gate=0; gate<GATES; gate++)
+            for (uint8_t bucket=0; bucket<BUCKETS; bucket++)
+                this->counts[kind][gate][bucket] = 0;
+    //The position in the cycle is kept, the halving period starts over
+    this->lastHalving = this->lastFrame;
+}
+
+uint32_t LD2412Heatmap::cycle() const {
+    return static_cast<uint32_t>(this->bucketLength) * BUCKETS;
+}
+
+uint32_t LD2412Heatmap::positionAt(unsigned long timestamp) const {
+    const uint32_t length = cycle();
+    if (!this->started)
+        return (static_cast<uint32_t>(timestamp) % length + static_cast<uint32_t>(this->offset) % length) % length;
+    //32-bit difference from the latest frame, a little earlier counts backwards
+    uint32_t delta = static_cast<uint32_t>(timestamp - this->lastFrame);
+    if (delta >= 0x80000000UL)
+        return (this->position + length - (0 - delta) % length) % length;
+    return (this->position + delta % length) % length;
+}
+
+uint8_t LD2412Heatmap::advance(unsigned long timestamp) {
+    bool first = !this->started;
+    this->position = positionAt(timestamp);
+    this->lastFrame = timestamp;
+    age(timestamp);
+
+    uint8_t bucket = static_cast<uint8_t>(this->position / this->bucketLength);
+    if (first || bucket != this->countBucket || static_cast<uint32_t>(timestamp - this->countStart) >= COUNT_MS) {
+        this->counted[MOVING] = 0;
+        this->counted[STATIONARY] = 0;
+        this->countStart = timestamp;
+        this->countBucket = bucket;
+    }
+    return bucket;
+}
+
+void LD2412Heatmap::age(unsigned long now) {
+    if (!this->started) {
+        this->started = true;
+        this->lastHalving = now;
+        return;
+    }
+    if (this->halvingPeriod == 0 || static_cast<uint32_t>(now - this->lastHalving) < this->halvingPeriod)
+        return;
+    this->lastHalving = now;
+    for (uint8_t kind=MOVING; kind<=STATIONARY; kind++)
+        for (uint8_t gate=0; gate<GATES; gate++)
+            for (uint8_t bucket=0; bucket<BUCKETS; bucket++)
+                this->counts[kind][gate][bucket] /= 2;
+}
+
+void LD2412Heatmap::add(Kind kind, uint8_t gate, uint8_t bucket) {
+    if (this->counted[kind] & 1u << gate)
+        return;
+    this->counted[kind] |= 1u << gate;
+    if (this->counts[kind][gate][bucket] != UINT16_MAX)
+        this->counts[kind][gate][bucket]++;
+}
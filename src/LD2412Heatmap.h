@@ -0,0 +1,152 @@
+/**
+ * @file LD2412Heatmap.h
+ * @author Trent Tobias
+ * @brief Counts where in the beam and when targets are seen, per distance gate and time bucket
+ */
+
+#ifndef LD2412_HEATMAP_H
+#define LD2412_HEATMAP_H
+
+#include <Arduino.h>
+#include "LD2412Frame.h"
+
+/**
+ * @brief One saturating 16-bit counter per kind (moving/static), gate and time bucket: 1344 bytes
+ * of RAM, most of the 2 kB of an ATmega328, so small AVR boards are better off exporting frames to
+ * a gateway. A frame counts at the gates of its reported distances; an engineering-mode frame counts
+ * at every gate whose energy reaches the threshold. A gate counts at most once per second, so the
+ * counters are seconds with a target there. Time buckets repeat every BUCKETS buckets,
+ * with the default 1 h buckets and a time offset to midnight they are the hours of the day. The
+ * position in that cycle advances by the time between frames, so it stays right across the
+ * millis() rollover.
+ * Every counter is halved once per halving period, so old activity fades. A 1 h bucket gains at
+ * most 3600 a day, which weekly halving keeps below 50400: the defaults never saturate. Longer
+ * buckets need a shorter halving period
+ */
+class LD2412Heatmap {
+public:
+    enum Kind : uint8_t {
+        MOVING,
+        STATIONARY
+    };
+
+    static constexpr unsigned int GATES = LD2412GateEnergies::GATES;
+    static constexpr unsigned int BUCKETS = 24;
+    static constexpr unsigned long BUCKET_MS = 3600000;             //Default bucket length
+    static constexpr unsigned long HALVING_MS = 7 * 24 * 3600000UL; //Default halving period
+    static constexpr unsigned long MAX_BUCKET_MS = 0x7FFFFFFFUL / BUCKETS;    //Keeps the cycle position in 32 bits
+    static constexpr unsigned long COUNT_MS = 1000;                 //A gate counts at most once per this
+
+    /**
+     * @brief Sets the length of a time bucket
+     * @param ms Bucket length (default: 1 h, at most MAX_BUCKET_MS)
+     */
+    void setBucketLength(unsigned long ms);
+
+    /**
+     * @brief Sets what to add to frame timestamps to get the time since the start of bucket 0,
+     * e.g. the time of day in ms at millis() = 0 (default: 0). Changing it later shifts the
+     * current position by the difference
+     */
+    void setTimeOffset(unsigned long ms);
+
+    /**
+     * @brief Sets how often every counter is halved
+     * @param ms Halving period, 0 never (default: 7 days)
+     */
+    void setHalvingPeriod(unsigned long ms);
+
+    /**
+     * @brief Sets the energies at which a gate of an engineering-mode frame counts
+     * @param moving Moving energy (default: 30)
+     * @param stationary Static energy (default: 30)
+     */
+    void setThresholds(uint8_t moving, uint8_t stationary);
+
+    /**
+     * @brief Counts a report frame at the gates of its moving and static target
+     * @param frame Decoded frame with its capture time
+     */
+    void update(const LD2412Frame& frame);
+
+    /**
+     * @brief Counts an engineering-mode frame at every gate whose energy reaches the threshold
+     * @param energies Per-gate energies, e.g. from LD2412::readGateEnergies()
+     */
+    void update(const LD2412GateEnergies& energies);
+
+    /**
+     * @brief Gets one counter
+     * @param kind Moving or static
+     * @param gate Distance gate (0-13)
+     * @param bucket Time bucket (0-23)
+     * @return Count, 0 if out of range
+     */
+    uint16_t count(Kind kind, uint8_t gate, uint8_t bucket) const;
+
+    /**
+     * @brief Gets a gate's count over all time buckets
+     */
+    uint32_t gateTotal(Kind kind, uint8_t gate) const;
+
+    /**
+     * @brief Gets the time bucket a timestamp falls in, counted from the latest frame
+     * @param timestamp millis()
+     */
+    uint8_t bucketOf(unsigned long timestamp) const;
+
+    /**
+     * @brief Writes the counters as CSV for commissioning tools: a comment line with the bucket
+     * length, a header, then one row per kind and gate with its count per bucket
+     * @param out Serial port, file or socket
+     * @return Bytes written
+     */
+    size_t exportTo(Print& out) const;
+
+    /**
+     * @brief Clears every counter, keeping the position in the bucket cycle
+     */
+    void reset();
+
+private:
+    uint16_t counts[2][GATES][BUCKETS] = {};
+    unsigned long bucketLength = BUCKET_MS;
+    unsigned long offset = 0;
+    unsigned long halvingPeriod = HALVING_MS;
+    uint8_t thresholds[2] = {30, 30};
+    bool started = false;
+    unsigned long lastHalving = 0;
+    uint32_t position = 0;                  //Time since the start of bucket 0 at lastFrame, within the cycle
+    unsigned long lastFrame = 0;
+    uint16_t counted[2] = {};               //Gates already counted in the current second, one bit each
+    unsigned long countStart = 0;
+    uint8_t countBucket = 0;
+
+    /**
+     * @brief Length of the bucket cycle
+     */
+    uint32_t cycle() const;
+
+    /**
+     * @brief Position in the bucket cycle at a timestamp, from the one at the latest frame
+     */
+    uint32_t positionAt(unsigned long timestamp) const;
+
+    /**
+     * @brief Moves the position to a frame's timestamp and gets its bucket. Starts a new count
+     * window after COUNT_MS or in a new bucket
+     */
+    uint8_t advance(unsigned long timestamp);
+
+    /**
+     * @brief Halves every counter when the period is over
+     */
+    void age(unsigned long now);
+
+    /**
+     * @brief Adds one to a counter unless the gate was counted in this window or it is saturated
+     */
+    void add(Kind kind, uint8_t gate, uint8_t bucket);
+};
+
+#endif //LD2412_HEATMAP_H
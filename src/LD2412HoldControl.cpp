@@ -0,0 +1,109 @@
+/**
+ * @file LD2412HoldControl.cpp
+ * @author Trent Tobias
+ * @brief Confidence-driven hold time
+ */
+
+#include "LD2412HoldControl.h"
+#include "LD2412.h"
+
+void LD2412HoldControl::setCallback(OccupancyCallback onChange) {
+    this->callback = onChange;
+}
+
+void LD2412HoldControl::setHoldRange(unsigned long minMs, unsigned long maxMs) {
+    this->minHold = minMs;
+    this->maxHold = maxMs > minMs ? maxMs : minMs;
+}
+
+void LD2412HoldControl::setModuleDuration(uint8_t seconds) {
+    this->moduleDuration = seconds;
+}
+
+bool LD2412HoldControl::update(const LD2412Frame& frame) {
+    uint8_t score = this->scorer.update(frame);
+    if (frame.state != 0) {
+        //The history weighs three times the latest score, so a run has to last to be trusted and
+        //one weak frame at its end does not decide the hold. Rounded towards the score so it is reached
+        this->conf = static_cast<uint8_t>((this->conf * 3 + score + (score > this->conf ? 3 : 0)) / 4);
+        this->lastSeen = frame.timestamp;
+        if (this->vacancyPending) {
+            this->vacancyPending = false;
+            if (static_cast<uint32_t>(frame.timestamp - this->vacantSince) < RETURN_MS)
+                this->holdBias = this->holdBias + BIAS_STEP < 100 ? this->holdBias + BIAS_STEP : 100;
+        }
+        if (!this->present)
+            change(true);
+        return true;
+    }
+
+    if (this->present) {
+        unsigned long hold = holdTime();
+        unsigned long module = this->moduleDuration * 1000UL;
+        if (static_cast<uint32_t>(frame.timestamp - this->lastSeen) >= (hold > module ? hold - module : 0)) {
+            this->typicalHold = this->typicalHold == 0 ? hold : (this->typicalHold * 3 + hold) / 4;
+            this->vacancyPending = true;
+            this->vacantSince = frame.timestamp;
+            this->conf = 0;
+            change(false);
+        }
+    }
+    else if (this->vacancyPending && static_cast<uint32_t>(frame.timestamp - this->vacantSince) >= RETURN_MS) {
+        this->vacancyPending = false;
+        this->holdBias -= this->holdBias < BIAS_DECAY ? this->holdBias : BIAS_DECAY;
+    }
+    return this->present;
+}
+
+int LD2412HoldControl::sync(LD2412& radar, unsigned long now) {
+    if (this->typicalHold == 0)
+        return 0;
+    uint8_t target = recommendedDuration();
+    int diff = target > this->moduleDuration ? target - this->moduleDuration : this->moduleDuration - target;
+    if (diff < PUSH_STEP_S)
+        return 0;
+    if (this->pushed && static_cast<uint32_t>(now - this->lastPush) < PUSH_INTERVAL_MS)
+        return 0;
+    //Failures count against the rate limit too, a missing module is not retried every loop
+    this->pushed = true;
+    this->lastPush = now;
+    if (!radar.setUnmannedDuration(target))
+        return -1;
+    this->moduleDuration = target;
+    return 1;
+}
+
+bool LD2412HoldControl::occupied() const {
+    return this->present;
+}
+
+uint8_t LD2412HoldControl::confidence() const {
+    return this->conf;
+}
+
+LD2412Confidence& LD2412HoldControl::scoring() {
+    return this->scorer;
+}
+
+unsigned long LD2412HoldControl::holdTime() const {
+    unsigned long range = this->maxHold - this->minHold;
+    unsigned long hold = this->minHold + range / 100 * (100 - this->conf) + range / 100 * this->holdBias;
+    return hold < this->maxHold ? hold : this->maxHold;
+}
+
+uint8_t LD2412HoldControl::recommendedDuration() const {
+    if (this->typicalHold == 0)
+        return this->moduleDuration;
+    unsigned long seconds = (this->typicalHold + 500) / 1000;
+    return seconds < 255 ? static_cast<uint8_t>(seconds) : 255;
+}
+
+uint8_t LD2412HoldControl::bias() const {
+    return this->holdBias;
+}
+
+void LD2412HoldControl::change(bool occupied) {
+    this->present = occupied;
+    if (this->callback != nullptr)
+        this->callback(occupied);
+}
@@ -0,0 +1,137 @@
+/**
+ * @file LD2412HoldControl.h
+ * @author Trent Tobias
+ * @brief Software hold time that follows how confidently presence was seen, instead of the
+ * module's fixed unmanned duration
+ */
+
+#ifndef LD2412_HOLD_CONTROL_H
+#define LD2412_HOLD_CONTROL_H
+
+#include <Arduino.h>
+#include "LD2412Confidence.h"
+#include "LD2412Frame.h"
+
+class LD2412;
+
+/**
+ * @brief While a target is reported, every frame is scored by LD2412Confidence (energy above the
+ * sensitivities, persistence, distance stability) and the scores are averaged into the presence
+ * confidence, so the whole run counts rather than its last frame. When the target is lost the room stays occupied for a
+ * hold time between the minimum (confident presence, e.g. someone walking out) and the maximum
+ * (weak, flickering presence such as a still person at the edge of detection).
+ * Presence coming back within RETURN_MS of a vacancy means the hold was too short, and a bias
+ * lengthens the following ones; every vacancy that holds shortens it again.
+ * The module's own unmanned duration already delays the loss, so it is taken off the software hold
+ */
+class LD2412HoldControl {
+public:
+    /**
+     * @brief Called when occupancy changes
+     * @param occupied New occupancy
+     */
+    typedef void (*OccupancyCallback)(bool occupied);
+
+    static constexpr unsigned long MIN_HOLD_MS = 5000;          //Default hold after confident presence
+    static constexpr unsigned long MAX_HOLD_MS = 120000;        //Default hold after weak presence
+    static constexpr unsigned long RETURN_MS = 30000;           //Presence back sooner means the vacancy was premature
+    static constexpr uint8_t BIAS_STEP = 20;                    //Percent of the hold range added per premature vacancy
+    static constexpr uint8_t BIAS_DECAY = 5;                    //Percent taken off per vacancy that holds
+    static constexpr unsigned long PUSH_INTERVAL_MS = 600000;   //Least time between two duration updates on the module
+    static constexpr uint8_t PUSH_STEP_S = 10;                  //Change in the typical hold worth an update
+
+    /**
+     * @brief Sets the function called on occupancy changes (may be nullptr)
+     */
+    void setCallback(OccupancyCallback onChange);
+
+    /**
+     * @brief Sets the hold time range
+     * @param minMs Hold after fully confident presence
+     * @param maxMs Hold after the weakest presence
+     */
+    void setHoldRange(unsigned long minMs, unsigned long maxMs);
+
+    /**
+     * @brief Sets the unmanned duration the module runs with, taken off the software hold
+     * (default: 0, sync() keeps it up to date)
+     * @param seconds Module unmanned duration
+     */
+    void setModuleDuration(uint8_t seconds);
+
+    /**
+     * @brief Feeds one report frame, e.g. from LD2412::readFrame()
+     * @param frame Decoded frame with its capture time
+     * @return Occupancy after this frame
+     */
+    bool update(const LD2412Frame& frame);
+
+    /**
+     * @brief Pushes the typical hold time to the module as its unmanned duration when it moved
+     * by PUSH_STEP_S or more, at most once per PUSH_INTERVAL_MS and in a single configuration session.
+     * Useful when the OUT pin drives the load directly
+     * @param radar Module to configure
+     * @param now Current time
+     * @return 1 if the duration was updated, 0 if nothing was due, -1 on a command failure
+     */
+    int sync(LD2412& radar, unsigned long now);
+
+    /**
+     * @brief Gets the occupancy
+     */
+    bool occupied() const;
+
+    /**
+     * @brief Gets the presence confidence: the scores of the frames with a target, averaged with the
+     * latest weighing a quarter
+     * @return Confidence (0-100)
+     */
+    uint8_t confidence() const;
+
+    /**
+     * @brief Gets the confidence score the hold follows, e.g. to load the module's sensitivities into it
+     */
+    LD2412Confidence& scoring();
+
+    /**
+     * @brief Gets the hold time that applies when the target is lost now, including the module's duration
+     * @return Hold time in ms
+     */
+    unsigned long holdTime() const;
+
+    /**
+     * @brief Gets the unmanned duration sync() aims for
+     * @return Duration in seconds
+     */
+    uint8_t recommendedDuration() const;
+
+    /**
+     * @brief Gets the bias added after premature vacancies
+     * @return Percent of the hold range
+     */
+    uint8_t bias() const;
+
+private:
+    OccupancyCallback callback = nullptr;
+    unsigned long minHold = MIN_HOLD_MS;
+    unsigned long maxHold = MAX_HOLD_MS;
+    uint8_t moduleDuration = 0;
+
+    LD2412Confidence scorer;
+    bool present = false;
+    uint8_t conf = 0;
+    unsigned long lastSeen = 0;
+    uint8_t holdBias = 0;
+    bool vacancyPending = false;
+    unsigned long vacantSince = 0;
+    unsigned long typicalHold = 0;
+    bool pushed = false;
+    unsigned long lastPush = 0;
+
+    /**
+     * @brief Notifies an occupancy change
+     */
+    void change(bool occupied);
+};
+
+#endif //LD2412_HOLD_CONTROL_H
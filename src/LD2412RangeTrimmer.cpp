@@ -0,0 +1,106 @@
+/**
+ * @file LD2412RangeTrimmer.cpp
+ * @author Trent Tobias
+ * @brief Automatic min/max gate trimming
+ */
+
+#include "LD2412RangeTrimmer.h"
+#include "LD2412.h"
+
+void LD2412RangeTrimmer::setPeriod(unsigned long ms) {
+    this->period = ms;
+}
+
+void LD2412RangeTrimmer::update(const LD2412ClutterMap& map, unsigned long now) {
+    if (!this->started) {
+        this->started = true;
+        this->lastEvaluation = now;
+    }
+    //Learning frames say nothing about targets
+    if (!map.learned())
+        return;
+    if (this->frames == UINT16_MAX)
+        decay();
+    this->frames++;
+    for (uint8_t gate=0; gate<GATES; gate++) {
+        if (map.gateActive(gate))
+            this->active[gate]++;
+        if (map.movingBackground(gate) >= REFLECTION_LEVEL || map.staticBackground(gate) >= REFLECTION_LEVEL)
+            this->reflecting[gate]++;
+    }
+}
+
+bool LD2412RangeTrimmer::recommend(uint8_t& min, uint8_t& max) const {
+    if (this->frames < MIN_FRAMES)
+        return false;
+    uint8_t low = MIN_GATE;
+    uint8_t high = MAX_GATE;
+    while (high - low + 1 > MIN_SPAN && trimmable(high))
+        high--;
+    while (high - low + 1 > MIN_SPAN && trimmable(low))
+        low++;
+    min = low;
+    max = high;
+    return true;
+}
+
+bool LD2412RangeTrimmer::due(unsigned long now) const {
+    return this->started && this->period != 0 && static_cast<uint32_t>(now - this->lastEvaluation) >= this->period;
+}
+
+int LD2412RangeTrimmer::evaluate(LD2412& radar, bool apply, unsigned long now) {
+    this->lastEvaluation = now;
+    this->started = true;
+    uint8_t min, max;
+    if (!recommend(min, max))
+        return 0;
+    decay();
+
+    const int* params = radar.getParamConfig();
+    if (params == nullptr)
+        return -1;
+    if (params[0] == min && params[1] == max)
+        return 0;
+    if (apply && !radar.setParamConfig(min, max, static_cast<uint8_t>(params[2]), static_cast<uint8_t>(params[4])))
+        return -1;
+    return 1;
+}
+
+uint16_t LD2412RangeTrimmer::activity(uint8_t gate) const {
+    if (gate >= GATES || this->frames == 0)
+        return 0;
+    return static_cast<uint32_t>(this->active[gate]) * 1000 / this->frames;
+}
+
+uint16_t LD2412RangeTrimmer::reflection(uint8_t gate) const {
+    if (gate >= GATES || this->frames == 0)
+        return 0;
+    return static_cast<uint32_t>(this->reflecting[gate]) * 1000 / this->frames;
+}
+
+void LD2412RangeTrimmer::reset() {
+    this->frames = 0;
+    for (uint8_t gate=0; gate<GATES; gate++) {
+        this->active[gate] = 0;
+        this->reflecting[gate] = 0;
+    }
+    this->started = false;
+}
+
+bool LD2412RangeTrimmer::trimmable(uint8_t gate) const {
+    uint16_t targets = activity(gate);
+    //Dead zone: beyond a wall or below the mounting height nobody is ever seen
+    if (targets < ACTIVE_PERMILLE)
+        return true;
+    //Reflection: a surface keeps the background high and the few targets are mostly its ghosts
+    return reflection(gate) >= 500 && targets < REFLECTION_ACTIVE_PERMILLE;
+}
+
+void LD2412RangeTrimmer::decay() {
+    //Halved rather than cleared, so the next evaluation still weighs the older history
+    this->frames = (this->frames + 1) / 2;
+    for (uint8_t gate=0; gate<GATES; gate++) {
+        this->active[gate] /= 2;
+        this->reflecting[gate] /= 2;
+    }
+}
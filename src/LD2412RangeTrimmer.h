@@ -0,0 +1,111 @@
+/**
+ * @file LD2412RangeTrimmer.h
+ * @author Trent Tobias
+ * @brief Narrows the module's min/max gates to the part of the range where targets are actually seen
+ */
+
+#ifndef LD2412_RANGE_TRIMMER_H
+#define LD2412_RANGE_TRIMMER_H
+
+#include <Arduino.h>
+#include "LD2412ClutterMap.h"
+
+class LD2412;
+
+/**
+ * @brief Counts, for every gate, the frames in which the clutter map found a target there and
+ * the frames in which its background was at reflection level. Edge gates that are dead (no
+ * target in ACTIVE_PERMILLE of the frames) or dominated by a reflection (reflection level in
+ * most frames and few targets) are trimmed from either end of the range, so the module's own
+ * processing ignores them instead of every frame being filtered afterwards.
+ * Counts are halved at each evaluation, so a changed room shows up within a few periods
+ */
+class LD2412RangeTrimmer {
+public:
+    static constexpr unsigned int GATES = LD2412GateEnergies::GATES;
+    static constexpr uint8_t MIN_GATE = 1;                  //Lowest gate setParamConfig() accepts
+    static constexpr uint8_t MAX_GATE = GATES - 1;
+    static constexpr uint8_t MIN_SPAN = 2;                  //Gates always kept
+    static constexpr uint16_t MIN_FRAMES = 6000;            //10 min at 10 Hz before a recommendation
+    static constexpr unsigned long PERIOD_MS = 3600000;     //Default re-evaluation period
+    static constexpr uint8_t REFLECTION_LEVEL = 40;         //Background energy of a reflecting surface
+    static constexpr uint16_t ACTIVE_PERMILLE = 1;          //Target share below which a gate is dead
+    static constexpr uint16_t REFLECTION_ACTIVE_PERMILLE = 20;  //Target share below which a reflecting gate is trimmed
+
+    /**
+     * @brief Sets how often due() asks for a new evaluation
+     * @param ms Period, 0 never
+     */
+    void setPeriod(unsigned long ms);
+
+    /**
+     * @brief Feeds the clutter map after it was updated with a frame
+     * @param map Clutter map
+     * @param now Capture time of the frame
+     */
+    void update(const LD2412ClutterMap& map, unsigned long now);
+
+    /**
+     * @brief Gets the trimmed range from the statistics so far
+     * @param min Gets the recommended minimum gate
+     * @param max Gets the recommended maximum gate
+     * @return True if enough frames were seen
+     */
+    bool recommend(uint8_t& min, uint8_t& max) const;
+
+    /**
+     * @brief Whether the period since the last evaluation is over
+     * @param now Current time
+     */
+    bool due(unsigned long now) const;
+
+    /**
+     * @brief Compares the recommendation with the module's range and optionally applies it, keeping
+     * the duration and output polarity. Halves the statistics and restarts the period
+     * @param radar Module to read and configure
+     * @param apply Whether to write a changed range to the module
+     * @param now Current time
+     * @return 1 if the recommended range differs from the module's (and was applied if requested),
+     * 0 if it is the same or there is no recommendation yet, -1 on a command failure
+     */
+    int evaluate(LD2412& radar, bool apply, unsigned long now);
+
+    /**
+     * @brief Gets a gate's share of frames with a target
+     * @param gate Distance gate (0-13)
+     * @return Per mille of frames, 0 before the first frame
+     */
+    uint16_t activity(uint8_t gate) const;
+
+    /**
+     * @brief Gets a gate's share of frames with its background at reflection level
+     * @param gate Distance gate (0-13)
+     * @return Per mille of frames, 0 before the first frame
+     */
+    uint16_t reflection(uint8_t gate) const;
+
+    /**
+     * @brief Forgets all statistics
+     */
+    void reset();
+
+private:
+    uint16_t frames = 0;
+    uint16_t active[GATES] = {};
+    uint16_t reflecting[GATES] = {};
+    unsigned long period = PERIOD_MS;
+    unsigned long lastEvaluation = 0;
+    bool started = false;
+
+    /**
+     * @brief Whether an edge gate can be cut off the range
+     */
+    bool trimmable(uint8_t gate) const;
+
+    /**
+     * @brief Halves all counts
+     */
+    void decay();
+};
+
+#endif //LD2412_RANGE_TRIMMER_H
@@ -0,0 +1,28 @@
+/**
+ * @file LD2412Stats.cpp
+ * @author Trent Tobias
+ * @brief Link health counters
+ */
+
+#include "LD2412Stats.h"
+
+void LD2412Stats::countFrame(unsigned long now) {
+    if (this->frames > 0) {
+        uint32_t interval = now - this->lastFrame;
+        unsigned int b = 0;
+        while (b < INTERVAL_BUCKETS - 1 && interval > INTERVAL_BOUNDS[b])
+            b++;
+        this->frameInterval[b]++;
+        this->frameIntervalSum += interval;
+    }
+    this->frames++;
+    this->lastFrame = now;
+}
+
+void LD2412Stats::countAck(unsigned long latency) {
+    unsigned int b = 0;
+    while (b < ACK_BUCKETS - 1 && latency > ACK_BOUNDS[b])
+        b++;
+    this->ackLatency[b]++;
+    this->ackLatencySum += latency;
+}
@@ -0,0 +1,47 @@
+/**
+ * @file LD2412Stats.h
+ * @author Trent Tobias
+ * @brief Link health counters kept by LD2412 while it parses reports and commands
+ */
+
+#ifndef LD2412_STATS_H
+#define LD2412_STATS_H
+
+#include <Arduino.h>
+
+/**
+ * @brief Monotonic counters and fixed-bucket histograms. Counters wrap at 2^32, which
+ * scrapers treat like a counter reset
+ */
+struct LD2412Stats {
+    static constexpr unsigned int ACK_BUCKETS = 5;
+    static constexpr unsigned int INTERVAL_BUCKETS = 6;
+    //Bucket upper bounds in ms; the last bucket holds everything above
+    static constexpr unsigned long ACK_BOUNDS[ACK_BUCKETS - 1] = {25, 50, 100, 200};
+    static constexpr unsigned long INTERVAL_BOUNDS[INTERVAL_BUCKETS - 1] = {50, 100, 200, 500, 1000};
+
+    uint32_t frames = 0;                            //Report frames captured
+    uint32_t resyncs = 0;                           //Reads that had to skip bytes to find a frame header
+    uint32_t frameErrors = 0;                       //Frames dropped on a bad footer
+    uint32_t ackTimeouts = 0;                       //Commands that got no response in time
+    uint32_t ackErrors = 0;                         //Responses that failed verification
+    uint32_t ackLatency[ACK_BUCKETS] = {};          //Command round trip, ms
+    uint32_t ackLatencySum = 0;
+    uint32_t frameInterval[INTERVAL_BUCKETS] = {};  //Time between consecutive frames, ms
+    uint32_t frameIntervalSum = 0;
+    unsigned long lastFrame = 0;                    //millis() of the latest frame
+
+    /**
+     * @brief Counts a captured frame and the interval since the previous one
+     * @param now millis() at capture
+     */
+    void countFrame(unsigned long now);
+
+    /**
+     * @brief Counts a verified command response
+     * @param latency Round trip in ms
+     */
+    void countAck(unsigned long latency);
+};
+
+#endif //LD2412_STATS_H
@@ -0,0 +1,103 @@
+/**
+ * @file TestFeed.h
+ * @author Trent Tobias
+ * @brief Shared fixtures for the analytics tests: callback recorder, virtual frame clock and
+ * synthetic module noise
+ */
+
+#ifndef LD2412_TEST_FEED_H
+#define LD2412_TEST_FEED_H
+
+#include <LD2412Frame.h>
+
+#include <cstddef>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace test {
+    /**
+     * @brief Collects the calls of a plain function-pointer callback, one Event built from the
+     * arguments of each. Pass record to setCallback(); constructing a recorder clears the calls
+     * seen so far, so each fixture starts empty
+     */
+    template <typename Event>
+    class Recorder {
+    public:
+        Recorder() {
+            calls().clear();
+        }
+
+        template <typename... Args>
+        static void record(Args... args) {
+            calls().push_back(Event{args...});
+        }
+
+        size_t size() const { return calls().size(); }
+        bool empty() const { return calls().empty(); }
+        typename std::vector<Event>::const_reference operator[](size_t i) const { return calls()[i]; }
+        typename std::vector<Event>::const_iterator begin() const { return calls().begin(); }
+        typename std::vector<Event>::const_iterator end() const { return calls().end(); }
+
+    private:
+        static std::vector<Event>& calls() {
+            static std::vector<Event> all;
+            return all;
+        }
+    };
+
+    /**
+     * @brief Virtual frame clock: stamps each frame with the current time and hands it to the
+     * module under test, 10 Hz unless told otherwise
+     */
+    class FrameFeed {
+    public:
+        static constexpr unsigned long PERIOD = 100;
+        unsigned long now = 1000;
+
+        explicit FrameFeed(std::function<void(const LD2412Frame&)> sink) : sink(std::move(sink)) {}
+
+        void frame(LD2412Frame f, unsigned long interval = PERIOD) {
+            f.timestamp = this->now;
+            this->sink(f);
+            this->now += interval;
+        }
+
+        //Frames without a target for ms
+        void idle(unsigned long ms) {
+            for (unsigned long t = 0; t < ms; t += PERIOD)
+                frame({0, 0, 0, 0, 0, 0});
+        }
+
+    private:
+        std::function<void(const LD2412Frame&)> sink;
+    };
+
+    //Repeating energy wobble of the module, +-4
+    inline int wobble(unsigned int i) {
+        static const int PATTERN[] = {0, 3, -2, 4, -3, 1, -4, 2};
+        return PATTERN[i % 8];
+    }
+
+    //Repeating range jitter of the module, +-8 cm
+    inline int jitter(unsigned int i) {
+        static const int PATTERN[] = {3, -5, 8, -2, -7, 4, 0, 6, -8, 1, 5, -3};
+        return PATTERN[i % 12];
+    }
+
+    /**
+     * @brief Engineering-mode energies of frame n (10 Hz) of an empty room: every gate near the
+     * given levels, wobbling from frame to frame and gate to gate
+     */
+    inline LD2412GateEnergies background(unsigned int n, int moving, int stationary) {
+        LD2412GateEnergies e = {};
+        for (unsigned int g = 0; g < LD2412GateEnergies::GATES; g++) {
+            e.moving[g] = static_cast<uint8_t>(moving + wobble(n + g) / 2);
+            e.stationary[g] = static_cast<uint8_t>(stationary + wobble(n + 3 * g) / 2);
+        }
+        e.timestamp = n * FrameFeed::PERIOD;
+        return e;
+    }
+}
+
+#endif //LD2412_TEST_FEED_H
@@ -0,0 +1,59 @@
+/**
+ * @file TestHarness.h
+ * @author Trent Tobias
+ * @brief Minimal self-registering test harness for the host test executable
+ */
+
+#ifndef LD2412_TEST_HARNESS_H
+#define LD2412_TEST_HARNESS_H
+
+#include <cstdio>
+#include <functional>
+#include <vector>
+
+namespace test {
+    struct Case {
+        const char* name;
+        std::function<void()> run;
+    };
+
+    inline std::vector<Case>& registry() {
+        static std::vector<Case> cases;
+        return cases;
+    }
+
+    inline int& failures() {
+        static int count = 0;
+        return count;
+    }
+
+    struct Registrar {
+        Registrar(const char* name, std::function<void()> run) {
+            registry().push_back({name, std::move(run)});
+        }
+    };
+
+    inline void fail(const char* file, int line, const char* expr) {
+        std::printf("  FAILED %s:%d: %s\n", file, line, expr);
+        failures()++;
+    }
+}
+
+#define TEST_CONCAT_(a, b) a##b
+#define TEST_CONCAT(a, b) TEST_CONCAT_(a, b)
+
+//Defines and registers a test case
+#define TEST(name)                                                          \
+    static void TEST_CONCAT(test_, name)();                                 \
+    static test::Registrar TEST_CONCAT(registrar_, name)(#name, TEST_CONCAT(test_, name)); \
+    static void TEST_CONCAT(test_, name)()
+
+//Records a failure and keeps going
+#define CHECK(expr)                                                         \
+    do { if (!(expr)) test::fail(__FILE__, __LINE__, #expr); } while (0)
+
+//Records a failure and leaves the test case
+#define REQUIRE(expr)                                                       \
+    do { if (!(expr)) { test::fail(__FILE__, __LINE__, #expr); return; } } while (0)
+
+#endif //LD2412_TEST_HARNESS_H
@@ -0,0 +1,101 @@
+/**
+ * @file test_calibration.cpp
+ * @author Trent Tobias
+ * @brief Non-blocking calibration job against the simulated module
+ */
+
+#include "TestHarness.h"
+
+#include <LD2412.h>
+#include <SimulatedSensor.h>
+
+namespace {
+    int completions = 0;
+    bool lastResult = false;
+
+    void onCalibrated(bool success) {
+        completions++;
+        lastResult = success;
+    }
+}
+
+TEST(calibration_job_completes_with_backoff) {
+    MemoryStream stream;
+    SimulatedSensor sensor(stream);
+    LD2412 radar(stream);
+    completions = 0;
+
+    REQUIRE(radar.startCalibration(onCalibrated));
+    CHECK(!radar.startCalibration(onCalibrated));
+    unsigned int sessionsAfterTrigger = sensor.configSessions;
+    unsigned long started = millis();
+
+    //A 10 ms loop() for two minutes of virtual time
+    unsigned long busyLoops = 0;
+    while (millis() - started < 120000) {
+        unsigned int before = sensor.commands;
+        radar.updateCalibration();
+        if (sensor.commands != before)
+            busyLoops++;
+        delay(10);
+    }
+
+    CHECK(completions == 1);
+    CHECK(lastResult);
+    CHECK(!radar.calibrationRunning());
+    //Calibration runs 10-40 s after the trigger; back-off keeps polls to a handful
+    CHECK(busyLoops == sensor.configSessions - sessionsAfterTrigger);
+    CHECK(busyLoops >= 3 && busyLoops <= 8);
+    CHECK(!sensor.configMode());
+}
+
+TEST(calibration_job_waits_for_a_late_start) {
+    MemoryStream stream;
+    SimulatedSensor sensor(stream);
+    sensor.calibrationDelayUs = 25000000;
+    LD2412 radar(stream);
+    completions = 0;
+
+    //The first poll, 11 s in, finds the module not calibrating yet
+    REQUIRE(radar.startCalibration(onCalibrated));
+    while (radar.updateCalibration())
+        delay(10);
+    CHECK(completions == 1);
+    CHECK(lastResult);
+    //Only after the module actually calibrated
+    REQUIRE(sensor.calibrationStart != 0);
+    CHECK(host::nowMicros() >= sensor.calibrationStart + sensor.calibrationUs);
+}
+
+TEST(calibration_job_fails_if_calibration_never_starts) {
+    MemoryStream stream;
+    SimulatedSensor sensor(stream);
+    sensor.calibrationDelayUs = 1000000000;
+    LD2412 radar(stream);
+    completions = 0;
+
+    REQUIRE(radar.startCalibration(onCalibrated));
+    unsigned long started = millis();
+    while (radar.updateCalibration())
+        delay(10);
+    CHECK(completions == 1);
+    CHECK(!lastResult);
+    CHECK(millis() - started >= 300000);
+}
+
+TEST(calibration_job_fails_without_module) {
+    MemoryStream stream;
+    SimulatedSensor sensor(stream);
+    LD2412 radar(stream);
+    completions = 0;
+
+    REQUIRE(radar.startCalibration(onCalibrated));
+    //Module stops answering after the trigger
+    stream.onWrite(nullptr);
+    while (radar.updateCalibration())
+        delay(100);
+
+    CHECK(completions == 1);
+    CHECK(!lastResult);
+    CHECK(millis() < 60000);
+}
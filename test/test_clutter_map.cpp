@@ -0,0 +1,151 @@
+/**
+ * @file test_clutter_map.cpp
+ * @author Trent Tobias
+ * @brief Engineering-mode frames and the per-gate clutter map built on their energies
+ */
+
+#include "TestFeed.h"
+#include "TestHarness.h"
+
+#include <LD2412.h>
+#include <LD2412ClutterMap.h>
+#include <SimulatedSensor.h>
+
+namespace {
+    //Office with a desk fan (static energy, gate 3) and a monitor (moving energy, gate 1)
+    LD2412GateEnergies office(unsigned int n) {
+        LD2412GateEnergies e = test::background(n, 8, 7);
+        e.stationary[3] = static_cast<uint8_t>(45 + test::wobble(n));
+        e.moving[1] = static_cast<uint8_t>(22 + test::wobble(n + 5));
+        return e;
+    }
+
+    LD2412ClutterMap learnedOffice(unsigned int frames = 600) {
+        LD2412ClutterMap map;
+        for (unsigned int n = 0; n < frames; n++)
+            map.update(office(n));
+        return map;
+    }
+}
+
+TEST(engineering_mode_frames_decode) {
+    for (bool lazy : {false, true}) {
+        MemoryStream stream;
+        SimulatedSensor sensor(stream);
+        LD2412 radar(stream);
+        radar.setLazyDecode(lazy);
+        LD2412GateEnergies energies;
+
+        REQUIRE(radar.enableEngineeringMode());
+        CHECK(sensor.engineering);
+        for (int g = 0; g < 14; g++) {
+            sensor.movingEnergies[g] = static_cast<uint8_t>(g);
+            sensor.staticEnergies[g] = static_cast<uint8_t>(50 + g);
+        }
+        sensor.light = 77;
+        delay(100);
+        sensor.report({3, 150, 60, 220, 40, 0});
+        REQUIRE(radar.readGateEnergies(energies));
+        CHECK(energies.moving[0] == 0 && energies.moving[13] == 13);
+        CHECK(energies.stationary[0] == 50 && energies.stationary[13] == 63);
+        CHECK(energies.light == 77);
+        CHECK(energies.timestamp == millis());
+        //The basic fields still decode from the longer frame
+        CHECK(radar.targetState() == 3);
+        CHECK(radar.movingDistance() == 150);
+        CHECK(radar.staticEnergy() == 40);
+        CHECK(radar.getStats().frameErrors == 0);
+
+        REQUIRE(radar.disableEngineeringMode());
+        CHECK(!sensor.engineering);
+        delay(100);
+        sensor.report({1, 120, 50, 0, 0, 0});
+        CHECK(radar.targetState() == 1);
+        CHECK(!radar.readGateEnergies(energies));
+    }
+}
+
+TEST(engineering_mode_resyncs_between_frame_kinds) {
+    MemoryStream stream;
+    SimulatedSensor sensor(stream);
+    LD2412 radar(stream);
+    LD2412GateEnergies energies;
+    sensor.engineering = true;
+    sensor.staticEnergies[5] = 33;
+
+    sensor.report({2, 0, 0, 300, 33, 0});
+    stream.feed({0x00, 0x11});
+    sensor.report({2, 0, 0, 310, 34, 0});
+    REQUIRE(radar.readGateEnergies(energies));
+    CHECK(energies.stationary[5] == 33);
+    delay(10);
+    CHECK(radar.staticDistance() == 310);
+    CHECK(radar.getStats().frames == 2);
+    CHECK(radar.getStats().frameErrors == 0);
+
+    //Unknown data length
+    delay(10);
+    stream.feed({0xF4, 0xF3, 0xF2, 0xF1, 0x0C, 0x00, 0x02, 0xAA, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                 0x00, 0x00, 0x55, 0x00, 0xF8, 0xF7, 0xF6, 0xF5});
+    CHECK(radar.targetState() == -1);
+    CHECK(radar.getStats().frameErrors == 1);
+}
+
+TEST(clutter_map_ignores_learned_clutter) {
+    LD2412ClutterMap map;
+    for (unsigned int n = 0; n < LD2412ClutterMap::LEARN_FRAMES; n++)
+        CHECK(map.update(office(n)) == 0);
+    CHECK(map.learned());
+    CHECK(map.staticBackground(3) >= 40 && map.staticBackground(3) <= 50);
+
+    //The fan and the monitor alone never count as presence
+    for (unsigned int n = LD2412ClutterMap::LEARN_FRAMES; n < 3000; n++)
+        CHECK(map.update(office(n)) == 0);
+}
+
+TEST(clutter_map_finds_seated_person_next_to_fan) {
+    LD2412ClutterMap map = learnedOffice();
+
+    //Seated person at gate 4 right next to the fan, weaker than the fan itself
+    unsigned int present = 0;
+    for (unsigned int n = 600; n < 600 + 6000; n++) {
+        LD2412GateEnergies e = office(n);
+        e.stationary[4] = static_cast<uint8_t>(28 + (n % 5));
+        if (map.update(e) & 2)
+            present++;
+    }
+    //Still seen after 10 minutes
+    CHECK(present == 6000);
+    CHECK(map.staticForeground(4) >= 10);
+    CHECK(map.staticForeground(3) < 10);
+
+    //Walks away
+    LD2412GateEnergies e = office(7000);
+    e.moving[6] = 60;
+    CHECK(map.update(e) == 1);
+    CHECK(map.movingForeground(6) >= 50);
+}
+
+TEST(clutter_map_absorbs_new_clutter) {
+    LD2412ClutterMap map = learnedOffice();
+
+    //Second fan switched on at gate 8
+    unsigned int n = 600;
+    LD2412GateEnergies e = office(n);
+    e.stationary[8] = 40;
+    CHECK(map.update(e) == 2);
+    unsigned int frames = 0;
+    while (frames < 100000) {
+        e = office(++n);
+        e.stationary[8] = 40;
+        frames++;
+        if (map.update(e) == 0)
+            break;
+    }
+    //About half an hour at 10 Hz under the target rate, the time a seated person also stays visible
+    CHECK(frames > 12000 && frames < 30000);
+
+    map.reset();
+    CHECK(!map.learned());
+    CHECK(map.staticBackground(3) == 0);
+}
@@ -0,0 +1,296 @@
+/**
+ * @file test_command_queue.cpp
+ * @author Trent Tobias
+ * @brief Non-blocking command queue: TX drained as space allows, sessions on demand,
+ * recovery commands first, duplicate reads coalesced
+ */
+
+#include "TestHarness.h"
+
+#include <LD2412.h>
+#include <SimulatedSensor.h>
+#include <vector>
+
+namespace {
+    struct Completion {
+        uint8_t word;
+        bool success;
+        int value;              //First payload byte
+    };
+    std::vector<Completion> completions;
+
+    void onDone(uint8_t word, const uint8_t* ack) {
+        completions.push_back({word, ack != nullptr, ack != nullptr ? ack[10] : -1});
+    }
+
+    void onOtherDone(uint8_t word, const uint8_t* ack) {
+        onDone(word, ack);
+    }
+
+    unsigned long drain(LD2412& radar) {
+        unsigned long start = millis();
+        while (radar.updateCommands() && millis() - start < 5000)
+            delay(1);
+        return millis() - start;
+    }
+
+    const uint8_t READ_PARAMS[] = {0x12, 0x00};
+    const uint8_t READ_MOTION[] = {0x13, 0x00};
+    const uint8_t READ_STATIC[] = {0x14, 0x00};
+    const uint8_t READ_FIRMWARE[] = {0xA0, 0x00};
+    const uint8_t SET_PARAMS[] = {0x02, 0x00, 0x02, 0x09, 0x1E, 0x00, 0x00};
+    const uint8_t RESTART[] = {0xA3, 0x00};
+}
+
+TEST(queue_drains_as_tx_space_allows) {
+    MemoryStream stream;
+    SimulatedSensor sensor(stream);
+    LD2412 radar(stream);
+    stream.setWriteCapacity(8);
+    completions.clear();
+
+    REQUIRE(radar.queueCommand(SET_PARAMS, sizeof(SET_PARAMS), onDone));
+    REQUIRE(radar.queueCommand(READ_PARAMS, sizeof(READ_PARAMS), onDone));
+    CHECK(stream.written().empty());
+
+    //Never more than the stream has room for per call
+    size_t before = 0;
+    while (radar.updateCommands()) {
+        CHECK(stream.written().size() - before <= 8);
+        before = stream.written().size();
+        delay(1);
+    }
+    REQUIRE(completions.size() == 2);
+    CHECK(completions[0].word == 0x02 && completions[0].success);
+    CHECK(completions[1].word == 0x12 && completions[1].success && completions[1].value == 2);
+    CHECK(sensor.maxGate == 9 && sensor.duration == 30);
+    //Both ran in one session
+    CHECK(sensor.configSessions == 1);
+    CHECK(!sensor.configMode());
+    CHECK(radar.getStats().ackErrors == 0 && radar.getStats().ackTimeouts == 0);
+}
+
+TEST(queue_without_tx_space_reporting_still_sends) {
+    MemoryStream stream;
+    SimulatedSensor sensor(stream);
+    LD2412 radar(stream);
+    stream.setWriteCapacity(0);
+    completions.clear();
+
+    REQUIRE(radar.queueCommand(READ_FIRMWARE, sizeof(READ_FIRMWARE), onDone));
+    drain(radar);
+    REQUIRE(completions.size() == 1);
+    CHECK(completions[0].success && completions[0].value == 0x12);
+    CHECK(!sensor.configMode());
+}
+
+TEST(queue_recovery_preempts_routine) {
+    MemoryStream stream;
+    SimulatedSensor sensor(stream);
+    LD2412 radar(stream);
+    completions.clear();
+
+    REQUIRE(radar.queueCommand(READ_PARAMS, sizeof(READ_PARAMS), onDone));
+    REQUIRE(radar.queueCommand(READ_MOTION, sizeof(READ_MOTION), onDone));
+    REQUIRE(radar.queueCommand(READ_STATIC, sizeof(READ_STATIC), onDone));
+    //Session opening is on the wire, nothing has started yet
+    radar.updateCommands();
+    REQUIRE(radar.queueCommand(RESTART, sizeof(RESTART), onDone, true));
+    drain(radar);
+
+    REQUIRE(completions.size() == 4);
+    CHECK(completions[0].word == 0xA3 && completions[0].success);
+    CHECK(completions[1].word == 0x12 && completions[1].success);
+    CHECK(completions[2].word == 0x13 && completions[2].success);
+    CHECK(completions[3].word == 0x14 && completions[3].success);
+    CHECK(sensor.restarts == 1);
+    CHECK(!radar.isReady());
+    CHECK(!sensor.configMode());
+}
+
+TEST(queue_restart_alone_ends_its_session) {
+    MemoryStream stream;
+    SimulatedSensor sensor(stream);
+    sensor.restartUs = 500000;
+    LD2412 radar(stream);
+    completions.clear();
+
+    REQUIRE(radar.queueCommand(RESTART, sizeof(RESTART), onDone, true));
+    drain(radar);
+    REQUIRE(completions.size() == 1);
+    CHECK(completions[0].word == 0xA3 && completions[0].success);
+    CHECK(sensor.restarts == 1);
+    CHECK(!sensor.configMode());
+
+    //Reports resume once the module has rebooted
+    for (int i = 0; i < 20 && !radar.isReady(); i++) {
+        sensor.report({1, 120, 40, 0, 0, 0});
+        delay(100);
+    }
+    CHECK(radar.isReady());
+    CHECK(radar.targetState() == 1);
+}
+
+TEST(queue_recovery_waits_for_command_in_flight) {
+    MemoryStream stream;
+    SimulatedSensor sensor(stream);
+    LD2412 radar(stream);
+    completions.clear();
+
+    REQUIRE(radar.queueCommand(READ_PARAMS, sizeof(READ_PARAMS), onDone));
+    REQUIRE(radar.queueCommand(READ_MOTION, sizeof(READ_MOTION), onDone));
+    //Until the parameter read is on the wire
+    while (sensor.lastCommand != 0x12) {
+        REQUIRE(radar.updateCommands());
+        delay(1);
+    }
+    uint8_t exit[] = {0xFE, 0x00};
+    REQUIRE(radar.queueCommand(exit, sizeof(exit), onDone, true));
+    drain(radar);
+
+    REQUIRE(completions.size() == 3);
+    CHECK(completions[0].word == 0x12 && completions[0].success);
+    CHECK(completions[1].word == 0xFE && completions[1].success);
+    //Session reopened for the routine read left
+    CHECK(completions[2].word == 0x13 && completions[2].success);
+    CHECK(sensor.configSessions == 2);
+}
+
+TEST(queue_coalesces_duplicate_reads) {
+    MemoryStream stream;
+    SimulatedSensor sensor(stream);
+    LD2412 radar(stream);
+    completions.clear();
+
+    for (int i = 0; i < 3; i++)
+        REQUIRE(radar.queueCommand(READ_PARAMS, sizeof(READ_PARAMS), onDone));
+    //Different consumer, and writes are never merged
+    REQUIRE(radar.queueCommand(READ_PARAMS, sizeof(READ_PARAMS), onOtherDone));
+    REQUIRE(radar.queueCommand(SET_PARAMS, sizeof(SET_PARAMS), onDone));
+    REQUIRE(radar.queueCommand(SET_PARAMS, sizeof(SET_PARAMS), onDone));
+    drain(radar);
+
+    CHECK(completions.size() == 4);
+    //Enable, two reads, two writes, disable
+    CHECK(sensor.commands == 6);
+}
+
+TEST(queue_full_recovery_evicts_newest_routine) {
+    MemoryStream stream;
+    SimulatedSensor sensor(stream);
+    LD2412 radar(stream);
+    completions.clear();
+
+    REQUIRE(radar.queueCommand(READ_PARAMS, sizeof(READ_PARAMS), onDone));
+    REQUIRE(radar.queueCommand(READ_MOTION, sizeof(READ_MOTION), onDone));
+    REQUIRE(radar.queueCommand(READ_STATIC, sizeof(READ_STATIC), onDone));
+    REQUIRE(radar.queueCommand(READ_FIRMWARE, sizeof(READ_FIRMWARE), onDone));
+    CHECK(!radar.queueCommand(SET_PARAMS, sizeof(SET_PARAMS), onDone));
+    REQUIRE(radar.queueCommand(RESTART, sizeof(RESTART), onDone, true));
+    REQUIRE(completions.size() == 1);
+    CHECK(completions[0].word == 0xA0 && !completions[0].success);
+
+    drain(radar);
+    REQUIRE(completions.size() == 5);
+    CHECK(completions[1].word == 0xA3);
+    CHECK(completions[4].word == 0x14 && completions[4].success);
+}
+
+TEST(queue_without_module_fails_commands) {
+    MemoryStream stream;
+    LD2412 radar(stream);
+    completions.clear();
+
+    REQUIRE(radar.queueCommand(READ_PARAMS, sizeof(READ_PARAMS), onDone));
+    REQUIRE(radar.queueCommand(READ_MOTION, sizeof(READ_MOTION), onDone));
+    drain(radar);
+    REQUIRE(completions.size() == 2);
+    CHECK(!completions[0].success && !completions[1].success);
+    //Opening the session is tried twice per command
+    CHECK(radar.getStats().ackTimeouts == 4);
+}
+
+TEST(queue_and_blocking_calls_share_the_line) {
+    MemoryStream stream;
+    SimulatedSensor sensor(stream);
+    LD2412 radar(stream);
+    completions.clear();
+
+    REQUIRE(radar.queueCommand(READ_FIRMWARE, sizeof(READ_FIRMWARE), onDone));
+    while (sensor.lastCommand != 0xA0) {
+        REQUIRE(radar.updateCommands());
+        delay(1);
+    }
+    //Finishes the queued read first, then runs its own session
+    const int* params = radar.getParamConfig();
+    REQUIRE(params != nullptr);
+    CHECK(params[1] == 12);
+    REQUIRE(completions.size() == 1);
+    CHECK(completions[0].word == 0xA0 && completions[0].success);
+
+    //Reports resume once the queue is drained
+    drain(radar);
+    CHECK(!sensor.configMode());
+    CHECK(sensor.report({1, 120, 40, 0, 0, 0}));
+    CHECK(radar.targetState() == 1);
+}
+
+TEST(blocking_calls_fail_fast_on_silent_module) {
+    MemoryStream stream;
+    SimulatedSensor sensor(stream);
+    LD2412 radar(stream);
+    stream.onWrite(nullptr);
+
+    //Two enable attempts at 20 ms each, not the full ACK timeout
+    unsigned long start = millis();
+    CHECK(radar.getParamConfig() == nullptr);
+    CHECK(millis() - start < 60);
+}
+
+TEST(blocking_calls_wait_for_trickling_ack) {
+    //Module behind a slow link: each ACK starts 15 ms after the command, one byte per ms
+    MemoryStream stream;
+    MemoryStream module;
+    SimulatedSensor sensor(module);
+    sensor.ackDelayUs = 0;
+    stream.onWrite([&](const uint8_t* data, size_t len) {
+        module.write(data, len);
+        for (uint64_t i = 0; module.available() > 0; i++) {
+            uint8_t b = module.read();
+            stream.feed(&b, 1, 15000 + i * 1000);
+        }
+    });
+    LD2412 radar(stream);
+
+    const int* params = radar.getParamConfig();
+    REQUIRE(params != nullptr);
+    CHECK(params[1] == sensor.maxGate);
+    CHECK(radar.getStats().ackTimeouts == 0);
+}
+
+TEST(blocking_calls_work_at_low_baud) {
+    //9600 baud both ways: a 26-byte sensitivity command alone takes 27 ms on the wire
+    constexpr uint64_t CHAR_US = 10000000 / 9600;
+    MemoryStream stream;
+    MemoryStream module;
+    SimulatedSensor sensor(module);
+    sensor.ackDelayUs = 0;
+    stream.setBaud(9600);
+    stream.onWrite([&](const uint8_t* data, size_t len) {
+        module.write(data, len);
+        uint64_t sent = stream.lineFreeAt() - host::nowMicros();
+        for (uint64_t i = 0; module.available() > 0; i++) {
+            uint8_t b = module.read();
+            stream.feed(&b, 1, sent + 2000 + (i + 1) * CHAR_US);
+        }
+    });
+    LD2412 radar(stream);
+
+    CHECK(radar.setMotionSensitivity(40));
+    CHECK(sensor.motionSensitivity[0] == 40);
+    const int* firmware = radar.readFirmwareVersion();
+    REQUIRE(firmware != nullptr);
+    CHECK(firmware[0] == sensor.firmwareType);
+    CHECK(radar.getStats().ackTimeouts == 0 && radar.getStats().ackErrors == 0);
+    CHECK(!sensor.configMode());
+}
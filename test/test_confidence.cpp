@@ -0,0 +1,64 @@
+/**
+ * @file test_confidence.cpp
+ * @author Trent Tobias
+ * @brief Presence confidence score from energies, sensitivities, persistence and stability
+ */
+
+#include "TestHarness.h"
+
+#include <LD2412.h>
+#include <LD2412Confidence.h>
+#include <SimulatedSensor.h>
+
+TEST(confidence_components) {
+    LD2412Confidence score;
+    uint8_t motion[14], stationary[14];
+    for (int g = 0; g < 14; g++) {
+        motion[g] = static_cast<uint8_t>(20 + g);
+        stationary[g] = 30;
+    }
+    score.setSensitivities(motion, stationary);
+
+    //First frame: energy only plus a run of 1. gate 2 (150-224 cm) with sensitivity 22, 39 above it
+    CHECK(score.update({1, 160, 61, 0, 0, 0}) == 46 + 6);
+    //Steady distance, the run grows
+    CHECK(score.update({1, 165, 61, 0, 0, 0}) == 46 + 11 + 20);
+    for (int i = 0; i < 20; i++)
+        score.update({1, 165, 61, 0, 0, 0});
+    CHECK(score.value() == 96);
+    //At the sensitivity and jumping around
+    CHECK(score.update({1, 265, 23, 0, 0, 0}) == 5 + 30 + 0);
+    //The better of moving and static counts
+    CHECK(score.update({3, 270, 23, 270, 70, 0}) == 50 + 30 + 20);
+
+    //A dropout scores 0 and halves the run
+    CHECK(score.update({0, 0, 0, 0, 0, 0}) == 0);
+    CHECK(score.update({2, 0, 0, 270, 30, 0}) == 5 + 26 + 20);
+    //Beyond the last gate uses gate 13
+    CHECK(score.update({1, 2000, 43, 0, 0, 0}) == 20 + 27 + 0);
+
+    score.reset();
+    CHECK(score.value() == 0);
+    CHECK(score.update({2, 0, 0, 270, 70, 0}) == 50 + 6);
+}
+
+TEST(confidence_loads_sensitivities) {
+    MemoryStream stream;
+    SimulatedSensor sensor(stream);
+    LD2412 radar(stream);
+    LD2412Confidence score;
+    for (int g = 0; g < 14; g++) {
+        sensor.motionSensitivity[g] = 40;
+        sensor.staticSensitivity[g] = 25;
+    }
+
+    REQUIRE(score.load(radar));
+    CHECK(score.update({1, 100, 45, 0, 0, 0}) == 12 + 6);
+    CHECK(score.update({2, 0, 0, 100, 45, 0}) == 33 + 11 + 20);
+
+    //Module gone: the cached values stay
+    sensor.ackDelayUs = 10000000;
+    CHECK(!score.load(radar));
+    score.reset();
+    CHECK(score.update({1, 100, 45, 0, 0, 0}) == 12 + 6);
+}
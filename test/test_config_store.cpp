@@ -0,0 +1,170 @@
+/**
+ * @file test_config_store.cpp
+ * @author Trent Tobias
+ * @brief Boot-time configuration check: fingerprint fast path, re-apply on any mismatch,
+ * and the file-backed store
+ */
+
+#include "TestHarness.h"
+
+#include <FileConfigStore.h>
+#include <LD2412.h>
+#include <SimulatedSensor.h>
+#include <string>
+#include <unistd.h>
+
+namespace {
+    class MemoryStore : public LD2412ConfigStore {
+    public:
+        bool valid = false;
+        uint32_t value = 0;
+        unsigned int saves = 0;
+
+        bool load(uint32_t& fingerprint) override {
+            fingerprint = this->value;
+            return this->valid;
+        }
+
+        bool save(uint32_t fingerprint) override {
+            this->value = fingerprint;
+            this->valid = true;
+            this->saves++;
+            return true;
+        }
+    };
+
+    LD2412Config siteConfig() {
+        LD2412Config c;
+        c.minGate = 2;
+        c.maxGate = 9;
+        c.duration = 30;
+        c.outPinPolarity = 1;
+        for (int i = 0; i < 14; i++) {
+            c.motionSensitivity[i] = 40 + i;
+            c.staticSensitivity[i] = 30 + i;
+        }
+        return c;
+    }
+
+    /**
+     * @brief A boot: fresh library object against the module, returns ensureConfig()'s result
+     */
+    int boot(MemoryStream& stream, const LD2412Config& config, LD2412ConfigStore& store, unsigned long* ms = nullptr) {
+        LD2412 radar(stream);
+        unsigned long start = millis();
+        int result = radar.ensureConfig(config, store);
+        if (ms != nullptr)
+            *ms = millis() - start;
+        delay(100);
+        return result;
+    }
+}
+
+TEST(config_first_boot_applies_and_stores) {
+    MemoryStream stream;
+    SimulatedSensor sensor(stream);
+    MemoryStore store;
+    LD2412Config config = siteConfig();
+
+    CHECK(boot(stream, config, store) == 1);
+    CHECK(store.saves == 1);
+    CHECK(sensor.configSessions == 1);
+    CHECK(sensor.minGate == 2 && sensor.maxGate == 9 && sensor.duration == 30 && sensor.outPinPolarity == 1);
+    CHECK(sensor.motionSensitivity[13] == 53 && sensor.staticSensitivity[0] == 30);
+    CHECK(!sensor.configMode());
+}
+
+TEST(config_matching_boot_takes_fast_path) {
+    MemoryStream stream;
+    SimulatedSensor sensor(stream);
+    MemoryStore store;
+    LD2412Config config = siteConfig();
+    unsigned long fullMs, fastMs;
+
+    REQUIRE(boot(stream, config, store, &fullMs) == 1);
+    unsigned int commands = sensor.commands;
+    CHECK(boot(stream, config, store, &fastMs) == 0);
+    //Enable, firmware, parameters, disable
+    CHECK(sensor.commands - commands == 4);
+    CHECK(store.saves == 1);
+    CHECK(fastMs * 2 < fullMs);
+}
+
+TEST(config_mismatch_reapplies) {
+    MemoryStream stream;
+    SimulatedSensor sensor(stream);
+    MemoryStore store;
+    LD2412Config config = siteConfig();
+    REQUIRE(boot(stream, config, store) == 1);
+
+    //Module reset to factory values behind our back
+    sensor.maxGate = 12;
+    CHECK(boot(stream, config, store) == 1);
+    CHECK(sensor.maxGate == 9);
+
+    //Firmware update
+    sensor.firmwareMinor++;
+    CHECK(boot(stream, config, store) == 1);
+    CHECK(boot(stream, config, store) == 0);
+
+    //New configuration: a sensitivity only the fingerprint covers
+    config.staticSensitivity[5] = 77;
+    CHECK(boot(stream, config, store) == 1);
+    CHECK(sensor.staticSensitivity[5] == 77);
+
+    //Lost or wiped storage
+    store.valid = false;
+    CHECK(boot(stream, config, store) == 1);
+    CHECK(store.saves == 5);
+}
+
+TEST(config_defaults_keep_module_sensitivities) {
+    MemoryStream stream;
+    SimulatedSensor sensor(stream);
+    MemoryStore store;
+    for (int i = 0; i < 14; i++) {
+        sensor.motionSensitivity[i] = 50 - i;
+        sensor.staticSensitivity[i] = 25;
+    }
+    LD2412Config config;
+    config.staticSensitivity[3] = 60;
+
+    CHECK(boot(stream, config, store) == 1);
+    CHECK(sensor.motionSensitivity[0] == 50 && sensor.motionSensitivity[13] == 37);
+    CHECK(sensor.staticSensitivity[3] == 60 && sensor.staticSensitivity[4] == 0);
+    CHECK(boot(stream, LD2412Config(), store) == 1);
+    CHECK(sensor.motionSensitivity[0] == 50 && sensor.staticSensitivity[3] == 60);
+    CHECK(boot(stream, LD2412Config(), store) == 0);
+}
+
+TEST(config_fails_without_module) {
+    MemoryStream stream;
+    SimulatedSensor sensor(stream);
+    MemoryStore store;
+    stream.onWrite(nullptr);
+    CHECK(boot(stream, siteConfig(), store) == -1);
+    CHECK(store.saves == 0);
+}
+
+TEST(config_fingerprint_depends_on_everything) {
+    const int firmware[3] = {0x2412, 1, 0x24040512};
+    LD2412Config a = siteConfig();
+    LD2412Config b = siteConfig();
+    CHECK(a.fingerprint(firmware) == b.fingerprint(firmware));
+    b.motionSensitivity[13]++;
+    CHECK(a.fingerprint(firmware) != b.fingerprint(firmware));
+    const int updated[3] = {0x2412, 1, 0x24040513};
+    CHECK(a.fingerprint(firmware) != a.fingerprint(updated));
+}
+
+TEST(config_file_store_roundtrip) {
+    std::string path = "/tmp/ld2412_config_" + std::to_string(getpid());
+    FileConfigStore store(path);
+    uint32_t value = 0;
+    CHECK(!store.load(value));
+    CHECK(store.save(0xDEADBEEF));
+    CHECK(store.load(value));
+    CHECK(value == 0xDEADBEEF);
+    CHECK(FileConfigStore(path).load(value) && value == 0xDEADBEEF);
+    unlink(path.c_str());
+}
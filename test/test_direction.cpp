@@ -0,0 +1,156 @@
+/**
+ * @file test_direction.cpp
+ * @author Trent Tobias
+ * @brief Approach/departure classifier on synthetic tracks with range jitter
+ */
+
+#include "TestFeed.h"
+#include "TestHarness.h"
+
+#include <LD2412Direction.h>
+#include <cmath>
+#include <vector>
+
+namespace {
+    struct Event {
+        uint8_t motion;
+        int speed;
+    };
+    using Events = test::Recorder<Event>;
+
+    LD2412Frame moving(int distance, unsigned long time) {
+        return {1, static_cast<uint16_t>(distance), 50, 0, 0, time};
+    }
+
+    bool seen(const Events& events, uint8_t motion) {
+        for (const Event& e : events)
+            if (e.motion == motion)
+                return true;
+        return false;
+    }
+}
+
+TEST(direction_approach_and_depart) {
+    for (int sign : {-1, 1}) {
+        LD2412Direction direction;
+        Events events;
+        direction.setCallback(events.record);
+        unsigned int firstEvent = 0;
+
+        //1 m/s at 10 Hz for 3 s
+        for (unsigned int i = 0; i < 30; i++) {
+            int distance = (sign < 0 ? 500 : 200) + sign * 10 * static_cast<int>(i) + test::jitter(i);
+            if (direction.update(moving(distance, 1000 + i * 100)) && firstEvent == 0)
+                firstEvent = i;
+        }
+        REQUIRE(events.size() == 1);
+        CHECK(events[0].motion == (sign < 0 ? LD2412Direction::APPROACHING : LD2412Direction::DEPARTING));
+        //Labelled within 1.1 s of the track starting
+        CHECK(firstEvent <= LD2412Direction::MIN_SAMPLES + LD2412Direction::CONFIRM);
+        CHECK(std::abs(direction.speed() - sign * 100) <= 15);
+    }
+}
+
+TEST(direction_ignores_repeated_frames) {
+    //A read loop polling every 10 ms feeds each 10 Hz frame ten times
+    LD2412Direction direction;
+    Events events;
+    direction.setCallback(events.record);
+    for (unsigned int i = 0; i < 30; i++)
+        for (int poll = 0; poll < 10; poll++)
+            direction.update(moving(200 + 10 * static_cast<int>(i) + test::jitter(i), 1000 + i * 100));
+    REQUIRE(events.size() == 1);
+    CHECK(events[0].motion == LD2412Direction::DEPARTING);
+    CHECK(std::abs(direction.speed() - 100) <= 15);
+}
+
+TEST(direction_person_walking_past_is_not_approaching) {
+    LD2412Direction direction;
+    Events events;
+    direction.setCallback(events.record);
+
+    //Passes 3 m in front of the sensor, 1 m/s across the beam
+    for (unsigned int i = 0; i <= 20; i++) {
+        double x = -100.0 + 10.0 * i;
+        int distance = static_cast<int>(std::lround(std::sqrt(300.0 * 300.0 + x * x))) + test::jitter(i);
+        direction.update(moving(distance, 1000 + i * 100));
+    }
+    CHECK(seen(events, LD2412Direction::CROSSING));
+    CHECK(!seen(events, LD2412Direction::APPROACHING));
+    CHECK(!seen(events, LD2412Direction::LOITERING));
+}
+
+TEST(direction_loitering_after_dwell) {
+    LD2412Direction direction;
+    Events events;
+    direction.setCallback(events.record);
+
+    for (unsigned int i = 0; i < 80; i++)
+        direction.update(moving(150 + test::jitter(i), 1000 + i * 100));
+    CHECK(direction.motion() == LD2412Direction::LOITERING);
+    CHECK(!seen(events, LD2412Direction::APPROACHING) && !seen(events, LD2412Direction::DEPARTING));
+}
+
+TEST(direction_outliers_and_track_end) {
+    LD2412Direction direction;
+    Events events;
+    direction.setCallback(events.record);
+
+    unsigned long t = 1000;
+    for (unsigned int i = 0; i < 25; i++, t += 100) {
+        int distance = 500 - 10 * static_cast<int>(i) + test::jitter(i);
+        //Single-frame range glitches
+        if (i == 12 || i == 18)
+            distance = 900;
+        direction.update(moving(distance, t));
+    }
+    REQUIRE(events.size() == 1);
+    CHECK(events[0].motion == LD2412Direction::APPROACHING);
+
+    //Target gone: frames without a moving target end the track
+    for (unsigned int i = 0; i < 10; i++, t += 100)
+        direction.update({2, 0, 0, 80, 40, t});
+    REQUIRE(events.size() == 2);
+    CHECK(events[1].motion == LD2412Direction::NONE);
+    CHECK(direction.speed() == 0);
+
+    //A new target elsewhere starts its own track
+    for (unsigned int i = 0; i < 20; i++, t += 100)
+        direction.update(moving(100 + 10 * static_cast<int>(i) + test::jitter(i), t));
+    REQUIRE(events.size() == 3);
+    CHECK(events[2].motion == LD2412Direction::DEPARTING);
+}
+
+TEST(direction_running_sums_match_full_fit) {
+    LD2412Direction direction;
+    std::vector<int> ds;
+    std::vector<unsigned long> ts;
+    int distance = 400;
+    unsigned long t = 0;
+    uint32_t seed = 12345;
+
+    for (unsigned int i = 0; i < 500; i++) {
+        seed = seed * 1103515245u + 12345u;
+        distance += static_cast<int>((seed >> 16) % 41) - 20;
+        distance = distance < 50 ? 50 : distance > 1200 ? 1200 : distance;
+        t += 90 + (seed >> 8) % 21;
+        direction.update(moving(distance, t));
+        ds.push_back(distance);
+        ts.push_back(t);
+
+        if (ds.size() < LD2412Direction::WINDOW)
+            continue;
+        //Least-squares over the last WINDOW frames, from scratch in floating point
+        const size_t n = LD2412Direction::WINDOW, first = ds.size() - n;
+        double sx = 0, sd = 0, sxx = 0, sxd = 0;
+        for (size_t k = 0; k < n; k++) {
+            sx += k;
+            sd += ds[first + k];
+            sxx += static_cast<double>(k) * k;
+            sxd += static_cast<double>(k) * ds[first + k];
+        }
+        double slope = (n * sxd - sx * sd) / (n * sxx - sx * sx);
+        double expected = slope * (n - 1) * 1000.0 / (ts.back() - ts[first]);
+        CHECK(std::fabs(direction.speed() - expected) <= 1.0);
+    }
+}
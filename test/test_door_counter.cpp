@@ -0,0 +1,128 @@
+/**
+ * @file test_door_counter.cpp
+ * @author Trent Tobias
+ * @brief Doorway people counter fed with simulated walks past two sensors
+ */
+
+#include "TestFeed.h"
+#include "TestHarness.h"
+
+#include <LD2412DoorCounter.h>
+
+namespace {
+    struct Change {
+        int count;
+        int change;
+    };
+
+    /**
+     * @brief Both sensors sit in the door frame, the outside one facing out of the room.
+     * Position is along the walking line in cm, negative outside, and each sensor sees the
+     * person from 20 cm on its side. Frames at 10 Hz per sensor, interleaved
+     */
+    class Doorway : public test::FrameFeed {
+    public:
+        LD2412DoorCounter counter;
+        test::Recorder<Change> changes;
+
+        Doorway() : FrameFeed([this](const LD2412Frame& f) { this->counter.update(this->side, f); }) {
+            this->counter.setCallback(this->changes.record);
+        }
+
+        void frame(int position, bool present = true) {
+            int jitter = test::jitter(this->n++);
+            LD2412Frame out = {0, 0, 0, 0, 0, 0};
+            LD2412Frame in = {0, 0, 0, 0, 0, 0};
+            if (present && position <= -20)
+                out = {1, static_cast<uint16_t>(-position + jitter), 50, 0, 0, 0};
+            if (present && position >= 20)
+                in = {1, static_cast<uint16_t>(position + jitter), 50, 0, 0, 0};
+            this->side = LD2412DoorCounter::OUTSIDE;
+            FrameFeed::frame(out, PERIOD / 2);
+            this->side = LD2412DoorCounter::INSIDE;
+            FrameFeed::frame(in, PERIOD / 2);
+        }
+
+        //Walks at 1 m/s
+        void walk(int from, int to) {
+            int step = from < to ? 10 : -10;
+            for (int p = from; p != to; p += step)
+                frame(p);
+        }
+
+        void idle(unsigned long ms) {
+            for (unsigned long t = 0; t < ms; t += PERIOD)
+                frame(0, false);
+        }
+
+    private:
+        LD2412DoorCounter::Side side = LD2412DoorCounter::OUTSIDE;
+        unsigned int n = 0;
+    };
+}
+
+TEST(door_counts_entry_and_exit) {
+    Doorway door;
+    door.walk(-400, 400);
+    door.idle(3000);
+    CHECK(door.counter.count() == 1);
+    CHECK(door.counter.entries() == 1);
+    REQUIRE(door.changes.size() == 1);
+    CHECK(door.changes[0].count == 1 && door.changes[0].change == 1);
+
+    door.walk(400, -400);
+    door.idle(3000);
+    CHECK(door.counter.count() == 0);
+    CHECK(door.counter.exits() == 1);
+    REQUIRE(door.changes.size() == 2);
+    CHECK(door.changes[1].count == 0 && door.changes[1].change == -1);
+}
+
+TEST(door_counts_people_in_a_row) {
+    Doorway door;
+    for (int i = 0; i < 3; i++) {
+        door.walk(-300, 300);
+        door.idle(1500);
+    }
+    CHECK(door.counter.count() == 3);
+    door.walk(300, -300);
+    door.idle(1500);
+    CHECK(door.counter.count() == 2);
+}
+
+TEST(door_ignores_turning_back_and_inside_motion) {
+    Doorway door;
+    //Comes up to the door and leaves again
+    door.walk(-400, -60);
+    door.walk(-60, -400);
+    door.idle(3000);
+    //Moves about inside without having come through
+    door.walk(40, 400);
+    door.walk(400, 100);
+    door.idle(3000);
+    CHECK(door.counter.count() == 0);
+    CHECK(door.changes.empty());
+}
+
+TEST(door_drift_correction) {
+    Doorway door;
+    door.counter.setEmptyTimeout(30000);
+    door.counter.setCount(3);
+    //Inside sensor sees nobody: the count was wrong
+    door.idle(31000);
+    CHECK(door.counter.count() == 0);
+    CHECK(door.counter.corrections() == 1);
+    REQUIRE(door.changes.size() == 1);
+    CHECK(door.changes[0].count == 0 && door.changes[0].change == 0);
+
+    //Someone the counter missed sits inside
+    for (int i = 0; i < 310; i++)
+        door.frame(150);
+    CHECK(door.counter.count() == 1);
+    CHECK(door.counter.corrections() == 2);
+
+    //Disabled
+    door.counter.setEmptyTimeout(0);
+    door.idle(60000);
+    CHECK(door.counter.count() == 1);
+}
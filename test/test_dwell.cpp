@@ -0,0 +1,108 @@
+/**
+ * @file test_dwell.cpp
+ * @author Trent Tobias
+ * @brief Per-zone occupancy intervals and dwell-time statistics
+ */
+
+#include "TestFeed.h"
+#include "TestHarness.h"
+
+#include <LD2412Dwell.h>
+
+namespace {
+    /**
+     * @brief Desk at 1 m (zone 0) and a meeting corner at 2-3 m (zone 1), frames at 10 Hz
+     */
+    class Office : public test::FrameFeed {
+    public:
+        LD2412Dwell dwell;
+        test::Recorder<LD2412DwellInterval> closed;
+
+        Office() : FrameFeed([this](const LD2412Frame& f) { this->dwell.update(f); }) {
+            this->dwell.setZone(0, 50, 150);
+            this->dwell.setZone(1, 200, 300);
+            this->dwell.setCallback(this->closed.record);
+        }
+
+        void sit(uint16_t distance, uint8_t energy, unsigned long ms) {
+            for (unsigned long t = 0; t < ms; t += PERIOD)
+                frame({2, 0, 0, static_cast<uint16_t>(distance + (t / PERIOD) % 5 - 2), energy, 0});
+        }
+    };
+}
+
+TEST(dwell_tracks_desk_interval) {
+    Office office;
+    unsigned long start = office.now;
+    //20 minutes at the desk, with a few seconds the module lost the person
+    for (int i = 0; i < 4; i++) {
+        office.sit(100, 40 + i, 295000);
+        office.idle(5000);
+    }
+    CHECK(office.dwell.occupied(0));
+    CHECK(office.closed.empty());
+    //Walks out through the corner: a moving target that never stays in zone 0
+    office.frame({1, 250, 70, 0, 0, 0});
+    unsigned long last = office.now - 5200;
+    office.idle(10000);
+
+    REQUIRE(office.closed.size() == 2);
+    const LD2412DwellInterval& desk = office.closed[0].zone == 0 ? office.closed[0] : office.closed[1];
+    CHECK(desk.start == start);
+    CHECK(desk.end == last);
+    CHECK(desk.meanDistance >= 99 && desk.meanDistance <= 101);
+    CHECK(desk.peakEnergy == 43);
+    CHECK(!office.dwell.occupied(0));
+    CHECK(office.dwell.count(0) == 1);
+    CHECK(office.dwell.total(0) == last - start);
+    CHECK(office.dwell.count(1) == 1);
+    CHECK(office.dwell.total(1) == 0);
+}
+
+TEST(dwell_statistics_and_bounded_list) {
+    Office office;
+    //Meetings: 18 short ones and 2 long ones
+    for (int i = 0; i < 20; i++) {
+        office.sit(250, 50, i < 18 ? 20000 + i * 1000 : 3000000);
+        office.idle(15000);
+    }
+    CHECK(office.dwell.count(1) == 20);
+    CHECK(office.dwell.count(0) == 0);
+    CHECK(office.dwell.percentile(1, 50) == 30000);
+    CHECK(office.dwell.percentile(1, 95) == 2999900);
+    CHECK(office.dwell.percentile(1, 100) == 2999900);
+    CHECK(office.dwell.percentile(0, 50) == 0);
+
+    uint64_t expected = 2 * 2999900ULL;
+    for (int i = 0; i < 18; i++)
+        expected += 20000 + i * 1000 - 100;
+    CHECK(office.dwell.total(1) == expected);
+
+    //Only the latest intervals are kept
+    CHECK(office.dwell.intervalCount() == LD2412Dwell::INTERVALS);
+    REQUIRE(office.dwell.interval(0) != nullptr);
+    CHECK(office.dwell.interval(0)->end - office.dwell.interval(0)->start == 2999900);
+    CHECK(office.dwell.interval(2)->end - office.dwell.interval(2)->start == 36900);
+    CHECK(office.dwell.interval(LD2412Dwell::INTERVALS) == nullptr);
+
+    office.dwell.reset();
+    CHECK(office.dwell.intervalCount() == 0);
+    CHECK(office.dwell.count(1) == 0);
+}
+
+TEST(dwell_close_and_zone_setup) {
+    Office office;
+    office.sit(100, 30, 60000);
+    CHECK(office.dwell.occupied(0));
+    office.dwell.close();
+    CHECK(!office.dwell.occupied(0));
+    REQUIRE(office.closed.size() == 1);
+    CHECK(office.closed[0].end - office.closed[0].start == 59900);
+
+    CHECK(!office.dwell.setZone(4, 0, 100));
+    CHECK(!office.dwell.setZone(2, 300, 300));
+    //Disabled zones never open
+    CHECK(office.dwell.setZone(0, 0, 0));
+    office.sit(100, 30, 5000);
+    CHECK(!office.dwell.occupied(0));
+}
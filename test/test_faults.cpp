@@ -0,0 +1,152 @@
+/**
+ * @file test_faults.cpp
+ * @author Trent Tobias
+ * @brief Fault-injecting stream: each fault kind, reproducibility, and the library
+ * degrading gracefully under line noise
+ */
+
+#include "TestHarness.h"
+
+#include <FaultyStream.h>
+#include <LD2412.h>
+#include <SimulatedSensor.h>
+#include <vector>
+
+namespace {
+    std::vector<uint8_t> drain(Stream& stream) {
+        std::vector<uint8_t> out;
+        while (stream.available() > 0)
+            out.push_back(stream.read());
+        return out;
+    }
+
+    std::vector<uint8_t> passThrough(const FaultyStream::Faults& faults, uint32_t seed,
+                                     const std::vector<uint8_t>& bytes, FaultyStream::Counts* counts = nullptr) {
+        MemoryStream inner;
+        FaultyStream noisy(inner, seed);
+        noisy.setFaults(faults);
+        inner.feed(bytes);
+        std::vector<uint8_t> out = drain(noisy);
+        if (counts != nullptr)
+            *counts = noisy.counts();
+        return out;
+    }
+
+    const std::vector<uint8_t> BYTES = {0x10, 0x20, 0x30, 0x40, 0x50, 0x60, 0x70, 0x80};
+}
+
+TEST(faults_each_kind) {
+    FaultyStream::Faults f;
+    CHECK(passThrough(f, 1, BYTES) == BYTES);
+
+    f.drop = 1;
+    CHECK(passThrough(f, 1, BYTES).empty());
+
+    f = {};
+    f.duplicate = 1;
+    std::vector<uint8_t> doubled = passThrough(f, 1, BYTES);
+    REQUIRE(doubled.size() == 2 * BYTES.size());
+    CHECK(doubled[0] == 0x10 && doubled[1] == 0x10 && doubled[15] == 0x80);
+
+    f = {};
+    f.bitFlip = 1;
+    std::vector<uint8_t> flipped = passThrough(f, 1, BYTES);
+    REQUIRE(flipped.size() == BYTES.size());
+    for (size_t i = 0; i < BYTES.size(); i++)
+        CHECK(__builtin_popcount(flipped[i] ^ BYTES[i]) == 1);
+
+    f = {};
+    f.garbage = 1;
+    f.garbageMax = 4;
+    FaultyStream::Counts counts;
+    std::vector<uint8_t> noisy = passThrough(f, 1, BYTES, &counts);
+    CHECK(counts.garbageBursts == BYTES.size());
+    CHECK(noisy.size() > BYTES.size() && noisy.size() <= 5 * BYTES.size());
+    CHECK(noisy.back() == 0x80);
+}
+
+TEST(faults_delay_holds_delivery) {
+    MemoryStream inner;
+    FaultyStream noisy(inner, 7);
+    FaultyStream::Faults f;
+    f.delay = 1;
+    f.delayUs = 3000;
+    noisy.setFaults(f);
+    inner.feed(BYTES);
+
+    CHECK(noisy.available() == 0);
+    host::advanceClock(2999);
+    CHECK(noisy.available() == 0);
+    host::advanceClock(1);
+    CHECK(noisy.available() == static_cast<int>(BYTES.size()));
+    CHECK(noisy.counts().delays == BYTES.size());
+}
+
+TEST(faults_are_reproducible) {
+    FaultyStream::Faults f;
+    f.drop = 0.05;
+    f.bitFlip = 0.05;
+    f.duplicate = 0.05;
+    f.garbage = 0.02;
+    std::vector<uint8_t> bytes;
+    for (int i = 0; i < 2000; i++)
+        bytes.push_back(static_cast<uint8_t>(i * 7));
+
+    FaultyStream::Counts a, b;
+    std::vector<uint8_t> first = passThrough(f, 42, bytes, &a);
+    CHECK(first == passThrough(f, 42, bytes, &b));
+    CHECK(a.drops == b.drops && a.bitFlips == b.bitFlips && a.garbageBursts == b.garbageBursts);
+    CHECK(a.drops > 50 && a.drops < 150);
+    CHECK(first != passThrough(f, 43, bytes));
+}
+
+TEST(faults_truncated_ack_fails_command) {
+    //Lets the library's ACK wait loop reach its timeout on the virtual clock
+    host::setClockStep(100);
+    MemoryStream inner;
+    SimulatedSensor sensor(inner);
+    FaultyStream noisy(inner, 3);
+    LD2412 radar(noisy);
+
+    FaultyStream::Faults f;
+    f.truncateAck = 1;
+    noisy.setFaults(f);
+    CHECK(radar.getParamConfig() == nullptr);
+    CHECK(noisy.counts().truncatedAcks >= 2);
+    //Depending on where it was cut, a truncated ACK fails verification or times out
+    CHECK(radar.getStats().ackTimeouts + radar.getStats().ackErrors >= 2);
+
+    //Clean line again: the next command goes through
+    noisy.setFaults({});
+    delay(500);
+    CHECK(radar.getParamConfig() != nullptr);
+}
+
+TEST(faults_parser_degrades_gracefully) {
+    host::setClockStep(10);
+    MemoryStream inner;
+    SimulatedSensor sensor(inner);
+    FaultyStream noisy(inner, 11);
+    LD2412 radar(noisy);
+
+    FaultyStream::Faults f;
+    f.drop = 0.002;
+    f.bitFlip = 0.002;
+    f.garbage = 0.002;
+    noisy.setFaults(f);
+
+    const unsigned int sent = 1000;
+    LD2412Frame frame;
+    for (unsigned int i = 0; i < sent; i++) {
+        sensor.report({1, static_cast<uint16_t>(100 + i % 50), 40, 0, 0, 0});
+        delay(100);
+        radar.readFrame(frame);
+    }
+
+    //Roughly 4% of frames are hit; losses stay in proportion and show up in the counters
+    const LD2412Stats& stats = radar.getStats();
+    CHECK(stats.frames >= sent * 85 / 100);
+    CHECK(stats.frames <= sent);
+    CHECK(stats.resyncs > 0);
+    CHECK(noisy.counts().drops + noisy.counts().bitFlips + noisy.counts().garbageBursts > 0);
+}
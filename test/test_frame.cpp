@@ -0,0 +1,97 @@
+/**
+ * @file test_frame.cpp
+ * @author Trent Tobias
+ * @brief Decoded frame capture and the packed 8-byte history form
+ */
+
+#include "TestHarness.h"
+
+#include <HostStreams.h>
+#include <LD2412.h>
+
+namespace {
+    bool same(const LD2412Frame& a, const LD2412Frame& b) {
+        return a.state == b.state && a.movingDistance == b.movingDistance && a.movingEnergy == b.movingEnergy
+            && a.staticDistance == b.staticDistance && a.staticEnergy == b.staticEnergy
+            && a.timestamp == b.timestamp;
+    }
+}
+
+TEST(frame_waiting_holds_split_frames) {
+    MemoryStream stream;
+    LD2412 radar(stream);
+    const uint8_t report[] = {0xF4, 0xF3, 0xF2, 0xF1, 0x0B, 0x00, 0x02, 0xAA, 0x01, 0x64, 0x00, 0x3C,
+                              0x00, 0x00, 0x00, 0x55, 0x00, 0xF8, 0xF7, 0xF6, 0xF5};
+    //Line noise, then each frame in two pieces 10 ms apart
+    stream.feed({0x00, 0xF5});
+    for (int n = 0; n < 20; n++) {
+        stream.feed(report, 9, n * 100000);
+        stream.feed(report + 9, sizeof(report) - 9, n * 100000 + 10000);
+    }
+
+    unsigned int frames = 0;
+    for (int t = 0; t < 2100; t++) {
+        LD2412Frame f;
+        if (radar.frameWaiting() && radar.readFrame(f) && radar.getStats().frames != frames) {
+            frames = radar.getStats().frames;
+            CHECK(f.state == 1 && f.movingDistance == 100 && f.movingEnergy == 60);
+        }
+        delay(1);
+    }
+    CHECK(frames == 20);
+    CHECK(radar.getStats().frameErrors == 0);
+}
+
+TEST(frame_pack_roundtrip) {
+    const LD2412Frame frames[] = {
+        {0, 0, 0, 0, 0, 1000},
+        {1, 1050, 100, 0, 0, 1100},
+        {2, 0, 0, 4095, 127, 1200},
+        {3, 95, 48, 210, 35, 1200 + 0xFFFFFF},
+    };
+    unsigned long previous = 1000;
+    for (const LD2412Frame& f : frames) {
+        LD2412PackedFrame packed = LD2412PackedFrame::pack(f, previous);
+        CHECK(same(packed.unpack(previous), f));
+        CHECK(packed.delta() == f.timestamp - previous);
+        previous = f.timestamp;
+    }
+}
+
+TEST(frame_pack_saturates) {
+    LD2412Frame f = {3, 5000, 200, 6000, 255, 0x2000000};
+    LD2412Frame out = LD2412PackedFrame::pack(f, 0).unpack(0);
+    CHECK(out.movingDistance == LD2412PackedFrame::MAX_DISTANCE);
+    CHECK(out.movingEnergy == LD2412PackedFrame::MAX_ENERGY);
+    CHECK(out.staticDistance == LD2412PackedFrame::MAX_DISTANCE);
+    CHECK(out.staticEnergy == LD2412PackedFrame::MAX_ENERGY);
+    CHECK(out.timestamp == LD2412PackedFrame::MAX_DELTA);
+}
+
+TEST(frame_pack_delta_across_millis_wrap) {
+    LD2412Frame f = {1, 100, 50, 0, 0, 40};
+    LD2412PackedFrame packed = LD2412PackedFrame::pack(f, 0xFFFFFFF0ul);
+    CHECK(packed.delta() == 56);
+    CHECK(packed.unpack(0xFFFFFFF0ul).timestamp == 40);
+}
+
+TEST(frame_read_keeps_capture_time) {
+    MemoryStream stream;
+    LD2412 radar(stream);
+    stream.feed({0xF4, 0xF3, 0xF2, 0xF1, 0x0B, 0x00, 0x02, 0xAA, 0x02, 0x00, 0x00, 0x00,
+                 0xB4, 0x00, 0x46, 0x55, 0x00, 0xF8, 0xF7, 0xF6, 0xF5});
+    delay(250);
+
+    LD2412Frame f;
+    REQUIRE(radar.readFrame(f));
+    CHECK(f.state == 2);
+    CHECK(f.staticDistance == 180);
+    CHECK(f.staticEnergy == 70);
+    CHECK(f.timestamp == 250);
+
+    //No new frame: the retained one and its capture time stay
+    delay(100);
+    REQUIRE(radar.readFrame(f));
+    CHECK(f.staticDistance == 180);
+    CHECK(f.timestamp == 250);
+}
@@ -0,0 +1,95 @@
+/**
+ * @file test_frame_ring.cpp
+ * @author Trent Tobias
+ * @brief Shared-memory frame ring: independent cursors, zero-copy reads and overrun detection
+ */
+
+#include "TestHarness.h"
+
+#include <FrameRing.h>
+#include <ctime>
+#include <string>
+#include <unistd.h>
+
+namespace {
+    std::string ringName() {
+        return "/ld2412_test_" + std::to_string(getpid());
+    }
+
+    FrameRecord record(uint16_t n) {
+        LD2412Frame f = {static_cast<uint8_t>(n & 3), n, 10, 0, 0, 0};
+        return FrameRecord::from(n % 4, f, n);
+    }
+}
+
+TEST(frame_ring_independent_readers) {
+    std::string name = ringName();
+    FrameRing writer;
+    REQUIRE(writer.create(name.c_str(), 10));
+    CHECK(writer.capacity() == 16);
+
+    FrameRing consumer;
+    REQUIRE(consumer.attach(name.c_str()));
+    FrameRing::Reader early(consumer);
+    for (uint16_t i = 0; i < 5; i++)
+        writer.publish(record(i));
+    FrameRing::Reader late(consumer);
+    for (uint16_t i = 5; i < 8; i++)
+        writer.publish(record(i));
+
+    FrameRecord r;
+    for (uint16_t i = 0; i < 8; i++) {
+        REQUIRE(early.next(r));
+        CHECK(r.movingDistance == i);
+    }
+    CHECK(!early.next(r));
+
+    //Zero-copy: the record is read in place, then confirmed
+    const FrameRecord* p = late.peek();
+    REQUIRE(p != nullptr);
+    CHECK(p->movingDistance == 5);
+    CHECK(late.release());
+    CHECK(late.cursor() == 6);
+    CHECK(early.lost() == 0 && late.lost() == 0);
+
+    FrameRing::unlink(name.c_str());
+}
+
+TEST(frame_ring_detects_overrun) {
+    std::string name = ringName();
+    FrameRing writer;
+    REQUIRE(writer.create(name.c_str(), 8));
+    FrameRing::Reader reader(writer);
+
+    for (uint16_t i = 0; i < 20; i++)
+        writer.publish(record(i));
+    FrameRecord r;
+    REQUIRE(reader.next(r));
+    CHECK(reader.lost() == 12);
+    CHECK(r.movingDistance == 12);
+
+    //A record overwritten while held zero-copy fails release()
+    const FrameRecord* p = reader.peek();
+    REQUIRE(p != nullptr);
+    for (uint16_t i = 20; i < 30; i++)
+        writer.publish(record(i));
+    CHECK(!reader.release());
+    CHECK(reader.lost() == 13);
+
+    FrameRing::unlink(name.c_str());
+}
+
+TEST(frame_ring_rejects_missing_ring) {
+    FrameRing ring;
+    CHECK(!ring.attach("/ld2412_test_missing"));
+    FrameRing::Reader reader(ring);
+    FrameRecord r;
+    CHECK(!reader.next(r));
+}
+
+TEST(frame_record_timestamps_are_unix_epoch) {
+    uint64_t before = static_cast<uint64_t>(std::time(nullptr)) * 1000000;
+    uint64_t now = FrameRecord::nowUs();
+    uint64_t after = static_cast<uint64_t>(std::time(nullptr) + 1) * 1000000;
+    CHECK(now >= before && now < after);
+}
@@ -0,0 +1,186 @@
+/**
+ * @file test_frame_server.cpp
+ * @author Trent Tobias
+ * @brief Frame socket server: batched delivery, and slow subscribers dropping only their own frames
+ */
+
+#include "TestHarness.h"
+
+#include <FrameServer.h>
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+    std::string socketPath() {
+        return "/tmp/ld2412_test_" + std::to_string(getpid()) + ".sock";
+    }
+
+    int connectTo(const std::string& path, const char* policyLine = nullptr) {
+        sockaddr_un addr = {};
+        addr.sun_family = AF_UNIX;
+        std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+        int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0);
+        if (fd >= 0 && connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+            close(fd);
+            return -1;
+        }
+        if (fd >= 0 && policyLine != nullptr && write(fd, policyLine, std::strlen(policyLine)) < 0) {
+            close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    FrameRecord record(uint16_t n) {
+        LD2412Frame f = {1, n, 10, 0, 0, 0};
+        return FrameRecord::from(0, f, n);
+    }
+
+    //Reads everything currently buffered and splits it into batches
+    struct Received {
+        std::vector<FrameRecord> records;
+        unsigned int batches = 0;
+        uint64_t dropped = 0;
+        bool valid = true;
+    };
+
+    void drain(int fd, Received& out) {
+        std::vector<uint8_t> bytes;
+        uint8_t buf[4096];
+        ssize_t n;
+        while ((n = read(fd, buf, sizeof(buf))) > 0)
+            bytes.insert(bytes.end(), buf, buf + n);
+
+        size_t pos = 0;
+        while (pos + sizeof(FrameBatchHeader) <= bytes.size()) {
+            FrameBatchHeader h;
+            std::memcpy(&h, &bytes[pos], sizeof(h));
+            if (h.magic != FrameBatchHeader::MAGIC || h.recordSize != sizeof(FrameRecord)) {
+                out.valid = false;
+                return;
+            }
+            pos += sizeof(h);
+            out.batches++;
+            out.dropped += h.dropped;
+            for (uint16_t i = 0; i < h.count && pos + sizeof(FrameRecord) <= bytes.size(); i++) {
+                FrameRecord r;
+                std::memcpy(&r, &bytes[pos], sizeof(r));
+                out.records.push_back(r);
+                pos += sizeof(r);
+            }
+        }
+        if (pos != bytes.size())
+            out.valid = false;
+    }
+}
+
+TEST(frame_server_batches_frames) {
+    std::string path = socketPath();
+    FrameServer server;
+    REQUIRE(server.listen(path.c_str(), FrameServer::SlowPolicy::DropOldest));
+    int fd = connectTo(path);
+    REQUIRE(fd >= 0);
+    server.poll();
+    CHECK(server.subscribers() == 1);
+
+    for (uint16_t i = 0; i < 100; i++)
+        server.publish(record(i));
+    server.poll();
+
+    Received got;
+    drain(fd, got);
+    CHECK(got.valid);
+    REQUIRE(got.records.size() == 100);
+    CHECK(got.batches == 2);
+    CHECK(got.dropped == 0);
+    for (uint16_t i = 0; i < 100; i++)
+        CHECK(got.records[i].movingDistance == i);
+
+    close(fd);
+    server.poll();
+    CHECK(server.subscribers() == 0);
+    server.close();
+    CHECK(access(path.c_str(), F_OK) != 0);
+}
+
+TEST(frame_server_slow_subscriber_drops_oldest) {
+    std::string path = socketPath();
+    FrameServer server;
+    REQUIRE(server.listen(path.c_str(), FrameServer::SlowPolicy::DropOldest));
+    int slow = connectTo(path);
+    int fast = connectTo(path);
+    REQUIRE(slow >= 0 && fast >= 0);
+    server.poll();
+    REQUIRE(server.subscribers() == 2);
+
+    //The slow subscriber never reads; publishing and polling must still not block
+    const uint16_t total = 20000;
+    Received fastGot;
+    for (uint16_t i = 0; i < total; i++) {
+        server.publish(record(i));
+        if (i % 32 == 0) {
+            server.poll();
+            drain(fast, fastGot);
+        }
+    }
+    server.poll();
+    drain(fast, fastGot);
+    CHECK(fastGot.valid);
+    CHECK(fastGot.records.size() == total);
+    CHECK(fastGot.dropped == 0);
+    CHECK(server.dropped() > 0);
+
+    //Once it catches up, it sees the newest frames and how many it missed
+    Received slowGot;
+    for (int i = 0; i < 100; i++) {
+        drain(slow, slowGot);
+        server.poll();
+    }
+    drain(slow, slowGot);
+    CHECK(slowGot.valid);
+    REQUIRE(!slowGot.records.empty());
+    CHECK(slowGot.records.back().movingDistance == total - 1);
+    CHECK(slowGot.records.size() + slowGot.dropped == total);
+
+    close(slow);
+    close(fast);
+}
+
+TEST(frame_server_decimates_on_request) {
+    std::string path = socketPath();
+    FrameServer server;
+    REQUIRE(server.listen(path.c_str(), FrameServer::SlowPolicy::DropOldest));
+    int fd = connectTo(path, "policy=decimate\n");
+    REQUIRE(fd >= 0);
+    server.poll();
+    server.poll();
+
+    //Backed up: later frames are thinned out instead of the oldest being lost
+    for (uint16_t i = 0; i < FrameServer::QUEUE_SIZE; i++)
+        server.publish(record(i));
+    Received got;
+    for (int i = 0; i < 100; i++) {
+        server.poll();
+        drain(fd, got);
+    }
+    CHECK(got.valid);
+    REQUIRE(!got.records.empty());
+    CHECK(got.records.front().movingDistance == 0);
+    CHECK(got.dropped > 0);
+    CHECK(got.records.size() + got.dropped == FrameServer::QUEUE_SIZE);
+
+    //Drained: every frame again
+    for (uint16_t i = 0; i < 10; i++)
+        server.publish(record(i));
+    Received after;
+    server.poll();
+    drain(fd, after);
+    CHECK(after.records.size() == 10);
+    CHECK(after.dropped == 0);
+    close(fd);
+}
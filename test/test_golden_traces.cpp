@@ -0,0 +1,293 @@
+/**
+ * @file test_golden_traces.cpp
+ * @author Trent Tobias
+ * @brief Replays the golden byte traces in test/traces through the library.
+ *
+ * Trace format, one directive per line ('#' starts a comment):
+ *   call <api> [args]   Starts a call block, the API is invoked once the block is complete
+ *   tx <hex bytes>      Bytes the library must write next
+ *   rx [+ms] <hex>      Bytes the sensor sends, fed when the preceding tx completes
+ *                       (or at call start) and delivered ms later on the virtual clock
+ *   expect <values>     Expected result ("null" for a nullptr return)
+ *   budget [ms=N] [ns=N] Max virtual time of the call and max host time spent in it
+ *   advance <ms>        Moves the virtual clock between calls
+ */
+
+#include "TestHarness.h"
+
+#include <HostStreams.h>
+#include <LD2412.h>
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <sstream>
+#include <string>
+
+namespace {
+    struct Step {
+        bool tx;
+        uint64_t delayUs;
+        std::vector<uint8_t> bytes;
+    };
+
+    struct Call {
+        int line = 0;
+        std::string api;
+        std::vector<long> args;
+        std::vector<Step> wire;
+        std::string expect;
+        long budgetMs = -1;
+        long budgetNs = -1;
+        unsigned long advanceMsBefore = 0;
+    };
+
+    struct Trace {
+        std::string path;
+        std::vector<Call> calls;
+    };
+
+    //Byte-exact replay of a call's wire script against what the library writes
+    class Replay {
+    public:
+        Replay(MemoryStream& stream, const std::vector<Step>& wire) : stream(stream), wire(wire) {
+            feedResponses();
+            stream.onWrite([this](const uint8_t* data, size_t len) { onWrite(data, len); });
+        }
+
+        ~Replay() {
+            this->stream.onWrite(nullptr);
+        }
+
+        bool complete() const { return this->step == this->wire.size(); }
+        const std::string& error() const { return this->mismatch; }
+
+    private:
+        MemoryStream& stream;
+        const std::vector<Step>& wire;
+        size_t step = 0;
+        size_t offset = 0;
+        std::string mismatch;
+
+        void feedResponses() {
+            while (this->step < this->wire.size() && !this->wire[this->step].tx) {
+                this->stream.feed(this->wire[this->step].bytes, this->wire[this->step].delayUs);
+                this->step++;
+            }
+        }
+
+        void onWrite(const uint8_t* data, size_t len) {
+            for (size_t i = 0; i < len; i++) {
+                if (!this->mismatch.empty())
+                    return;
+                if (this->step >= this->wire.size()) {
+                    this->mismatch = "unexpected extra tx bytes";
+                    return;
+                }
+                const Step& s = this->wire[this->step];
+                if (s.bytes[this->offset] != data[i]) {
+                    char msg[96];
+                    std::snprintf(msg, sizeof(msg), "tx byte %zu of step %zu: got %02X, want %02X",
+                                  this->offset, this->step, data[i], s.bytes[this->offset]);
+                    this->mismatch = msg;
+                    return;
+                }
+                if (++this->offset == s.bytes.size()) {
+                    this->offset = 0;
+                    this->step++;
+                    feedResponses();
+                }
+            }
+        }
+    };
+
+    std::vector<uint8_t> parseHex(std::istringstream& in) {
+        std::vector<uint8_t> bytes;
+        std::string tok;
+        while (in >> tok)
+            bytes.push_back(static_cast<uint8_t>(std::stoul(tok, nullptr, 16)));
+        return bytes;
+    }
+
+    Trace loadTrace(const std::string& path) {
+        Trace trace{path, {}};
+        std::ifstream file(path);
+        std::string line;
+        unsigned long advance = 0;
+
+        for (int n = 1; std::getline(file, line); n++) {
+            line = line.substr(0, line.find('#'));
+            std::istringstream in(line);
+            std::string directive;
+            if (!(in >> directive))
+                continue;
+
+            if (directive == "call") {
+                Call call;
+                call.line = n;
+                in >> call.api;
+                std::string arg;
+                while (in >> arg)
+                    call.args.push_back(arg == "array" ? -1 : std::stol(arg));
+                call.advanceMsBefore = advance;
+                advance = 0;
+                trace.calls.push_back(call);
+            }
+            else if (directive == "advance") {
+                in >> advance;
+            }
+            else if (trace.calls.empty()) {
+                test::fail(path.c_str(), n, "directive before first call");
+            }
+            else if (directive == "tx") {
+                trace.calls.back().wire.push_back({true, 0, parseHex(in)});
+            }
+            else if (directive == "rx") {
+                uint64_t delayUs = 0;
+                if (in >> std::ws; in.peek() == '+') {
+                    in.get();
+                    unsigned long ms;
+                    in >> ms;
+                    delayUs = ms * 1000ull;
+                }
+                trace.calls.back().wire.push_back({false, delayUs, parseHex(in)});
+            }
+            else if (directive == "expect") {
+                std::getline(in >> std::ws, trace.calls.back().expect);
+                while (!trace.calls.back().expect.empty() && std::isspace(trace.calls.back().expect.back()))
+                    trace.calls.back().expect.pop_back();
+            }
+            else if (directive == "budget") {
+                std::string tok;
+                while (in >> tok) {
+                    if (tok.rfind("ms=", 0) == 0)
+                        trace.calls.back().budgetMs = std::stol(tok.substr(3));
+                    else if (tok.rfind("ns=", 0) == 0)
+                        trace.calls.back().budgetNs = std::stol(tok.substr(3));
+                }
+            }
+            else {
+                test::fail(path.c_str(), n, ("unknown directive " + directive).c_str());
+            }
+        }
+        return trace;
+    }
+
+    std::string join(const int* values, int count) {
+        if (values == nullptr)
+            return "null";
+        std::string out;
+        for (int i = 0; i < count; i++)
+            out += (i ? " " : "") + std::to_string(values[i]);
+        return out;
+    }
+
+    using Api = std::function<std::string(LD2412&, const std::vector<long>&)>;
+
+    const std::map<std::string, Api>& apis() {
+        static const std::map<std::string, Api> table = {
+            {"enterCalibrationMode", [](LD2412& r, auto&) { return std::to_string(r.enterCalibrationMode()); }},
+            {"checkCalibrationMode", [](LD2412& r, auto&) { return std::to_string(r.checkCalibrationMode()); }},
+            {"readFirmwareVersion", [](LD2412& r, auto&) { return join(r.readFirmwareVersion(), 3); }},
+            {"resetDeviceSettings", [](LD2412& r, auto&) { return std::to_string(r.resetDeviceSettings()); }},
+            {"restartModule", [](LD2412& r, auto&) { return std::to_string(r.restartModule()); }},
+            {"setParamConfig", [](LD2412& r, auto& a) {
+                return std::to_string(r.setParamConfig(a.at(0), a.at(1), a.at(2), a.at(3)));
+            }},
+            {"setMotionSensitivity", [](LD2412& r, auto& a) { return std::to_string(r.setMotionSensitivity(a.at(0))); }},
+            {"setStaticSensitivity", [](LD2412& r, auto& a) { return std::to_string(r.setStaticSensitivity(a.at(0))); }},
+            {"setBaudRate", [](LD2412& r, auto& a) { return std::to_string(r.setBaudRate(a.at(0))); }},
+            {"getParamConfig", [](LD2412& r, auto&) { return join(r.getParamConfig(), 5); }},
+            {"getMotionSensitivity", [](LD2412& r, auto& a) {
+                return a.empty() ? std::to_string(r.getMotionSensitivity()) : join(r.getMotionSensitivity(RETURN_ARRAY), 14);
+            }},
+            {"getStaticSensitivity", [](LD2412& r, auto& a) {
+                return a.empty() ? std::to_string(r.getStaticSensitivity()) : join(r.getStaticSensitivity(RETURN_ARRAY), 14);
+            }},
+            {"setLazyDecode", [](LD2412& r, auto& a) {
+                r.setLazyDecode(a.at(0));
+                return std::to_string(r.getLazyDecode());
+            }},
+            {"report", [](LD2412& r, auto&) {
+                int values[] = {r.targetState(), r.movingDistance(), r.movingEnergy(), r.staticDistance(), r.staticEnergy()};
+                return join(values, 5);
+            }},
+        };
+        return table;
+    }
+
+    //Replays a trace once; returns the host time spent in each call
+    std::vector<long> replay(const Trace& trace, bool report) {
+        host::setClock(0);
+        MemoryStream stream;
+        LD2412 radar(stream);
+        std::vector<long> costs;
+
+        for (const Call& call : trace.calls) {
+            auto api = apis().find(call.api);
+            if (api == apis().end()) {
+                test::fail(trace.path.c_str(), call.line, ("unknown api " + call.api).c_str());
+                costs.push_back(0);
+                continue;
+            }
+            delay(call.advanceMsBefore);
+
+            Replay wire(stream, call.wire);
+            uint64_t virtualStart = host::nowMicros();
+            auto start = std::chrono::steady_clock::now();
+            std::string result = api->second(radar, call.args);
+            costs.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count());
+            uint64_t virtualMs = (host::nowMicros() - virtualStart) / 1000;
+
+            if (!report)
+                continue;
+            auto check = [&](bool ok, const std::string& what) {
+                if (!ok)
+                    test::fail(trace.path.c_str(), call.line, (call.api + ": " + what).c_str());
+            };
+            check(wire.error().empty(), wire.error());
+            check(wire.complete(), "wire script not fully consumed");
+            check(result == call.expect, "got \"" + result + "\", want \"" + call.expect + "\"");
+            check(call.budgetMs < 0 || static_cast<long>(virtualMs) <= call.budgetMs,
+                  "took " + std::to_string(virtualMs) + " virtual ms, budget " + std::to_string(call.budgetMs));
+        }
+        return costs;
+    }
+
+    std::vector<std::string> traceFiles() {
+        std::vector<std::string> paths;
+        for (const auto& entry : std::filesystem::directory_iterator(LD2412_TRACE_DIR))
+            if (entry.path().extension() == ".trace")
+                paths.push_back(entry.path().string());
+        std::sort(paths.begin(), paths.end());
+        return paths;
+    }
+}
+
+TEST(golden_traces) {
+    std::vector<std::string> paths = traceFiles();
+    REQUIRE(!paths.empty());
+
+    for (const std::string& path : paths) {
+        Trace trace = loadTrace(path);
+        CHECK(!trace.calls.empty());
+        std::vector<long> best = replay(trace, true);
+
+        //Host timing is noisy; the best of a few replays is held to the budget
+        for (int run = 0; run < 4; run++) {
+            std::vector<long> costs = replay(trace, false);
+            for (size_t i = 0; i < costs.size(); i++)
+                best[i] = std::min(best[i], costs[i]);
+        }
+        for (size_t i = 0; i < trace.calls.size(); i++) {
+            const Call& call = trace.calls[i];
+            if (call.budgetNs >= 0 && best[i] > call.budgetNs)
+                test::fail(path.c_str(), call.line, (call.api + ": took " + std::to_string(best[i]) +
+                           " ns, budget " + std::to_string(call.budgetNs)).c_str());
+        }
+    }
+}
@@ -0,0 +1,172 @@
+/**
+ * @file test_health.cpp
+ * @author Trent Tobias
+ * @brief Interference and sensor-health signatures, score and anomaly events
+ */
+
+#include "TestFeed.h"
+#include "TestHarness.h"
+
+#include <FaultyStream.h>
+#include <LD2412.h>
+#include <LD2412Health.h>
+#include <SimulatedSensor.h>
+
+namespace {
+    struct Event {
+        uint8_t anomaly;
+        bool active;
+    };
+
+    /**
+     * @brief Someone walking about at 10 Hz, as a healthy module reports it
+     */
+    class Feed : public test::FrameFeed {
+    public:
+        LD2412Health health;
+        LD2412Stats stats;
+        test::Recorder<Event> events;
+
+        Feed() : FrameFeed([this](const LD2412Frame& f) { this->health.update(f, this->stats); }) {
+            this->health.setCallback(this->events.record);
+        }
+
+        void walk(unsigned int frames) {
+            for (unsigned int i = 0; i < frames; i++, this->n++)
+                frame(person());
+        }
+
+        LD2412Frame person() {
+            //Up and down the room at 30 cm/s
+            int k = static_cast<int>(this->n % 200);
+            int distance = 150 + (k < 100 ? k : 200 - k) * 3;
+            return {1, static_cast<uint16_t>(distance + test::wobble(this->n)), static_cast<uint8_t>(60 + test::wobble(this->n + 3)), 0, 0, 0};
+        }
+
+        unsigned int n = 0;
+    };
+}
+
+TEST(health_stays_clean_for_a_healthy_module) {
+    Feed feed;
+    feed.walk(3000);
+    CHECK(feed.health.anomalies() == 0);
+    CHECK(feed.health.score() >= 95);
+    CHECK(feed.events.empty());
+    CHECK(feed.health.rate(LD2412Health::DISTANCE_JUMPS) == 0);
+}
+
+TEST(health_flags_interference) {
+    Feed feed;
+    feed.walk(600);
+
+    //A neighbouring radar: most gates rail and the target jumps between ghosts
+    LD2412GateEnergies railed = {};
+    for (unsigned int g = 0; g < 10; g++)
+        railed.moving[g] = 100;
+    for (unsigned int i = 0; i < 1200; i++, feed.n++) {
+        LD2412Frame f = feed.person();
+        if (i % 3 == 0) {
+            feed.health.update(railed);
+            f.movingDistance = static_cast<uint16_t>(f.movingDistance + (i % 2 ? 400 : 250));
+        }
+        feed.frame(f);
+    }
+    CHECK(feed.health.anomalies() & LD2412Health::SATURATION);
+    CHECK(feed.health.anomalies() & LD2412Health::DISTANCE_JUMPS);
+    CHECK(feed.health.score() <= 60);
+    REQUIRE(feed.events.size() == 2);
+    CHECK(feed.events[0].active && feed.events[1].active);
+
+    //Neighbour switched off
+    feed.walk(3000);
+    CHECK(feed.health.anomalies() == 0);
+    CHECK(feed.health.score() >= 95);
+    REQUIRE(feed.events.size() == 4);
+    CHECK(!feed.events[2].active && !feed.events[3].active);
+}
+
+TEST(health_flags_stuck_module) {
+    Feed feed;
+    feed.walk(100);
+    LD2412Frame frozen = {2, 0, 0, 230, 45, 0};
+    for (unsigned int i = 0; i < 290; i++)
+        feed.frame(frozen);
+    CHECK(feed.health.anomalies() == 0);
+    for (unsigned int i = 0; i < 20; i++)
+        feed.frame(frozen);
+    CHECK(feed.health.anomalies() == LD2412Health::STUCK);
+    CHECK(feed.health.rate(LD2412Health::STUCK) == 1000);
+    CHECK(feed.health.score() <= 60);
+
+    feed.walk(1);
+    CHECK(feed.health.anomalies() == 0);
+
+    //An empty room reporting nothing for hours is fine
+    for (unsigned int i = 0; i < 1000; i++)
+        feed.frame({0, 0, 0, 0, 0, 0});
+    CHECK(feed.health.anomalies() == 0);
+}
+
+TEST(health_flags_irregular_frame_rate) {
+    Feed feed;
+    feed.walk(300);
+    //Frames arriving in bursts with long gaps
+    for (unsigned int i = 0; i < 300; i++, feed.n++)
+        feed.frame(feed.person(), i % 4 == 3 ? 340 : 20);
+    CHECK(feed.health.anomalies() == LD2412Health::FRAME_RATE);
+    CHECK(feed.health.rate(LD2412Health::FRAME_RATE) >= 300);
+
+    feed.walk(300);
+    CHECK(feed.health.anomalies() == 0);
+}
+
+TEST(health_ignores_repeated_frames) {
+    //Every frame readFrame() returns, polled every 10 ms from a healthy 10 Hz module
+    MemoryStream stream;
+    SimulatedSensor sensor(stream);
+    LD2412 radar(stream);
+    LD2412Health health;
+    LD2412Frame frame;
+    for (unsigned int i = 0; i < 3000; i++) {
+        if (i % 10 == 0)
+            sensor.report({1, static_cast<uint16_t>(200 + test::wobble(i / 10)), 50, 0, 0, 0});
+        delay(10);
+        if (radar.readFrame(frame))
+            health.update(frame, radar.getStats());
+    }
+    CHECK(health.anomalies() == 0);
+    CHECK(health.rate(LD2412Health::FRAME_RATE) < 100);
+    CHECK(health.score() >= 95);
+}
+
+TEST(health_flags_line_noise) {
+    //Lets the parser's resync loop time out on the virtual clock
+    host::setClockStep(10);
+    MemoryStream inner;
+    FaultyStream noisy(inner, 7);
+    SimulatedSensor sensor(inner);
+    LD2412 radar(noisy);
+    LD2412Health health;
+    LD2412Frame frame;
+    unsigned long last = 0;
+
+    for (int phase = 0; phase < 2; phase++) {
+        FaultyStream::Faults faults;
+        faults.garbage = phase == 0 ? 0 : 0.01;
+        noisy.setFaults(faults);
+        for (unsigned int i = 0; i < 1500; i++) {
+            sensor.report({1, static_cast<uint16_t>(200 + i % 7), 50, 0, 0, 0});
+            delay(100);
+            if (radar.readFrame(frame) && frame.timestamp != last) {
+                last = frame.timestamp;
+                health.update(frame, radar.getStats());
+            }
+        }
+        if (phase == 0)
+            CHECK(health.anomalies() == 0);
+    }
+    CHECK(radar.getStats().resyncs > 0);
+    CHECK(health.anomalies() & LD2412Health::RESYNCS);
+    CHECK(health.score() < 100);
+}
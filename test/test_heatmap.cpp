@@ -0,0 +1,138 @@
+/**
+ * @file test_heatmap.cpp
+ * @author Trent Tobias
+ * @brief Per-gate occupancy heatmap: counting, time buckets, halving, saturation and export
+ */
+
+#include "TestHarness.h"
+
+#include <HostStreams.h>
+#include <LD2412Heatmap.h>
+#include <string>
+
+namespace {
+    constexpr unsigned long HOUR = 3600000;
+}
+
+TEST(heatmap_counts_distances_per_bucket) {
+    LD2412Heatmap map;
+    //millis() = 0 was 08:00
+    map.setTimeOffset(8 * HOUR);
+    CHECK(map.bucketOf(0) == 8);
+    CHECK(map.bucketOf(17 * HOUR) == 1);
+
+    //Desk at 2 m in the morning, walkway at 4 m after lunch
+    for (unsigned long t = 0; t < HOUR; t += 100)
+        map.update(LD2412Frame{2, 0, 0, 200, 40, t});
+    for (unsigned long t = 5 * HOUR; t < 5 * HOUR + 600000; t += 100)
+        map.update(LD2412Frame{3, 310, 60, 200, 40, t});
+    //Seconds with a target, not frames
+    CHECK(map.count(LD2412Heatmap::STATIONARY, 2, 8) == 3600);
+    CHECK(map.count(LD2412Heatmap::STATIONARY, 2, 13) == 600);
+    CHECK(map.count(LD2412Heatmap::MOVING, 4, 13) == 600);
+    CHECK(map.count(LD2412Heatmap::MOVING, 4, 8) == 0);
+    CHECK(map.gateTotal(LD2412Heatmap::STATIONARY, 2) == 4200);
+    CHECK(map.gateTotal(LD2412Heatmap::MOVING, 2) == 0);
+
+    //Beyond the last gate counts there
+    map.update(LD2412Frame{1, 3000, 50, 0, 0, 6 * HOUR});
+    CHECK(map.count(LD2412Heatmap::MOVING, 13, 14) == 1);
+    CHECK(map.count(LD2412Heatmap::MOVING, 14, 14) == 0);
+}
+
+TEST(heatmap_counts_gate_energies) {
+    LD2412Heatmap map;
+    map.setThresholds(20, 40);
+    LD2412GateEnergies e = {};
+    e.moving[1] = 20;
+    e.moving[2] = 19;
+    e.stationary[5] = 45;
+    e.stationary[6] = 39;
+    e.timestamp = 2 * HOUR + 5;
+    map.update(e);
+    CHECK(map.count(LD2412Heatmap::MOVING, 1, 2) == 1);
+    CHECK(map.count(LD2412Heatmap::MOVING, 2, 2) == 0);
+    CHECK(map.count(LD2412Heatmap::STATIONARY, 5, 2) == 1);
+    CHECK(map.count(LD2412Heatmap::STATIONARY, 6, 2) == 0);
+}
+
+TEST(heatmap_desk_all_day_does_not_saturate) {
+    LD2412Heatmap map;
+    //Three weeks of someone at the desk around the clock, 10 Hz
+    for (unsigned long t = 0; t < 21 * 24 * HOUR; t += 100)
+        map.update(LD2412Frame{2, 0, 0, 200, 40, t});
+    uint16_t count = map.count(LD2412Heatmap::STATIONARY, 2, 5);
+    CHECK(count > 7 * 3600 && count < 14 * 3600);
+    CHECK(count < UINT16_MAX);
+}
+
+TEST(heatmap_saturates_and_halves) {
+    LD2412Heatmap map;
+    map.setBucketLength(1000);
+    map.setHalvingPeriod(0);
+    //70000 frames in the same bucket, a few per second
+    for (unsigned long i = 0; i < 70000; i++)
+        for (unsigned long k = 0; k < 3; k++)
+            map.update(LD2412Frame{1, 100, 50, 0, 0, i * 24000 + k * 100});
+    CHECK(map.count(LD2412Heatmap::MOVING, 1, 0) == UINT16_MAX);
+
+    //A week later everything is halved
+    map.setHalvingPeriod(LD2412Heatmap::HALVING_MS);
+    unsigned long t = 70000 * 24000UL;
+    map.update(LD2412Frame{0, 0, 0, 0, 0, t});
+    CHECK(map.count(LD2412Heatmap::MOVING, 1, 0) == UINT16_MAX / 2);
+
+    map.setHalvingPeriod(0);
+    map.update(LD2412Frame{0, 0, 0, 0, 0, t + 10 * LD2412Heatmap::HALVING_MS});
+    CHECK(map.count(LD2412Heatmap::MOVING, 1, 0) == UINT16_MAX / 2);
+
+    map.reset();
+    CHECK(map.gateTotal(LD2412Heatmap::MOVING, 1) == 0);
+}
+
+TEST(heatmap_hours_survive_millis_rollover) {
+    LD2412Heatmap map;
+    map.setHalvingPeriod(0);
+    //millis() = 0 was 08:00, 2^32 ms is not a whole number of days
+    map.setTimeOffset(8 * HOUR);
+    unsigned long t = 0;
+    for (; t < 0xFFFFFFFFUL - HOUR; t += HOUR)
+        map.update(LD2412Frame{0, 0, 0, 0, 0, t});
+    CHECK(map.bucketOf(t) == (8 + t / HOUR) % 24);
+
+    //A desk at 2 m every morning at 09:00, across the rollover
+    uint64_t clock = t;
+    for (int day = 0; day < 3; day++) {
+        uint64_t nine = (clock / (24 * HOUR) + 1) * 24 * HOUR + HOUR;
+        for (; clock < nine; clock += HOUR)
+            map.update(LD2412Frame{0, 0, 0, 0, 0, static_cast<unsigned long>(static_cast<uint32_t>(clock))});
+        clock = nine;
+        map.update(LD2412Frame{2, 0, 0, 200, 40, static_cast<unsigned long>(static_cast<uint32_t>(clock))});
+    }
+    CHECK(map.count(LD2412Heatmap::STATIONARY, 2, 9) == 3);
+    CHECK(map.gateTotal(LD2412Heatmap::STATIONARY, 2) == 3);
+
+    //Moving the offset later shifts the hours by the difference
+    map.setTimeOffset(10 * HOUR);
+    CHECK(map.bucketOf(static_cast<uint32_t>(clock)) == 11);
+}
+
+TEST(heatmap_exports_csv) {
+    LD2412Heatmap map;
+    MemoryStream out;
+    map.update(LD2412Frame{1, 80, 50, 0, 0, 0});
+    map.update(LD2412Frame{2, 0, 0, 1000, 50, 23 * HOUR});
+
+    size_t n = map.exportTo(out);
+    std::string csv(out.written().begin(), out.written().end());
+    CHECK(n == csv.size());
+    CHECK(csv.rfind("# ld2412 heatmap bucket_ms=3600000\nkind,gate,b0,b1,", 0) == 0);
+    CHECK(csv.find(",b23\n") != std::string::npos);
+    CHECK(csv.find("\nmoving,1,1,0,") != std::string::npos);
+    CHECK(csv.find("\nstatic,13,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1\n") != std::string::npos);
+    //Comment, header and 28 rows
+    size_t lines = 0;
+    for (char c : csv)
+        lines += c == '\n';
+    CHECK(lines == 30);
+}
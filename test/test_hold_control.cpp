@@ -0,0 +1,160 @@
+/**
+ * @file test_hold_control.cpp
+ * @author Trent Tobias
+ * @brief Confidence-driven hold time and unmanned duration updates
+ */
+
+#include "TestFeed.h"
+#include "TestHarness.h"
+
+#include <LD2412.h>
+#include <LD2412HoldControl.h>
+#include <SimulatedSensor.h>
+
+namespace {
+    /**
+     * @brief Frames at 10 Hz into a controller
+     */
+    class Room : public test::FrameFeed {
+    public:
+        LD2412HoldControl hold;
+        test::Recorder<bool> changes;
+
+        Room() : FrameFeed([this](const LD2412Frame& f) { this->hold.update(f); }) {
+            static const uint8_t MOTION[14] = {};
+            static const uint8_t STATIONARY[14] = {15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15};
+            this->hold.setCallback(this->changes.record);
+            this->hold.scoring().setSensitivities(MOTION, STATIONARY);
+        }
+
+        //Someone moving about clearly, steady distance
+        void person(unsigned long ms) {
+            for (unsigned long t = 0; t < ms; t += PERIOD)
+                frame({1, static_cast<uint16_t>(200 + (t / 100) % 3), 80, 0, 0, 0});
+        }
+
+        //Someone sitting still at the edge of detection: just above the sensitivity, jumpy and dropping out
+        void faint(unsigned long ms) {
+            for (unsigned long t = 0; t < ms; t += PERIOD) {
+                if (t / 100 % 3 == 2)
+                    frame({0, 0, 0, 0, 0, 0});
+                else
+                    frame({2, 0, 0, static_cast<uint16_t>(t / 100 % 2 ? 350 : 450), 20, 0});
+            }
+        }
+
+        //Returns the time until vacancy, or ms if still occupied
+        unsigned long empty(unsigned long ms) {
+            for (unsigned long t = 0; t < ms; t += PERIOD) {
+                frame({0, 0, 0, 0, 0, 0});
+                if (!this->hold.occupied())
+                    return t;
+            }
+            return ms;
+        }
+    };
+}
+
+TEST(hold_follows_confidence) {
+    Room room;
+    room.person(5000);
+    CHECK(room.hold.occupied());
+    CHECK(room.hold.confidence() == 100);
+    unsigned long released = room.empty(200000);
+    CHECK(released >= 4900 && released <= 5100);
+    REQUIRE(room.changes.size() == 2);
+    CHECK(room.changes[0] && !room.changes[1]);
+
+    //A faint presence dropping out for 40 s at a time still holds the room
+    Room still;
+    for (int i = 0; i < 5; i++) {
+        still.faint(3000);
+        CHECK(still.hold.confidence() >= 30 && still.hold.confidence() <= 40);
+        CHECK(still.empty(40000) == 40000);
+    }
+    CHECK(still.hold.occupied());
+    still.faint(3000);
+    unsigned long hold = still.hold.holdTime();
+    CHECK(hold >= 75000);
+    released = still.empty(200000);
+    CHECK(released + 200 >= hold && released <= hold);
+}
+
+TEST(hold_is_not_decided_by_the_last_frame) {
+    //Walks out clearly, the very last frame is weak and at another distance
+    Room room;
+    room.person(5000);
+    room.frame({2, 0, 0, 450, 17, 0});
+    CHECK(room.hold.confidence() >= 75);
+    unsigned long released = room.empty(200000);
+    CHECK(released <= 35000);
+}
+
+TEST(hold_lengthens_after_premature_vacancy) {
+    Room room;
+    room.person(5000);
+    unsigned long first = room.empty(200000);
+    CHECK(room.hold.bias() == 0);
+
+    //Back 10 s later: the vacancy was wrong
+    room.idle(10000);
+    room.person(5000);
+    CHECK(room.hold.bias() == LD2412HoldControl::BIAS_STEP);
+    unsigned long second = room.empty(200000);
+    CHECK(second > first + 15000);
+
+    //Stays empty: the bias goes back down
+    room.idle(LD2412HoldControl::RETURN_MS + 1000);
+    CHECK(room.hold.bias() == LD2412HoldControl::BIAS_STEP - LD2412HoldControl::BIAS_DECAY);
+}
+
+TEST(hold_takes_module_duration_off) {
+    Room room;
+    room.hold.setModuleDuration(10);
+    room.faint(3000);
+    unsigned long hold = room.hold.holdTime();
+    unsigned long released = room.empty(200000);
+    CHECK(released + 10000 + 200 >= hold && released + 10000 <= hold + 200);
+
+    room.hold.setModuleDuration(200);
+    room.person(5000);
+    CHECK(room.empty(1000) == 0);
+}
+
+TEST(hold_syncs_module_duration) {
+    MemoryStream stream;
+    SimulatedSensor sensor(stream);
+    LD2412 radar(stream);
+    Room room;
+    sensor.duration = 0;
+    sensor.minGate = 2;
+    sensor.maxGate = 7;
+    sensor.outPinPolarity = 1;
+
+    CHECK(room.hold.sync(radar, room.now) == 0);
+    room.faint(3000);
+    room.empty(200000);
+    uint8_t target = room.hold.recommendedDuration();
+    CHECK(target >= 80);
+
+    unsigned int commands = sensor.commands;
+    CHECK(room.hold.sync(radar, room.now) == 1);
+    //Enable, read, write, disable
+    CHECK(sensor.commands - commands == 4);
+    CHECK(sensor.duration == target);
+    CHECK(sensor.minGate == 2 && sensor.maxGate == 7 && sensor.outPinPolarity == 1);
+
+    //Behaviour changes: clear presence for a while
+    for (int i = 0; i < 4; i++) {
+        room.person(3000);
+        room.empty(200000);
+        room.idle(LD2412HoldControl::RETURN_MS);
+    }
+    CHECK(room.hold.recommendedDuration() + LD2412HoldControl::PUSH_STEP_S <= target);
+    //Rate-limited
+    CHECK(room.hold.sync(radar, room.now) == 0);
+    CHECK(sensor.duration == target);
+    CHECK(room.hold.sync(radar, room.now + LD2412HoldControl::PUSH_INTERVAL_MS) == 1);
+    CHECK(sensor.duration == room.hold.recommendedDuration());
+    CHECK(room.hold.sync(radar, room.now + 2 * LD2412HoldControl::PUSH_INTERVAL_MS) == 0);
+}
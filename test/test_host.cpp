@@ -0,0 +1,74 @@
+/**
+ * @file test_host.cpp
+ * @author Trent Tobias
+ * @brief Smoke tests for the host shim and the streams it provides
+ */
+
+#include "TestHarness.h"
+
+#include <HostStreams.h>
+#include <LD2412.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+    const std::vector<uint8_t> REPORT = {
+        0xF4, 0xF3, 0xF2, 0xF1, 0x0B, 0x00, 0x02, 0xAA,
+        0x03, 0x64, 0x00, 0x32, 0x2C, 0x01, 0x28,
+        0x55, 0x00, 0xF8, 0xF7, 0xF6, 0xF5
+    };
+}
+
+TEST(host_virtual_clock) {
+    CHECK(millis() == 0);
+    delay(1500);
+    CHECK(millis() == 1500);
+    CHECK(micros() == 1500000);
+
+    //millis() is 32-bit like on the boards
+    host::setClock((0xFFFFFFFFull + 10) * 1000);
+    CHECK(millis() == 9);
+}
+
+TEST(host_memory_stream_delivery) {
+    MemoryStream stream;
+    uint8_t bytes[] = {1, 2, 3};
+    stream.feed(bytes, 3, 2000);
+
+    CHECK(stream.available() == 0);
+    CHECK(stream.read() == -1);
+    delay(2);
+    CHECK(stream.available() == 3);
+    CHECK(stream.read() == 1);
+    CHECK(stream.peek() == 2);
+    CHECK(stream.pending() == 2);
+}
+
+TEST(host_report_frame_decodes) {
+    MemoryStream stream;
+    LD2412 radar(stream);
+    stream.feed(REPORT);
+
+    CHECK(radar.targetState() == 3);
+    CHECK(radar.movingDistance() == 100);
+    CHECK(radar.movingEnergy() == 50);
+    CHECK(radar.staticDistance() == 300);
+    CHECK(radar.staticEnergy() == 40);
+}
+
+TEST(host_pty_stream_roundtrip) {
+    PtyStream pty;
+    REQUIRE(pty.isOpen());
+    FdStream peer(::open(pty.slaveName().c_str(), O_RDWR | O_NOCTTY));
+    REQUIRE(peer.fd() >= 0);
+
+    peer.write(REPORT.data(), REPORT.size());
+    host::useVirtualClock(false);
+    unsigned long start = millis();
+    while (pty.available() < static_cast<int>(REPORT.size()) && millis() - start < 500)
+        delay(1);
+
+    REQUIRE(pty.available() == static_cast<int>(REPORT.size()));
+    for (uint8_t b : REPORT)
+        CHECK(pty.read() == b);
+}
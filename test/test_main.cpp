@@ -0,0 +1,33 @@
+/**
+ * @file test_main.cpp
+ * @author Trent Tobias
+ * @brief Runs every registered test case, or only those whose name contains argv[1]
+ */
+
+#include "TestHarness.h"
+
+#include <Arduino.h>
+#include <cstring>
+
+int main(int argc, char** argv) {
+    const char* filter = argc > 1 ? argv[1] : nullptr;
+    int run = 0;
+
+    for (const test::Case& c : test::registry()) {
+        if (filter != nullptr && std::strstr(c.name, filter) == nullptr)
+            continue;
+        int before = test::failures();
+
+        //Every case starts on a fresh virtual clock
+        host::useVirtualClock(true);
+        host::setClock(0);
+        host::setClockStep(0);
+        c.run();
+
+        std::printf("%s %s\n", test::failures() == before ? "[ OK ]" : "[FAIL]", c.name);
+        run++;
+    }
+
+    std::printf("%d test(s), %d failure(s)\n", run, test::failures());
+    return test::failures() == 0 ? 0 : 1;
+}
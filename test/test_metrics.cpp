@@ -0,0 +1,161 @@
+/**
+ * @file test_metrics.cpp
+ * @author Trent Tobias
+ * @brief Link health counters and their Prometheus exposition
+ */
+
+#include "TestHarness.h"
+
+#include <LD2412.h>
+#include <MetricsExporter.h>
+#include <SimulatedSensor.h>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+    const LD2412Frame FRAME = {1, 120, 40, 0, 0, 0};
+
+    bool contains(const std::string& text, const std::string& line) {
+        return text.find(line) != std::string::npos;
+    }
+}
+
+TEST(stats_count_frames_resyncs_and_errors) {
+    MemoryStream stream;
+    SimulatedSensor sensor(stream);
+    LD2412 radar(stream);
+
+    sensor.report(FRAME);
+    CHECK(radar.targetState() == 1);
+    delay(100);
+    stream.feed({0x00, 0x11});
+    sensor.report(FRAME);
+    CHECK(radar.targetState() == 1);
+    delay(100);
+    //Bad footer
+    stream.feed({0xF4, 0xF3, 0xF2, 0xF1, 0x0B, 0x00, 0x02, 0xAA, 0x01, 0x78, 0x00, 0x28,
+                 0x00, 0x00, 0x00, 0x55, 0x00, 0xF8, 0xF7, 0x00, 0xF5});
+    CHECK(radar.targetState() == -1);
+
+    const LD2412Stats& stats = radar.getStats();
+    CHECK(stats.frames == 2);
+    CHECK(stats.resyncs == 1);
+    CHECK(stats.frameErrors == 1);
+    CHECK(stats.frameInterval[1] == 1);
+    CHECK(stats.frameIntervalSum == 100);
+}
+
+TEST(stats_count_ack_latency_and_timeouts) {
+    MemoryStream stream;
+    SimulatedSensor sensor(stream);
+    LD2412 radar(stream);
+
+    REQUIRE(radar.getParamConfig() != nullptr);
+    const LD2412Stats& stats = radar.getStats();
+    //Enable, read, disable: each answered within the 20 ms settle delay
+    CHECK(stats.ackLatency[0] == 3);
+    CHECK(stats.ackTimeouts == 0);
+
+    stream.onWrite(nullptr);
+    CHECK(radar.readFirmwareVersion() == nullptr);
+    CHECK(stats.ackTimeouts == 2);
+}
+
+TEST(metrics_render_prometheus_text) {
+    MetricsExporter metrics({"/dev/ttyUSB0", "sim:\"1\""});
+    LD2412Stats stats;
+    stats.countFrame(1000);
+    stats.countFrame(1080);
+    stats.countAck(21);
+    stats.resyncs = 3;
+
+    MetricsExporter::Snapshot snap;
+    CHECK(!metrics.snapshot(0, snap));
+    metrics.publish(0, stats, 1100);
+    metrics.publish(0, stats, 2100);
+    REQUIRE(metrics.snapshot(0, snap));
+    CHECK(snap.stats.frames == 2);
+    CHECK(snap.stalled);
+
+    std::string text = metrics.render();
+    const std::string labels = "{sensor=\"0\",device=\"/dev/ttyUSB0\"";
+    CHECK(contains(text, "# TYPE ld2412_frames_total counter\n"));
+    CHECK(contains(text, "ld2412_frames_total" + labels + "} 2\n"));
+    CHECK(contains(text, "ld2412_resyncs_total" + labels + "} 3\n"));
+    CHECK(contains(text, "ld2412_ack_latency_ms_bucket" + labels + ",le=\"25\"} 1\n"));
+    CHECK(contains(text, "ld2412_frame_interval_ms_bucket" + labels + ",le=\"50\"} 0\n"));
+    CHECK(contains(text, "ld2412_frame_interval_ms_bucket" + labels + ",le=\"100\"} 1\n"));
+    CHECK(contains(text, "ld2412_frame_interval_ms_bucket" + labels + ",le=\"+Inf\"} 1\n"));
+    CHECK(contains(text, "ld2412_frame_interval_ms_sum" + labels + "} 80\n"));
+    CHECK(contains(text, "ld2412_frame_rate" + labels + "} 0\n"));
+    CHECK(contains(text, "ld2412_last_frame_age_ms" + labels + "} 1020\n"));
+    CHECK(contains(text, "ld2412_stalled" + labels + "} 1\n"));
+    //Nothing published for the second sensor yet
+    CHECK(!contains(text, "sensor=\"1\""));
+
+    stats.countFrame(2150);
+    metrics.publish(1, stats, 2160);
+    text = metrics.render();
+    CHECK(contains(text, "ld2412_stalled{sensor=\"1\",device=\"sim:\\\"1\\\"\"} 0\n"));
+}
+
+TEST(metrics_scrape_over_socket_and_file) {
+    std::string base = "/tmp/ld2412_metrics_" + std::to_string(getpid());
+    std::string socketPath = base + ".sock";
+    std::string filePath = base + ".prom";
+    MetricsExporter metrics({"sim:0"});
+    LD2412Stats stats;
+    stats.countFrame(10);
+    metrics.publish(0, stats, 20);
+    REQUIRE(metrics.start(socketPath.c_str(), filePath.c_str()));
+
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, socketPath.c_str(), sizeof(addr.sun_path) - 1);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    REQUIRE(fd >= 0);
+    REQUIRE(connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0);
+    std::string scraped;
+    char buf[1024];
+    ssize_t n;
+    while ((n = read(fd, buf, sizeof(buf))) > 0)
+        scraped.append(buf, n);
+    close(fd);
+    CHECK(contains(scraped, "ld2412_frames_total{sensor=\"0\",device=\"sim:0\"} 1\n"));
+
+    metrics.requestDump();
+    for (int i = 0; i < 50 && access(filePath.c_str(), F_OK) != 0; i++)
+        usleep(20000);
+    std::ifstream file(filePath);
+    std::stringstream written;
+    written << file.rdbuf();
+    CHECK(written.str() == metrics.render());
+
+    metrics.stop();
+    CHECK(access(socketPath.c_str(), F_OK) != 0);
+    unlink(filePath.c_str());
+}
+
+TEST(metrics_stall_and_rate_across_millis_wrap) {
+    MetricsExporter metrics({"sim:0"});
+    LD2412Stats stats;
+    const unsigned long beforeWrap = 0xFFFFFF00UL;
+    stats.countFrame(beforeWrap);
+    metrics.publish(0, stats, beforeWrap);
+    for (unsigned long t = beforeWrap + 100; t != beforeWrap + 1100; t += 100) {
+        stats.countFrame(static_cast<uint32_t>(t));
+        metrics.publish(0, stats, static_cast<uint32_t>(t));
+    }
+
+    MetricsExporter::Snapshot snap;
+    REQUIRE(metrics.snapshot(0, snap));
+    CHECK(!snap.stalled);
+    CHECK(snap.frameRate > 9.9 && snap.frameRate < 10.1);
+    CHECK(snap.stats.frameInterval[1] == 10);
+    CHECK(snap.stats.frameIntervalSum == 1000);
+}
@@ -0,0 +1,172 @@
+/**
+ * @file test_occupancy_index.cpp
+ * @author Trent Tobias
+ * @brief Occupancy interval index over frame logs, checked against a scan of the raw frames
+ */
+
+#include "TestHarness.h"
+
+#include <OccupancyIndex.h>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <unistd.h>
+
+namespace {
+    constexpr uint64_t FRAME_US = 100000;
+
+    /**
+     * @brief A day of 10 Hz frames from several sensors, interleaved, with random visits
+     * and a one-minute hole in sensor 1's log
+     */
+    std::vector<FrameRecord> dayLog(uint16_t sensors, uint32_t seed) {
+        std::mt19937 rng(seed);
+        std::vector<bool> present(sensors, false);
+        std::vector<FrameRecord> log;
+        for (uint64_t t = 0; t < 3600 * 10; t++)
+            for (uint16_t s = 0; s < sensors; s++) {
+                if (rng() % 200 == 0)
+                    present[s] = !present[s];
+                if (s == 1 && t >= 12000 && t < 12600)
+                    continue;
+                LD2412Frame f = {static_cast<uint8_t>(present[s] ? 1 : 0), 150, 40, 0, 0, 0};
+                log.push_back(FrameRecord::from(s, f, t * FRAME_US + s * 1000));
+            }
+        return log;
+    }
+
+    //What a reporting job would do without the index
+    uint64_t scanOccupied(const std::vector<FrameRecord>& log, uint16_t sensor, uint64_t t1, uint64_t t2) {
+        uint64_t total = 0;
+        const FrameRecord* previous = nullptr;
+        for (const FrameRecord& r : log) {
+            if (r.sensor != sensor)
+                continue;
+            if (previous != nullptr && previous->state != 0 && r.timestampUs - previous->timestampUs <= OccupancyIndex::MAX_GAP_US) {
+                uint64_t a = std::max(previous->timestampUs, t1);
+                uint64_t b = std::min(r.timestampUs, t2);
+                if (b > a)
+                    total += b - a;
+            }
+            previous = &r;
+        }
+        return total;
+    }
+
+    bool scanFirst(const std::vector<FrameRecord>& log, uint16_t sensor, uint64_t t, uint64_t& at) {
+        const FrameRecord* previous = nullptr;
+        for (const FrameRecord& r : log) {
+            if (r.sensor != sensor)
+                continue;
+            if (previous != nullptr && previous->state != 0 && r.timestampUs > t
+                && r.timestampUs - previous->timestampUs <= OccupancyIndex::MAX_GAP_US) {
+                at = std::max(previous->timestampUs, t);
+                return true;
+            }
+            previous = &r;
+        }
+        return false;
+    }
+}
+
+TEST(occupancy_index_matches_scan) {
+    std::vector<FrameRecord> log = dayLog(3, 5);
+    OccupancyIndex index;
+    index.build(log.data(), log.size(), 2);
+    REQUIRE(index.sensors() == 3);
+
+    std::mt19937 rng(9);
+    for (int q = 0; q < 200; q++) {
+        uint16_t sensor = q % 3;
+        uint64_t t1 = rng() % (3600ULL * 1000000);
+        uint64_t t2 = t1 + rng() % (600ULL * 1000000);
+        CHECK(index.occupiedTime(sensor, t1, t2) == scanOccupied(log, sensor, t1, t2));
+
+        uint64_t expected = 0, at = 0;
+        bool found = scanFirst(log, sensor, t1, expected);
+        CHECK(index.firstPresence(sensor, t1, at) == found);
+        if (found)
+            CHECK(at == expected);
+    }
+    CHECK(index.occupiedTime(0, 0, UINT64_MAX) == scanOccupied(log, 0, 0, UINT64_MAX));
+    CHECK(index.occupiedTime(0, 500, 500) == 0);
+
+    //The hole in sensor 1's log splits an interval or falls between two
+    for (const OccupancyIndex::Interval& interval : index.intervals(1))
+        CHECK(interval.endUs <= 1200 * 1000000ULL + 1000 || interval.startUs >= 1260 * 1000000ULL);
+}
+
+TEST(occupancy_index_parallel_build_is_deterministic) {
+    std::vector<FrameRecord> log = dayLog(8, 17);
+    OccupancyIndex single, parallel;
+    single.build(log.data(), log.size(), 1);
+    parallel.build(log.data(), log.size(), 8);
+    REQUIRE(single.sensors() == 8 && parallel.sensors() == 8);
+    for (size_t s = 0; s < 8; s++) {
+        const std::vector<OccupancyIndex::Interval>& a = single.intervals(s);
+        const std::vector<OccupancyIndex::Interval>& b = parallel.intervals(s);
+        REQUIRE(a.size() == b.size());
+        CHECK(!a.empty());
+        for (size_t i = 0; i < a.size(); i++)
+            CHECK(a[i].startUs == b[i].startUs && a[i].endUs == b[i].endUs);
+    }
+}
+
+TEST(occupancy_index_intervals_and_edges) {
+    std::vector<FrameRecord> log;
+    auto add = [&](uint16_t sensor, uint8_t state, uint64_t t) {
+        LD2412Frame f = {state, 100, 50, 0, 0, 0};
+        log.push_back(FrameRecord::from(sensor, f, t));
+    };
+    add(2, 0, 0);
+    add(2, 1, 1000);
+    add(2, 1, 2000);
+    add(2, 0, 3000);
+    add(2, 2, 4000);
+    add(2, 2, 5000);
+    //Log ends while occupied: ends at the last frame
+    OccupancyIndex index;
+    index.build(log.data(), log.size());
+    CHECK(index.sensors() == 3);
+    CHECK(index.intervals(0).empty());
+    REQUIRE(index.intervals(2).size() == 2);
+    CHECK(index.intervals(2)[0].startUs == 1000 && index.intervals(2)[0].endUs == 3000);
+    CHECK(index.intervals(2)[1].startUs == 4000 && index.intervals(2)[1].endUs == 5000);
+    CHECK(index.occupiedTime(2, 0, 10000) == 3000);
+    CHECK(index.occupiedTime(2, 2500, 4500) == 1000);
+    CHECK(index.occupiedTime(0, 0, 10000) == 0);
+    CHECK(index.occupiedTime(7, 0, 10000) == 0);
+
+    uint64_t at = 0;
+    CHECK(index.firstPresence(2, 0, at) && at == 1000);
+    CHECK(index.firstPresence(2, 1500, at) && at == 1500);
+    CHECK(index.firstPresence(2, 3000, at) && at == 4000);
+    CHECK(!index.firstPresence(2, 5000, at));
+    CHECK(!index.firstPresence(0, 0, at));
+    CHECK(!index.firstPresence(9, 0, at));
+
+    index.build(nullptr, 0);
+    CHECK(index.sensors() == 0);
+}
+
+TEST(occupancy_index_loads_log_file) {
+    std::vector<FrameRecord> log = dayLog(2, 3);
+    std::string path = "/tmp/ld2412_index_test_" + std::to_string(getpid());
+    FILE* file = std::fopen(path.c_str(), "wb");
+    REQUIRE(file != nullptr);
+    std::fwrite(log.data(), sizeof(FrameRecord), log.size(), file);
+    std::fclose(file);
+
+    OccupancyIndex index;
+    REQUIRE(index.load(path.c_str()));
+    CHECK(index.sensors() == 2);
+    CHECK(index.occupiedTime(1, 0, UINT64_MAX) == scanOccupied(log, 1, 0, UINT64_MAX));
+
+    //Torn record at the end
+    file = std::fopen(path.c_str(), "ab");
+    std::fputc(0, file);
+    std::fclose(file);
+    CHECK(!index.load(path.c_str()));
+    std::remove(path.c_str());
+    CHECK(!index.load(path.c_str()));
+}
@@ -0,0 +1,120 @@
+/**
+ * @file test_range_trimmer.cpp
+ * @author Trent Tobias
+ * @brief Min/max gate trimming from clutter-map statistics
+ */
+
+#include "TestFeed.h"
+#include "TestHarness.h"
+
+#include <LD2412.h>
+#include <LD2412RangeTrimmer.h>
+#include <SimulatedSensor.h>
+
+namespace {
+    /**
+     * @brief Narrow room: the sensor sits high so gate 1 sees only the floor, people walk about
+     * gates 2 to `far`, the back wall reflects at gate `far` + 1 with an occasional ghost, and
+     * nothing is beyond it
+     */
+    LD2412GateEnergies room(unsigned int n, uint8_t far = 5) {
+        LD2412GateEnergies e = test::background(n, 7, 6);
+        e.stationary[far + 1] = static_cast<uint8_t>(55 + test::wobble(n));
+        if (n % 250 == 249)
+            e.stationary[far + 1] = 75;
+        //Someone stands at one gate after the other for 4 s every 20 s
+        if (n % 200 < 40)
+            e.moving[2 + (n / 200) % (far - 1)] = 50;
+        return e;
+    }
+
+    void observe(LD2412ClutterMap& map, LD2412RangeTrimmer& trimmer, unsigned int& n, unsigned int frames, uint8_t far = 5) {
+        for (unsigned int end = n + frames; n < end; n++) {
+            LD2412GateEnergies e = room(n, far);
+            map.update(e);
+            trimmer.update(map, e.timestamp);
+        }
+    }
+}
+
+TEST(range_trimmer_recommends_occupied_gates) {
+    LD2412ClutterMap map;
+    LD2412RangeTrimmer trimmer;
+    unsigned int n = 0;
+    uint8_t min, max;
+
+    observe(map, trimmer, n, 3000);
+    CHECK(!trimmer.recommend(min, max));
+    observe(map, trimmer, n, 3100);
+    REQUIRE(trimmer.recommend(min, max));
+    CHECK(min == 2);
+    CHECK(max == 5);
+    CHECK(trimmer.activity(1) == 0);
+    CHECK(trimmer.activity(3) > 20);
+    CHECK(trimmer.reflection(6) > 900);
+    CHECK(trimmer.activity(6) > 0);
+    CHECK(trimmer.reflection(9) == 0);
+}
+
+TEST(range_trimmer_applies_and_keeps_other_params) {
+    MemoryStream stream;
+    SimulatedSensor sensor(stream);
+    LD2412 radar(stream);
+    LD2412ClutterMap map;
+    LD2412RangeTrimmer trimmer;
+    unsigned int n = 0;
+    sensor.duration = 30;
+    sensor.outPinPolarity = 1;
+
+    //Not enough frames yet: nothing to do
+    CHECK(trimmer.evaluate(radar, true, 0) == 0);
+    CHECK(sensor.maxGate == 12);
+
+    observe(map, trimmer, n, 6100);
+    //Recommend only
+    CHECK(trimmer.evaluate(radar, false, n * 100) == 1);
+    CHECK(sensor.minGate == 1 && sensor.maxGate == 12);
+
+    observe(map, trimmer, n, 3100);
+    CHECK(trimmer.evaluate(radar, true, n * 100) == 1);
+    CHECK(sensor.minGate == 2 && sensor.maxGate == 5);
+    CHECK(sensor.duration == 30);
+    CHECK(sensor.outPinPolarity == 1);
+
+    observe(map, trimmer, n, 3100);
+    CHECK(trimmer.evaluate(radar, true, n * 100) == 0);
+    CHECK(sensor.commands > 0);
+
+    //Module gone
+    sensor.ackDelayUs = 10000000;
+    observe(map, trimmer, n, 3100);
+    CHECK(trimmer.evaluate(radar, true, n * 100) == -1);
+}
+
+TEST(range_trimmer_reevaluates_periodically) {
+    MemoryStream stream;
+    SimulatedSensor sensor(stream);
+    LD2412 radar(stream);
+    LD2412ClutterMap map;
+    LD2412RangeTrimmer trimmer;
+    unsigned int n = 0;
+
+    observe(map, trimmer, n, 1);
+    CHECK(!trimmer.due(n * 100));
+    observe(map, trimmer, n, 36000);
+    CHECK(trimmer.due(n * 100));
+    CHECK(trimmer.evaluate(radar, true, n * 100) == 1);
+    CHECK(sensor.maxGate == 5);
+    CHECK(!trimmer.due(n * 100));
+
+    //Partition wall taken out: people now walk up to gate 8 and the reflection moved to gate 9
+    map.reset();
+    while (!trimmer.due(n * 100))
+        observe(map, trimmer, n, 100, 8);
+    CHECK(trimmer.evaluate(radar, true, n * 100) == 1);
+    CHECK(sensor.minGate == 2 && sensor.maxGate == 8);
+
+    trimmer.setPeriod(0);
+    observe(map, trimmer, n, 100000, 8);
+    CHECK(!trimmer.due(n * 100));
+}
@@ -0,0 +1,109 @@
+/**
+ * @file test_ready.cpp
+ * @author Trent Tobias
+ * @brief Ready state after power-up and restart: first-frame latency, callback and the
+ * startup probe picking up frames that arrive in pieces or behind boot noise
+ */
+
+#include "TestHarness.h"
+
+#include <LD2412.h>
+#include <SimulatedSensor.h>
+#include <vector>
+
+namespace {
+    const std::vector<uint8_t> REPORT = {0xF4, 0xF3, 0xF2, 0xF1, 0x0B, 0x00, 0x02, 0xAA, 0x01, 0x78, 0x00,
+                                         0x28, 0x00, 0x00, 0x00, 0x55, 0x00, 0xF8, 0xF7, 0xF6, 0xF5};
+
+    unsigned int readyCalls = 0;
+    unsigned long readyLatency = 0;
+
+    void onReady(unsigned long latencyMs) {
+        readyCalls++;
+        readyLatency = latencyMs;
+    }
+}
+
+TEST(ready_after_power_up) {
+    for (bool lazy : {false, true}) {
+        host::setClock(0);
+        MemoryStream stream;
+        LD2412 radar(stream);
+        radar.setLazyDecode(lazy);
+
+        CHECK(!radar.isReady());
+        CHECK(radar.getStartupLatency() == -1);
+        CHECK(radar.targetState() == -1);
+
+        stream.feed(REPORT, 300000);
+        CHECK(radar.awaitReady(1000));
+        CHECK(radar.getStartupLatency() == 300);
+        CHECK(millis() == 300);
+        CHECK(radar.targetState() == 1);
+    }
+}
+
+TEST(ready_after_restart) {
+    MemoryStream stream;
+    SimulatedSensor sensor(stream);
+    sensor.restartUs = 400000;
+    LD2412 radar(stream);
+    radar.setReadyCallback(onReady);
+    readyCalls = 0;
+
+    stream.feed(REPORT);
+    REQUIRE(radar.awaitReady(100));
+    CHECK(readyCalls == 1);
+
+    REQUIRE(radar.restartModule());
+    CHECK(sensor.restarts == 1);
+    CHECK(!radar.isReady());
+    //The frame from before the restart is not served as current
+    CHECK(radar.targetState() == -1);
+    CHECK(!sensor.report({1, 120, 40, 0, 0, 0}));
+
+    unsigned long restarted = millis();
+    stream.feed(REPORT, 450000);
+    CHECK(radar.awaitReady(1000));
+    CHECK(static_cast<uint32_t>(millis() - restarted) == 450);
+    //Timed from the restart ACK, so it includes the end of the restart session
+    CHECK(radar.getStartupLatency() >= 450 && radar.getStartupLatency() < 500);
+    CHECK(readyCalls == 2);
+    CHECK(readyLatency == static_cast<unsigned long>(radar.getStartupLatency()));
+
+    //Later frames do not fire it again
+    stream.feed(REPORT);
+    delay(10);
+    CHECK(radar.targetState() == 1);
+    CHECK(readyCalls == 2);
+}
+
+TEST(ready_probe_waits_for_whole_frame) {
+    MemoryStream stream;
+    LD2412 radar(stream);
+    radar.beginStartup();
+
+    //Boot noise, then the first frame split across two bursts
+    stream.feed({0x00, 0x11, 0xFF, 0xF3}, 50000);
+    stream.feed(std::vector<uint8_t>(REPORT.begin(), REPORT.begin() + 10), 100000);
+    stream.feed(std::vector<uint8_t>(REPORT.begin() + 10, REPORT.end()), 105000);
+
+    delay(102);
+    CHECK(!radar.isReady());
+    CHECK(radar.awaitReady(100));
+    CHECK(radar.getStartupLatency() == 105);
+    CHECK(radar.getStats().frameErrors == 0);
+    CHECK(radar.movingDistance() == 120);
+}
+
+TEST(ready_await_times_out) {
+    MemoryStream stream;
+    LD2412 radar(stream);
+    radar.setReadyCallback(onReady);
+    readyCalls = 0;
+
+    CHECK(!radar.awaitReady(200));
+    CHECK(millis() == 200);
+    CHECK(readyCalls == 0);
+    CHECK(radar.getStartupLatency() == -1);
+}
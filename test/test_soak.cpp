@@ -0,0 +1,198 @@
+/**
+ * @file test_soak.cpp
+ * @author Trent Tobias
+ * @brief Weeks of virtual run time through the library, across the 32-bit millis() wraparound,
+ * checking that frame rate, command latency and heap usage stay flat.
+ *
+ * The run is a series of windows of continuous 10 Hz reports plus a command, one per simulated
+ * hour, with the clock jumping between them. LD2412_SOAK_DAYS sets the length (default 21).
+ */
+
+#include "TestHarness.h"
+
+#include <FaultyStream.h>
+#include <LD2412.h>
+#include <SimulatedSensor.h>
+#include <cstdlib>
+#include <malloc.h>
+
+namespace {
+    constexpr uint64_t MS = 1000;
+    constexpr uint64_t HOUR = 3600 * 1000 * MS;
+    constexpr uint64_t WRAP = (1ULL << 32) * MS;        //millis() rolls over here
+    constexpr unsigned int WINDOW_FRAMES = 300;         //30 s of reports
+    constexpr unsigned long FRAME_PERIOD = 100;
+
+    unsigned int soakDays() {
+        const char* env = std::getenv("LD2412_SOAK_DAYS");
+        return env != nullptr && std::atoi(env) > 0 ? std::atoi(env) : 21;
+    }
+
+    /**
+     * @brief Start of the run: half of it before the rollover, so one window straddles it at any length
+     */
+    uint64_t startBeforeWrap() {
+        return WRAP - soakDays() * 24 / 2 * HOUR - 15 * 1000 * MS;
+    }
+
+    struct Window {
+        unsigned int frames;
+        unsigned long commandMs;
+        bool commandOk;
+        size_t heap;
+    };
+
+    /**
+     * @brief One window: reports at 10 Hz read by a 10 ms loop, then a parameter read
+     */
+    Window runWindow(LD2412& radar, SimulatedSensor& sensor, MemoryStream& stream, unsigned int n) {
+        Window w;
+        uint32_t before = radar.getStats().frames;
+        LD2412Frame frame;
+        for (unsigned int i = 0; i < WINDOW_FRAMES; i++) {
+            sensor.report({static_cast<uint8_t>(1 + (n + i) % 3), static_cast<uint16_t>(80 + i % 200), 50,
+                           static_cast<uint16_t>(90 + i % 150), 30, 0});
+            for (unsigned long t = 0; t < FRAME_PERIOD; t += 10) {
+                radar.readFrame(frame);
+                delay(10);
+            }
+        }
+        w.frames = radar.getStats().frames - before;
+
+        uint64_t start = host::nowMicros();
+        w.commandOk = radar.getParamConfig() != nullptr;
+        w.commandMs = (host::nowMicros() - start) / MS;
+        //The stream keeps every written byte for inspection; that is the harness, not the library
+        stream.clearWritten();
+        w.heap = mallinfo2().uordblks;
+        return w;
+    }
+
+    /**
+     * @brief Runs the soak and checks every window against the first
+     */
+    void soak(bool lazy, uint64_t startUs) {
+        MemoryStream stream;
+        SimulatedSensor sensor(stream);
+        LD2412 radar(stream);
+        radar.setLazyDecode(lazy);
+        host::setClock(startUs);
+
+        const unsigned int windows = soakDays() * 24;
+        Window first = runWindow(radar, sensor, stream, 0);
+        CHECK(first.frames == WINDOW_FRAMES);
+        CHECK(first.commandOk);
+
+        unsigned int badFrames = 0, badCommands = 0, slowCommands = 0;
+        size_t peakHeap = first.heap;
+        bool wrapped = false;
+        for (unsigned int n = 1; n < windows; n++) {
+            uint64_t windowStart = startUs + n * HOUR;
+            host::setClock(windowStart);
+            wrapped |= windowStart / WRAP != startUs / WRAP;
+
+            Window w = runWindow(radar, sensor, stream, n);
+            if (w.frames != WINDOW_FRAMES)
+                badFrames++;
+            if (!w.commandOk)
+                badCommands++;
+            if (w.commandMs > first.commandMs + 5)
+                slowCommands++;
+            if (w.heap > peakHeap)
+                peakHeap = w.heap;
+        }
+
+        CHECK(wrapped);
+        CHECK(badFrames == 0);
+        CHECK(badCommands == 0);
+        CHECK(slowCommands == 0);
+        //No growth beyond allocator noise over the whole run
+        CHECK(peakHeap <= first.heap + 4096);
+        const LD2412Stats& stats = radar.getStats();
+        CHECK(stats.ackTimeouts == 0 && stats.ackErrors == 0);
+        CHECK(stats.frameErrors == 0);
+    }
+}
+
+TEST(soak_weeks_across_millis_wrap) {
+    soak(false, startBeforeWrap());
+}
+
+TEST(soak_weeks_across_millis_wrap_lazy) {
+    soak(true, startBeforeWrap());
+}
+
+TEST(commands_across_millis_wrap) {
+    MemoryStream stream;
+    SimulatedSensor sensor(stream);
+    LD2412 radar(stream);
+
+    //Every offset puts the rollover somewhere inside a command's enable/query/disable sessions
+    for (uint64_t before = 0; before <= 80; before += 4) {
+        host::setClock(WRAP - before * MS);
+        CHECK(radar.getParamConfig() != nullptr);
+        delay(200);
+    }
+    CHECK(radar.getStats().ackTimeouts == 0);
+
+    //A frame whose bytes arrive on both sides of the rollover
+    host::setClock(WRAP - 2 * MS);
+    host::setClockStep(50);
+    sensor.report({1, 321, 40, 0, 0, 0});
+    LD2412Frame frame;
+    CHECK(radar.readFrame(frame));
+    CHECK(frame.movingDistance == 321);
+}
+
+namespace {
+    bool calibrationResult = false;
+
+    void onCalibrated(bool success) {
+        calibrationResult = success;
+    }
+}
+
+TEST(calibration_job_across_millis_wrap) {
+    MemoryStream stream;
+    SimulatedSensor sensor(stream);
+    LD2412 radar(stream);
+    host::setClock(WRAP - 20 * 1000 * MS);
+    calibrationResult = false;
+
+    REQUIRE(radar.startCalibration(onCalibrated));
+    uint64_t started = host::nowMicros();
+    while (radar.updateCalibration() && host::nowMicros() - started < 600 * 1000 * MS)
+        delay(10);
+    CHECK(!radar.calibrationRunning());
+    CHECK(calibrationResult);
+    //Finishes on status like it does away from the wrap, well before the 5 min timeout
+    CHECK(host::nowMicros() - started < 120 * 1000 * MS);
+    CHECK(host::nowMicros() > WRAP);
+}
+
+TEST(soak_noisy_line_stays_flat) {
+    //A day of light line noise: losses are expected, drift and growth are not
+    MemoryStream stream;
+    SimulatedSensor sensor(stream);
+    FaultyStream noisy(stream, 87);
+    FaultyStream::Faults f;
+    f.bitFlip = 0.0005;
+    f.garbage = 0.0005;
+    noisy.setFaults(f);
+    LD2412 radar(noisy);
+    host::setClock(WRAP - 12 * HOUR);
+    host::setClockStep(1);
+
+    Window first = runWindow(radar, sensor, stream, 0);
+    size_t peakHeap = first.heap;
+    unsigned int frames = first.frames;
+    for (unsigned int n = 1; n < 24; n++) {
+        host::setClock(WRAP - 12 * HOUR + n * HOUR);
+        Window w = runWindow(radar, sensor, stream, n);
+        frames += w.frames;
+        if (w.heap > peakHeap)
+            peakHeap = w.heap;
+    }
+    CHECK(frames >= 24 * WINDOW_FRAMES * 90 / 100);
+    CHECK(peakHeap <= first.heap + 4096);
+}
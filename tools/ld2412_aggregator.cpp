@@ -0,0 +1,217 @@
+/**
+ * @file ld2412_aggregator.cpp
+ * @author Trent Tobias
+ * @brief Linux gateway daemon: reads every attached LD2412 and publishes the decoded frames
+ * for other local processes.
+ *
+ * Frames go into a POSIX shared-memory ring (see FrameRing.h) that any number of consumers
+ * read zero-copy with their own cursors, so the ttys are read exactly once. With --socket
+ * the same frames are also streamed over a Unix-domain socket (see FrameServer.h) to
+ * subscribers that do not map the ring. Link health counters of every sensor are exposed in
+ * Prometheus text format on --metrics-socket (one scrape per connection) and/or written to
+ * --metrics-file on SIGUSR1.
+ *
+ * Usage: ld2412_aggregator [--shm NAME] [--capacity N] [--socket PATH] [--slow-policy drop-oldest|decimate]
+ *                          [--metrics-socket PATH] [--metrics-file PATH] [--baud N] [--simulate N] DEVICE...
+ */
+
+#include <FrameRing.h>
+#include <FrameServer.h>
+#include <HostStreams.h>
+#include <LD2412.h>
+#include <MetricsExporter.h>
+#include <SimulatedSensor.h>
+
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <poll.h>
+#include <random>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+    volatile std::sig_atomic_t running = 1;
+    volatile std::sig_atomic_t dump = 0;
+
+    void stop(int) {
+        running = 0;
+    }
+
+    void requestDump(int) {
+        dump = 1;
+    }
+
+    constexpr unsigned long METRICS_PERIOD = 100;      //ms between counter snapshots
+
+    struct Sensor {
+        std::string device;
+        std::unique_ptr<FdStream> tty;
+        std::unique_ptr<MemoryStream> memory;
+        std::unique_ptr<SimulatedSensor> sim;
+        std::unique_ptr<LD2412> radar;
+        uint32_t frames = 0;
+
+        //Simulated target walking around the room
+        unsigned long lastReport = 0;
+        int distance = 200;
+    };
+
+    void simulate(Sensor& s, std::mt19937& rng) {
+        if (static_cast<uint32_t>(millis() - s.lastReport) < 100)
+            return;
+        s.lastReport = millis();
+        s.distance = std::max(30, std::min(1000, s.distance + static_cast<int>(rng() % 41) - 20));
+        uint8_t state = rng() % 8 == 0 ? 0 : 1 + rng() % 3;
+        LD2412Frame f = {state,
+                         static_cast<uint16_t>(state & 1 ? s.distance : 0), static_cast<uint8_t>(state & 1 ? 20 + rng() % 60 : 0),
+                         static_cast<uint16_t>(state & 2 ? s.distance + 10 : 0), static_cast<uint8_t>(state & 2 ? 20 + rng() % 60 : 0),
+                         0};
+        s.sim->report(f);
+    }
+
+    int usage(const char* argv0) {
+        std::fprintf(stderr, "usage: %s [--shm NAME] [--capacity N] [--socket PATH] [--slow-policy drop-oldest|decimate]\n"
+                             "       [--metrics-socket PATH] [--metrics-file PATH] [--baud N] [--simulate N] DEVICE...\n", argv0);
+        return 2;
+    }
+}
+
+int main(int argc, char** argv) {
+    std::string shmName = "/ld2412";
+    uint32_t capacity = 4096;
+    std::string socketPath;
+    std::string metricsSocket;
+    std::string metricsFile;
+    FrameServer::SlowPolicy policy = FrameServer::SlowPolicy::DropOldest;
+    unsigned long baud = 115200;
+    std::vector<Sensor> sensors;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--shm" && i + 1 < argc)
+            shmName = argv[++i];
+        else if (arg == "--capacity" && i + 1 < argc)
+            capacity = std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--socket" && i + 1 < argc)
+            socketPath = argv[++i];
+        else if (arg == "--slow-policy" && i + 1 < argc) {
+            std::string p = argv[++i];
+            if (p == "drop-oldest")
+                policy = FrameServer::SlowPolicy::DropOldest;
+            else if (p == "decimate")
+                policy = FrameServer::SlowPolicy::Decimate;
+            else
+                return usage(argv[0]);
+        }
+        else if (arg == "--metrics-socket" && i + 1 < argc)
+            metricsSocket = argv[++i];
+        else if (arg == "--metrics-file" && i + 1 < argc)
+            metricsFile = argv[++i];
+        else if (arg == "--baud" && i + 1 < argc)
+            baud = std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--simulate" && i + 1 < argc)
+            for (int n = std::atoi(argv[++i]), k = 0; k < n; k++)
+                sensors.emplace_back().device = "sim:" + std::to_string(k);
+        else if (!arg.empty() && arg[0] == '-')
+            return usage(argv[0]);
+        else
+            sensors.emplace_back().device = arg;
+    }
+    if (sensors.empty())
+        return usage(argv[0]);
+
+    for (Sensor& s : sensors) {
+        if (s.device.rfind("sim:", 0) == 0) {
+            s.memory = std::make_unique<MemoryStream>();
+            s.sim = std::make_unique<SimulatedSensor>(*s.memory);
+            s.radar = std::make_unique<LD2412>(*s.memory);
+        }
+        else {
+            auto tty = std::make_unique<TtyStream>(s.device.c_str(), baud);
+            if (!tty->isOpen()) {
+                std::fprintf(stderr, "%s: cannot open or configure device\n", s.device.c_str());
+                return 1;
+            }
+            s.radar = std::make_unique<LD2412>(*tty);
+            s.tty = std::move(tty);
+        }
+    }
+
+    FrameRing ring;
+    if (!ring.create(shmName.c_str(), capacity)) {
+        std::perror("shm");
+        return 1;
+    }
+    FrameServer server;
+    if (!socketPath.empty() && !server.listen(socketPath.c_str(), policy)) {
+        std::perror(socketPath.c_str());
+        FrameRing::unlink(shmName.c_str());
+        return 1;
+    }
+    std::vector<std::string> devices;
+    for (const Sensor& s : sensors)
+        devices.push_back(s.device);
+    MetricsExporter metrics(devices);
+    if ((!metricsSocket.empty() || !metricsFile.empty())
+        && !metrics.start(metricsSocket.empty() ? nullptr : metricsSocket.c_str(),
+                          metricsFile.empty() ? nullptr : metricsFile.c_str())) {
+        std::perror(metricsSocket.c_str());
+        FrameRing::unlink(shmName.c_str());
+        return 1;
+    }
+    std::signal(SIGINT, stop);
+    std::signal(SIGTERM, stop);
+    std::signal(SIGUSR1, requestDump);
+
+    std::vector<pollfd> fds;
+    for (const Sensor& s : sensors)
+        if (s.tty)
+            fds.push_back({s.tty->fd(), POLLIN, 0});
+
+    std::mt19937 rng(std::random_device{}());
+    unsigned long lastMetrics = 0;
+    while (running) {
+        for (size_t i = 0; i < sensors.size(); i++) {
+            Sensor& s = sensors[i];
+            if (s.sim)
+                simulate(s, rng);
+
+            //A tty can deliver a frame in pieces, it is read once whole. The frame counter tells
+            //new frames apart, even two within the same millisecond
+            LD2412Frame frame;
+            if (!s.radar->frameWaiting() || !s.radar->readFrame(frame) || s.radar->getStats().frames == s.frames)
+                continue;
+            s.frames = s.radar->getStats().frames;
+            FrameRecord record = FrameRecord::from(i, frame, FrameRecord::nowUs());
+            ring.publish(record);
+            server.publish(record);
+        }
+
+        //One batched write per subscriber per loop, never blocking on a slow one
+        server.poll();
+
+        if (static_cast<uint32_t>(millis() - lastMetrics) >= METRICS_PERIOD) {
+            lastMetrics = millis();
+            for (size_t i = 0; i < sensors.size(); i++)
+                metrics.publish(i, sensors[i].radar->getStats(), lastMetrics);
+        }
+        if (dump) {
+            dump = 0;
+            metrics.requestDump();
+        }
+
+        //Sleeps until a tty has data, or a simulation tick
+        if (!fds.empty())
+            poll(fds.data(), fds.size(), 5);
+        else
+            usleep(2000);
+    }
+
+    metrics.stop();
+    server.close();
+    FrameRing::unlink(shmName.c_str());
+    return 0;
+}
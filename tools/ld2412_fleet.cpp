@@ -0,0 +1,254 @@
+/**
+ * @file ld2412_fleet.cpp
+ * @author Trent Tobias
+ * @brief Configures, verifies and inventories many LD2412 sensors concurrently from a Linux gateway.
+ *
+ * Every device gets its own thread running the library's blocking command path, so a site
+ * takes about as long as its slowest sensor instead of the sum of all of them.
+ *
+ * Usage: ld2412_fleet [--profile FILE] [--verify-only] [--baud N] [--json] [--simulate N] DEVICE...
+ *
+ * Profile (key = value, '#' comments):
+ *   min = 1             Minimum distance gate
+ *   max = 12            Maximum distance gate
+ *   duration = 5        Unmanned duration (s)
+ *   polarity = 0        OUT pin polarity
+ *   motion = 40         Motion sensitivity, one value or 14 comma-separated per-gate values
+ *   static = 30         Static sensitivity, same format
+ */
+
+#include <HostStreams.h>
+#include <LD2412.h>
+#include <SimulatedSensor.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    struct Profile {
+        bool hasParams = false;
+        uint8_t min = 1, max = 12, duration = 5, polarity = 0;
+        bool hasMotion = false, hasStatic = false;
+        uint8_t motion[14] = {}, stat[14] = {};
+    };
+
+    struct Result {
+        std::string device;
+        std::string status = "ok";
+        std::string firmware;
+        std::string detail;
+        int params[5] = {-1, -1, -1, -1, -1};
+        long elapsedMs = 0;
+    };
+
+    bool parseGates(const std::string& value, uint8_t out[14]) {
+        std::vector<int> values;
+        std::stringstream in(value);
+        std::string tok;
+        while (std::getline(in, tok, ','))
+            values.push_back(std::stoi(tok));
+        if (values.size() == 1)
+            values.assign(14, values[0]);
+        if (values.size() != 14)
+            return false;
+        for (int i = 0; i < 14; i++) {
+            if (values[i] < 0 || values[i] > 100)
+                return false;
+            out[i] = values[i];
+        }
+        return true;
+    }
+
+    bool loadProfile(const char* path, Profile& profile) {
+        std::ifstream file(path);
+        if (!file)
+            return false;
+        std::string line;
+        for (int n = 1; std::getline(file, line); n++) {
+            line = line.substr(0, line.find('#'));
+            size_t eq = line.find('=');
+            if (eq == std::string::npos)
+                continue;
+            std::string key, value;
+            std::istringstream(line.substr(0, eq)) >> key;
+            std::istringstream(line.substr(eq + 1)) >> value;
+            try {
+                if (key == "min" || key == "max" || key == "duration" || key == "polarity") {
+                    uint8_t v = std::stoi(value);
+                    (key == "min" ? profile.min : key == "max" ? profile.max
+                        : key == "duration" ? profile.duration : profile.polarity) = v;
+                    profile.hasParams = true;
+                }
+                else if (key == "motion") {
+                    profile.hasMotion = parseGates(value, profile.motion);
+                    if (!profile.hasMotion)
+                        throw std::invalid_argument(value);
+                }
+                else if (key == "static") {
+                    profile.hasStatic = parseGates(value, profile.stat);
+                    if (!profile.hasStatic)
+                        throw std::invalid_argument(value);
+                }
+                else {
+                    std::fprintf(stderr, "%s:%d: unknown key '%s'\n", path, n, key.c_str());
+                    return false;
+                }
+            }
+            catch (const std::exception&) {
+                std::fprintf(stderr, "%s:%d: bad value '%s'\n", path, n, value.c_str());
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void fail(Result& r, const char* status, const std::string& detail) {
+        if (r.status == "ok") {
+            r.status = status;
+            r.detail = detail;
+        }
+    }
+
+    //Apply, read back and inventory one sensor; runs on the device's own thread
+    void commission(LD2412& radar, const Profile* profile, bool verifyOnly, Result& r) {
+        const int* fw = radar.readFirmwareVersion();
+        if (fw == nullptr) {
+            fail(r, "no-response", "firmware version query failed");
+            return;
+        }
+        char version[48];
+        std::snprintf(version, sizeof(version), "%04X V%X.%02X.%08X", fw[0], fw[1] >> 8, fw[1] & 0xFF,
+                      static_cast<unsigned>(fw[2]));
+        r.firmware = version;
+
+        if (profile != nullptr && !verifyOnly) {
+            if (profile->hasParams && !radar.setParamConfig(profile->min, profile->max, profile->duration, profile->polarity))
+                fail(r, "apply-failed", "setParamConfig");
+            if (profile->hasMotion && !radar.setMotionSensitivity(const_cast<uint8_t*>(profile->motion)))
+                fail(r, "apply-failed", "setMotionSensitivity");
+            if (profile->hasStatic && !radar.setStaticSensitivity(const_cast<uint8_t*>(profile->stat)))
+                fail(r, "apply-failed", "setStaticSensitivity");
+        }
+
+        const int* params = radar.getParamConfig();
+        if (params == nullptr) {
+            fail(r, "no-response", "getParamConfig");
+            return;
+        }
+        std::copy(params, params + 5, r.params);
+        if (profile == nullptr)
+            return;
+
+        if (profile->hasParams && (params[0] != profile->min || params[1] != profile->max
+                                   || params[2] != profile->duration || params[4] != profile->polarity))
+            fail(r, "verify-mismatch", "params");
+        auto verifyGates = [&](const int* read, const uint8_t* want, const char* what) {
+            if (read == nullptr)
+                return fail(r, "no-response", what);
+            for (int i = 0; i < 14; i++)
+                if (read[i] != want[i])
+                    return fail(r, "verify-mismatch", std::string(what) + " gate " + std::to_string(i));
+        };
+        if (profile->hasMotion)
+            verifyGates(radar.getMotionSensitivity(RETURN_ARRAY), profile->motion, "motion sensitivity");
+        if (profile->hasStatic)
+            verifyGates(radar.getStaticSensitivity(RETURN_ARRAY), profile->stat, "static sensitivity");
+    }
+
+    void runDevice(const std::string& device, unsigned long baud, const Profile* profile, bool verifyOnly, Result& r) {
+        auto start = std::chrono::steady_clock::now();
+        r.device = device;
+
+        if (device.rfind("sim:", 0) == 0) {
+            MemoryStream stream;
+            SimulatedSensor sensor(stream);
+            LD2412 radar(stream);
+            commission(radar, profile, verifyOnly, r);
+        }
+        else {
+            TtyStream stream(device.c_str(), baud);
+            if (!stream.isOpen())
+                fail(r, "open-failed", "cannot open or configure device");
+            else {
+                LD2412 radar(stream);
+                commission(radar, profile, verifyOnly, r);
+            }
+        }
+        r.elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start).count();
+    }
+
+    int usage(const char* argv0) {
+        std::fprintf(stderr, "usage: %s [--profile FILE] [--verify-only] [--baud N] [--json] [--simulate N] DEVICE...\n", argv0);
+        return 2;
+    }
+}
+
+int main(int argc, char** argv) {
+    Profile profile;
+    bool hasProfile = false, verifyOnly = false, json = false;
+    unsigned long baud = 115200;
+    std::vector<std::string> devices;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--profile" && i + 1 < argc) {
+            if (!loadProfile(argv[++i], profile))
+                return 2;
+            hasProfile = true;
+        }
+        else if (arg == "--verify-only")
+            verifyOnly = true;
+        else if (arg == "--baud" && i + 1 < argc)
+            baud = std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--json")
+            json = true;
+        else if (arg == "--simulate" && i + 1 < argc)
+            for (int n = std::atoi(argv[++i]), k = 0; k < n; k++)
+                devices.push_back("sim:" + std::to_string(k));
+        else if (!arg.empty() && arg[0] == '-')
+            return usage(argv[0]);
+        else
+            devices.push_back(arg);
+    }
+    if (devices.empty())
+        return usage(argv[0]);
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<Result> results(devices.size());
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < devices.size(); i++)
+        workers.emplace_back(runDevice, devices[i], baud, hasProfile ? &profile : nullptr, verifyOnly,
+                             std::ref(results[i]));
+    for (std::thread& t : workers)
+        t.join();
+    long totalMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+
+    int failed = 0;
+    if (!json)
+        std::printf("%-20s %-16s %-24s %-18s %8s  %s\n", "device", "status", "firmware", "min/max/dur/pol", "ms", "detail");
+    for (const Result& r : results) {
+        if (r.status != "ok")
+            failed++;
+        char params[32];
+        std::snprintf(params, sizeof(params), "%d/%d/%d/%d", r.params[0], r.params[1], r.params[2], r.params[4]);
+        if (json)
+            std::printf("{\"device\":\"%s\",\"status\":\"%s\",\"firmware\":\"%s\",\"min\":%d,\"max\":%d,"
+                        "\"duration\":%d,\"polarity\":%d,\"ms\":%ld,\"detail\":\"%s\"}\n",
+                        r.device.c_str(), r.status.c_str(), r.firmware.c_str(), r.params[0], r.params[1],
+                        r.params[2], r.params[4], r.elapsedMs, r.detail.c_str());
+        else
+            std::printf("%-20s %-16s %-24s %-18s %8ld  %s\n", r.device.c_str(), r.status.c_str(),
+                        r.firmware.c_str(), params, r.elapsedMs, r.detail.c_str());
+    }
+    if (!json)
+        std::printf("%zu sensor(s), %d failed, %ld ms total\n", results.size(), failed, totalMs);
+    return failed == 0 ? 0 : 1;
+}
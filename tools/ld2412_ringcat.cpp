@@ -0,0 +1,73 @@
+/**
+ * @file ld2412_ringcat.cpp
+ * @author Trent Tobias
+ * @brief Example consumer of the aggregator's shared-memory frame ring: prints frames
+ * as they arrive, read zero-copy, and reports overruns
+ *
+ * Usage: ld2412_ringcat [--shm NAME] [--count N]
+ */
+
+#include <FrameRing.h>
+
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <unistd.h>
+
+namespace {
+    volatile std::sig_atomic_t running = 1;
+
+    void stop(int) {
+        running = 0;
+    }
+}
+
+int main(int argc, char** argv) {
+    std::string shmName = "/ld2412";
+    long count = -1;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--shm" && i + 1 < argc)
+            shmName = argv[++i];
+        else if (arg == "--count" && i + 1 < argc)
+            count = std::atol(argv[++i]);
+        else {
+            std::fprintf(stderr, "usage: %s [--shm NAME] [--count N]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    FrameRing ring;
+    if (!ring.attach(shmName.c_str())) {
+        std::fprintf(stderr, "%s: no frame ring (is ld2412_aggregator running?)\n", shmName.c_str());
+        return 1;
+    }
+    std::signal(SIGINT, stop);
+    std::signal(SIGTERM, stop);
+
+    FrameRing::Reader reader(ring);
+    uint64_t lost = 0;
+    while (running && count != 0) {
+        const FrameRecord* r = reader.peek();
+        if (r == nullptr) {
+            usleep(1000);
+            continue;
+        }
+        char line[96];
+        std::snprintf(line, sizeof(line), "%llu sensor=%u state=%u moving=%u/%u static=%u/%u",
+                      static_cast<unsigned long long>(r->timestampUs), r->sensor, r->state,
+                      r->movingDistance, r->movingEnergy, r->staticDistance, r->staticEnergy);
+        //Only print what survived the read
+        if (reader.release()) {
+            std::puts(line);
+            if (count > 0)
+                count--;
+        }
+        if (reader.lost() != lost) {
+            std::fprintf(stderr, "overrun: %llu frame(s) lost\n", static_cast<unsigned long long>(reader.lost() - lost));
+            lost = reader.lost();
+        }
+    }
+    return 0;
+}
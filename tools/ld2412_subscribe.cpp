@@ -0,0 +1,126 @@
+/**
+ * @file ld2412_subscribe.cpp
+ * @author Trent Tobias
+ * @brief Example subscriber of the aggregator's frame socket. Deliberately uses only system
+ * headers: the wire format below is all a local service needs, no library to link.
+ *
+ * Usage: ld2412_subscribe [--policy drop-oldest|decimate] [--count N] SOCKET
+ */
+
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+    //Mirrors FrameBatchHeader and FrameRecord (host byte order)
+    struct BatchHeader {
+        uint16_t magic;         //0x464C
+        uint8_t version;        //2
+        uint8_t recordSize;     //24
+        uint16_t count;
+        uint16_t reserved;
+        uint32_t dropped;
+    };
+
+    struct Record {
+        uint64_t timestampUs;   //us since the Unix epoch
+        uint16_t sensor;
+        uint8_t state;
+        uint8_t movingEnergy;
+        uint16_t movingDistance;
+        uint16_t staticDistance;
+        uint8_t staticEnergy;
+        uint8_t reserved[7];
+    };
+
+    static_assert(sizeof(BatchHeader) == 12 && sizeof(Record) == 24, "wire format");
+
+    volatile std::sig_atomic_t running = 1;
+
+    void stop(int) {
+        running = 0;
+    }
+
+    bool readAll(int fd, void* buf, size_t len) {
+        uint8_t* p = static_cast<uint8_t*>(buf);
+        while (len > 0 && running) {
+            ssize_t n = read(fd, p, len);
+            if (n <= 0)
+                return false;
+            p += n;
+            len -= n;
+        }
+        return len == 0;
+    }
+}
+
+int main(int argc, char** argv) {
+    std::string policy;
+    long count = -1;
+    const char* path = nullptr;
+    bool valid = true;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--policy" && i + 1 < argc)
+            policy = argv[++i];
+        else if (arg == "--count" && i + 1 < argc)
+            count = std::atol(argv[++i]);
+        else if (arg[0] != '-' && path == nullptr)
+            path = argv[i];
+        else
+            valid = false;
+    }
+    if (!valid || path == nullptr) {
+        std::fprintf(stderr, "usage: %s [--policy drop-oldest|decimate] [--count N] SOCKET\n", argv[0]);
+        return 2;
+    }
+
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        std::perror(path);
+        return 1;
+    }
+    if (!policy.empty()) {
+        std::string line = "policy=" + policy + "\n";
+        if (write(fd, line.data(), line.size()) != static_cast<ssize_t>(line.size())) {
+            std::perror(path);
+            return 1;
+        }
+    }
+    std::signal(SIGINT, stop);
+    std::signal(SIGTERM, stop);
+
+    BatchHeader header;
+    while (running && count != 0 && readAll(fd, &header, sizeof(header))) {
+        if (header.magic != 0x464C || header.recordSize != sizeof(Record)) {
+            std::fprintf(stderr, "unexpected stream format\n");
+            return 1;
+        }
+        if (header.dropped > 0)
+            std::fprintf(stderr, "slow subscriber: %u frame(s) dropped\n", header.dropped);
+        for (uint16_t i = 0; i < header.count; i++) {
+            Record r;
+            if (!readAll(fd, &r, sizeof(r)))
+                return 0;
+            if (count == 0)
+                continue;
+            std::printf("%llu sensor=%u state=%u moving=%u/%u static=%u/%u\n",
+                        static_cast<unsigned long long>(r.timestampUs), r.sensor, r.state,
+                        r.movingDistance, r.movingEnergy, r.staticDistance, r.staticEnergy);
+            if (count > 0)
+                count--;
+        }
+        std::fflush(stdout);
+    }
+    close(fd);
+    return 0;
+}